@@ -0,0 +1,416 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "AI.hpp"
+#include "BMPImage.hpp"
+#include "ColorQuantizer.hpp"
+#include "Cube.hpp"
+#include "CubeArena.hpp"
+#include "CubeState.hpp"
+#include "ImageStream.hpp"
+#include "Move.hpp"
+
+/* Times the hot paths of the cube, the solver and the image pipeline.
+   Every benchmark is calibrated until a sample takes at least --min-time, warmed up, then sampled --repetitions times.
+   Results are printed per item (a move, a cube, a pixel...), written as JSON with --json, and compared against
+   an earlier --json file with --baseline */
+
+namespace {
+    const char* const USAGE =
+        "usage: tessellate-bench [--filter TEXT] [--repetitions N] [--warmup SECONDS] [--min-time SECONDS]\n"
+        "                        [--json FILE] [--baseline FILE] [--threshold PERCENT]\n";
+
+    using Clock = std::chrono::steady_clock;
+
+    /* results are folded into this so the compiler cannot drop the work that produced them */
+    volatile uint64_t sink = 0;
+
+    /* a piece of work timed in batches. run(n) does n operations of items items each */
+    struct Benchmark {
+        std::string name;
+        size_t itemsPerOp;
+        std::function<void(size_t)> run;
+    };
+
+    /* nanoseconds per item over the samples of one benchmark */
+    struct Result {
+        std::string name;
+        size_t opsPerSample;
+        size_t itemsPerOp;
+        double min, median, mean, stddev, max;
+    };
+
+    double seconds(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    Result measure(const Benchmark& benchmark, size_t repetitions, double warmup, double minTime) {
+        // doubles the batch until it takes minTime. That also warms the caches and the branch predictors
+        size_t n = 1;
+        for (;;) {
+            Clock::time_point start = Clock::now();
+            benchmark.run(n);
+            if (seconds(start) >= minTime || n >= (size_t(1) << 40))
+                break;
+            n *= 2;
+        }
+        for (Clock::time_point start = Clock::now(); seconds(start) < warmup;)
+            benchmark.run(n);
+
+        std::vector<double> samples(repetitions);
+        for (double& sample : samples) {
+            Clock::time_point start = Clock::now();
+            benchmark.run(n);
+            sample = seconds(start) * 1e9 / (static_cast<double>(n) * benchmark.itemsPerOp);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        Result result{ benchmark.name, n, benchmark.itemsPerOp, samples.front(), 0, 0, 0, samples.back() };
+        size_t middle = samples.size() / 2;
+        result.median = samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2;
+        for (double sample : samples)
+            result.mean += sample;
+        result.mean /= samples.size();
+        for (double sample : samples)
+            result.stddev += (sample - result.mean) * (sample - result.mean);
+        result.stddev = samples.size() > 1 ? std::sqrt(result.stddev / (samples.size() - 1)) : 0;
+        return result;
+    }
+
+    std::string escape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    /* one benchmark per line, so a baseline can be read back without a JSON library */
+    void writeJSON(const char* path, const std::vector<Result>& results, size_t repetitions) {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+            throw std::runtime_error(std::string("cannot open ") + path + " for writing");
+        file << "{\n  \"unit\": \"ns per item\",\n  \"repetitions\": " << repetitions << ",\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            char line[512];
+            snprintf(line, sizeof(line),
+                "    { \"name\": \"%s\", \"items_per_op\": %zu, \"ops_per_sample\": %zu, \"min\": %.4f, \"median\": %.4f, \"mean\": %.4f, \"stddev\": %.4f, \"max\": %.4f }%s\n",
+                escape(r.name).c_str(), r.itemsPerOp, r.opsPerSample, r.min, r.median, r.mean, r.stddev, r.max, i + 1 < results.size() ? "," : "");
+            file << line;
+        }
+        file << "  ]\n}\n";
+        if (!file)
+            throw std::runtime_error(std::string("cannot write ") + path);
+    }
+
+    /* the median of every benchmark in a file written by writeJSON */
+    std::map<std::string, double> readBaseline(const char* path) {
+        std::ifstream file(path);
+        if (!file)
+            throw std::runtime_error(std::string("cannot open baseline ") + path);
+        std::map<std::string, double> medians;
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t name = line.find("\"name\": \"");
+            size_t median = line.find("\"median\": ");
+            if (name == std::string::npos || median == std::string::npos)
+                continue;
+            std::string unescaped;
+            for (size_t i = name + 9; i < line.size() && line[i] != '"'; i++) {
+                if (line[i] == '\\' && i + 1 < line.size())
+                    i++;
+                unescaped += line[i];
+            }
+            medians[unescaped] = atof(line.c_str() + median + 10);
+        }
+        return medians;
+    }
+
+    /* a random sequence of moves, face turns only unless rotations is set */
+    std::vector<Move> randomMoves(std::mt19937& random, size_t n, bool rotations) {
+        std::uniform_int_distribution<int> pick(0, static_cast<int>(rotations ? N_MOVES : N_FACE_MOVES) - 1);
+        std::vector<Move> moves(n);
+        for (Move& move : moves)
+            move = static_cast<Move>(pick(random));
+        return moves;
+    }
+
+    std::vector<std::array<Color, 9>> randomPatterns(std::mt19937& random, size_t n) {
+        std::uniform_int_distribution<int> pick(0, 5);
+        std::vector<std::array<Color, 9>> patterns(n);
+        for (std::array<Color, 9>& pattern : patterns)
+            for (Color& color : pattern)
+                color = static_cast<Color>(pick(random));
+        return patterns;
+    }
+
+    /* every benchmark, with the data it works on made up front */
+    std::vector<Benchmark> makeBenchmarks(const std::string& imagePath) {
+        std::vector<Benchmark> benchmarks;
+        std::mt19937 random(12345);
+
+        // sticker permutations of single moves
+        std::shared_ptr<std::vector<Move>> moves = std::make_shared<std::vector<Move>>(randomMoves(random, 4096, true));
+        benchmarks.push_back({ "CubeState::apply", moves->size(), [moves](size_t n) {
+            CubeState state = CubeState::standard();
+            for (size_t op = 0; op < n; op++)
+                for (Move move : *moves)
+                    state.apply(move);
+            sink += static_cast<uint64_t>(state.stickers[4]);
+        } });
+
+        // the same moves through the face-by-face swaps of Cube
+        std::shared_ptr<std::vector<std::shared_ptr<Instruction>>> instructions = std::make_shared<std::vector<std::shared_ptr<Instruction>>>();
+        for (Move move : *moves)
+            instructions->push_back(toInstruction(move));
+        benchmarks.push_back({ "Cube::perform", instructions->size(), [instructions](size_t n) {
+            Cube cube;
+            for (size_t op = 0; op < n; op++)
+                for (const std::shared_ptr<Instruction>& instruction : *instructions)
+                    cube.perform(instruction.get());
+            Color colors[54];
+            cube.getColors(colors);
+            sink += static_cast<uint64_t>(colors[4]);
+        } });
+
+        // turn animations of a grid of cubes, every queue topped up so it never runs dry
+        const size_t N_CUBES = 1024;
+        std::shared_ptr<CubeArena> arena = std::make_shared<CubeArena>();
+        std::shared_ptr<std::vector<Move>> refill = std::make_shared<std::vector<Move>>(randomMoves(random, 64, true));
+        arena->resize(N_CUBES);
+        for (size_t i = 0; i < N_CUBES; i++) {
+            arena->push(i, refill->data(), refill->size());
+            arena->turnProgress[i] = static_cast<float>(i % 97) / 97;
+        }
+        benchmarks.push_back({ "CubeArena::update", N_CUBES, [arena, refill](size_t n) {
+            for (size_t op = 0; op < n; op++) {
+                arena->update(0, N_CUBES, 0.001f);
+                for (size_t i = 0; i < N_CUBES; i++)
+                    if (arena->queueEnd[i] - arena->queueFront[i] < 8)
+                        arena->push(i, refill->data(), refill->size());
+            }
+            sink += static_cast<uint64_t>(arena->turnProgress[0] * 1000);
+        } });
+
+        // render geometry of cubes caught in the middle of a turn
+        std::shared_ptr<CubeArena> turning = std::make_shared<CubeArena>();
+        turning->resize(N_CUBES);
+        for (size_t i = 0; i < N_CUBES; i++) {
+            std::vector<Move> queue = randomMoves(random, 1, true);
+            turning->push(i, queue.data(), queue.size());
+            turning->turnProgress[i] = 0.5f;
+        }
+        std::shared_ptr<std::vector<float>> buffer = std::make_shared<std::vector<float>>(static_cast<size_t>(CubeArena::FLOATS_PER_CUBE));
+        benchmarks.push_back({ "CubeArena::getVertexData", N_CUBES, [turning, buffer](size_t n) {
+            for (size_t op = 0; op < n; op++)
+                for (size_t i = 0; i < N_CUBES; i++)
+                    turning->getVertexData(i, buffer->data());
+            sink += static_cast<uint64_t>((*buffer)[7]);
+        } });
+        benchmarks.push_back({ "CubeArena::getColorData", N_CUBES, [turning, buffer](size_t n) {
+            for (size_t op = 0; op < n; op++)
+                for (size_t i = 0; i < N_CUBES; i++)
+                    turning->getColorData(i, buffer->data());
+            sink += static_cast<uint64_t>((*buffer)[7] * 255);
+        } });
+
+        // plans of random patterns, from a solved cube and from scrambled ones
+        const size_t N_PATTERNS = 256;
+        std::shared_ptr<std::vector<std::array<Color, 9>>> patterns = std::make_shared<std::vector<std::array<Color, 9>>>(randomPatterns(random, N_PATTERNS));
+        benchmarks.push_back({ "AI::calculatePaint/solved", N_PATTERNS, [patterns](size_t n) {
+            for (size_t op = 0; op < n; op++) {
+                for (std::array<Color, 9> pattern : *patterns) {
+                    AI ai(CubeState::standard().stickers);
+                    ai.calculatePaint(pattern.data());
+                    sink += ai.getInstructions().size();
+                }
+            }
+        } });
+        std::shared_ptr<std::vector<CubeState>> scrambled = std::make_shared<std::vector<CubeState>>(N_PATTERNS, CubeState::standard());
+        for (CubeState& state : *scrambled)
+            for (Move move : randomMoves(random, 40, false))
+                state.apply(move);
+        benchmarks.push_back({ "AI::calculatePaint/scrambled", N_PATTERNS, [patterns, scrambled](size_t n) {
+            for (size_t op = 0; op < n; op++) {
+                for (size_t i = 0; i < N_PATTERNS; i++) {
+                    std::array<Color, 9> pattern = (*patterns)[i];
+                    AI ai((*scrambled)[i].stickers);
+                    ai.calculatePaint(pattern.data());
+                    sink += ai.getInstructions().size();
+                }
+            }
+        } });
+
+        // move lists full of what simplifies: repeats of one face and turns undone right away. Copying the list is part of each op
+        std::shared_ptr<std::vector<Move>> redundant = std::make_shared<std::vector<Move>>();
+        std::uniform_int_distribution<int> pickFace(0, 2), pickRun(1, 4);
+        while (redundant->size() < 200) {
+            Move move = getFaceMove(static_cast<FaceType>(pickFace(random)), random() % 2 == 0);
+            int run = pickRun(random);
+            for (int k = 0; k < run; k++)
+                redundant->push_back(move);
+            if (random() % 3 == 0)
+                redundant->push_back(getInverseMove(move));
+        }
+        benchmarks.push_back({ "AI::simplifyInstructions", redundant->size(), [redundant](size_t n) {
+            std::pmr::vector<Move> instructions;
+            for (size_t op = 0; op < n; op++) {
+                instructions.assign(redundant->begin(), redundant->end());
+                AI::simplifyInstructions(instructions);
+                sink += instructions.size();
+            }
+        } });
+
+        // a 1024x1024 bitmap, mapped and decoded whole
+        const size_t IMAGE_SIZE = 1024;
+        benchmarks.push_back({ "BMPImage::load", IMAGE_SIZE * IMAGE_SIZE, [imagePath](size_t n) {
+            std::vector<unsigned char> rgb(IMAGE_SIZE * IMAGE_SIZE * 3);
+            for (size_t op = 0; op < n; op++) {
+                BMPImage image(imagePath.c_str());
+                image.getRGB(rgb.data());
+                sink += rgb[op % rgb.size()];
+            }
+        } });
+
+        // closest sticker colors, one pixel at a time and a row at a time
+        std::shared_ptr<ColorQuantizer> quantizer = std::make_shared<ColorQuantizer>();
+        std::shared_ptr<std::vector<unsigned char>> pixels = std::make_shared<std::vector<unsigned char>>(4096 * 3);
+        std::uniform_int_distribution<int> pickByte(0, 255);
+        for (unsigned char& byte : *pixels)
+            byte = static_cast<unsigned char>(pickByte(random));
+        benchmarks.push_back({ "ColorQuantizer::quantize", pixels->size() / 3, [quantizer, pixels](size_t n) {
+            uint64_t total = 0;
+            for (size_t op = 0; op < n; op++)
+                for (size_t p = 0; p < pixels->size(); p += 3)
+                    total += static_cast<uint64_t>(quantizer->quantize((*pixels)[p], (*pixels)[p + 1], (*pixels)[p + 2]));
+            sink += total;
+        } });
+        std::shared_ptr<std::vector<Color>> row = std::make_shared<std::vector<Color>>(pixels->size() / 3);
+        benchmarks.push_back({ "ColorQuantizer::quantizeRow", pixels->size() / 3, [quantizer, pixels, row](size_t n) {
+            for (size_t op = 0; op < n; op++)
+                quantizer->quantizeRow(pixels->data(), row->size(), row->data());
+            sink += static_cast<uint64_t>((*row)[0]);
+        } });
+
+        // the whole image pipeline: decode, downsample, dither and quantize to 100x100 cubes
+        benchmarks.push_back({ "ImageStream::nextBand", IMAGE_SIZE * IMAGE_SIZE, [imagePath, quantizer](size_t n) {
+            BMPImage image(imagePath.c_str());
+            std::vector<Color> band(ImageStream::BAND_ROWS * 300);
+            for (size_t op = 0; op < n; op++) {
+                ImageStream stream(image, 100, 100, *quantizer);
+                while (stream.nextBand(band.data()))
+                    sink += static_cast<uint64_t>(band[0]);
+            }
+        } });
+        return benchmarks;
+    }
+
+    /* a smooth image with some noise, so neither the decoder nor the quantizer meets only one color */
+    void writeTestImage(const std::string& path, size_t size) {
+        std::vector<unsigned char> rgb(size * size * 3);
+        std::mt19937 random(7);
+        for (size_t y = 0; y < size; y++) {
+            for (size_t x = 0; x < size; x++) {
+                unsigned char* pixel = &rgb[(y * size + x) * 3];
+                pixel[0] = static_cast<unsigned char>(x * 255 / size);
+                pixel[1] = static_cast<unsigned char>(y * 255 / size);
+                pixel[2] = static_cast<unsigned char>((x + y) * 127 / size + random() % 32);
+            }
+        }
+        BMPImage::save(path.c_str(), rgb.data(), size, size);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // parse arguments
+    const char* filter = nullptr;
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    int repetitions = 15;
+    double warmup = 0.1, minTime = 0.01, threshold = 5;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) // only benchmarks whose name contains the text
+            filter = argv[++i];
+        else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) // samples per benchmark
+            repetitions = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) // seconds run before sampling
+            warmup = atof(argv[++i]);
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) // seconds a sample takes at least
+            minTime = atof(argv[++i]);
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) // results of an earlier --json to compare with
+            baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) // percent a median may grow before it counts as slower
+            threshold = atof(argv[++i]);
+        else {
+            std::cerr << USAGE;
+            return 2;
+        }
+    }
+
+    try {
+        std::map<std::string, double> baseline;
+        if (baselinePath)
+            baseline = readBaseline(baselinePath);
+
+        std::string imagePath = (std::filesystem::temp_directory_path() / "tessellate-bench.bmp").string();
+        writeTestImage(imagePath, 1024);
+        std::vector<Benchmark> benchmarks = makeBenchmarks(imagePath);
+
+        std::vector<Result> results;
+        size_t nSlower = 0;
+        printf("%-30s %12s %12s %12s %10s%s\n", "benchmark (ns per item)", "min", "median", "mean", "stddev", baselinePath ? "   vs baseline" : "");
+        for (const Benchmark& benchmark : benchmarks) {
+            if (filter && benchmark.name.find(filter) == std::string::npos)
+                continue;
+            Result result = measure(benchmark, static_cast<size_t>(std::max(repetitions, 1)), warmup, minTime);
+            results.push_back(result);
+            printf("%-30s %12.3f %12.3f %12.3f %10.3f", result.name.c_str(), result.min, result.median, result.mean, result.stddev);
+
+            // the change of the median, called slower or faster once it passes the threshold
+            auto before = baseline.find(result.name);
+            if (before != baseline.end() && before->second > 0) {
+                double change = (result.median / before->second - 1) * 100;
+                const char* verdict = change > threshold ? "slower" : change < -threshold ? "faster" : "same";
+                printf("   %+7.1f%% %s", change, verdict);
+                if (change > threshold)
+                    nSlower++;
+            } else if (baselinePath) {
+                printf("   new");
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+        remove(imagePath.c_str());
+
+        if (jsonPath)
+            writeJSON(jsonPath, results, static_cast<size_t>(std::max(repetitions, 1)));
+        if (nSlower > 0) {
+            std::cout << nSlower << " benchmark(s) slower than the baseline by more than " << threshold << "%" << std::endl;
+            return 1;
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
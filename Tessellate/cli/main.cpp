@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ColorQuantizer.hpp"
+#include "Grid.hpp"
+#include "GridFit.hpp"
+#include "ImageSource.hpp"
+#include "ImageStream.hpp"
+#include "JobSystem.hpp"
+#include "BMPImage.hpp"
+#include "SolutionCache.hpp"
+#include "SolveServer.hpp"
+
+/* Solves an image without a window: plans the grid on every core, then writes what each cube does and how the mosaic turns out.
+   With --serve it instead stays up and solves for other programs over a socket (see SolveServer) */
+
+namespace {
+    const char* const USAGE =
+        "usage: tessellate-cli <image> [--cubes ROWSxCOLS | --budget N] [--fit stretch|crop|letterbox]\n"
+        "                      [--dither fs|bayer4|bayer8|bluenoise] [--stickers FILE]\n"
+        "                      [--moves FILE] [--stats FILE] [--preview FILE.bmp] [--scale PIXELS]\n"
+        "       tessellate-cli --serve SOCKET [--stickers FILE] [--cache DIR] [--cache-size MEGABYTES]\n";
+
+    const size_t DEFAULT_BUDGET = 1024;
+
+    /* how many moves the cubes take */
+    struct MoveStats {
+        size_t total, min, max;
+    };
+
+    /* "row col count: moves" per cube, in grid order */
+    void writeMoves(const char* path, const Grid& grid) {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+            throw std::runtime_error(std::string("cannot open ") + path + " for writing");
+        const CubeArena& cubes = grid.cubes;
+        std::string line;
+        for (size_t i = 0; i < cubes.size(); i++) {
+            line = std::to_string(i / grid.nCols) + " " + std::to_string(i % grid.nCols) + " "
+                + std::to_string(cubes.queueEnd[i] - cubes.queueFront[i]) + ":";
+            for (uint32_t m = cubes.queueFront[i]; m < cubes.queueEnd[i]; m++) {
+                line += ' ';
+                line += getMoveName(cubes.movePool[m]);
+            }
+            line += '\n';
+            file << line;
+        }
+        if (!file)
+            throw std::runtime_error(std::string("cannot write ") + path);
+    }
+
+    void writeStats(const char* path, const char* imagePath, const GridFit& fit, const ImageSource& image, FitMode fitMode,
+        DitherMode ditherMode, const MoveStats& moves, size_t nCubes, double solveSeconds, size_t nThreads) {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+            throw std::runtime_error(std::string("cannot open ") + path + " for writing");
+        std::string escaped;
+        for (const char* c = imagePath; *c; c++) {
+            if (*c == '"' || *c == '\\')
+                escaped += '\\';
+            escaped += *c;
+        }
+        char json[1024];
+        snprintf(json, sizeof(json),
+            "{\n"
+            "  \"image\": \"%s\",\n"
+            "  \"imageWidth\": %zu,\n"
+            "  \"imageHeight\": %zu,\n"
+            "  \"rows\": %zu,\n"
+            "  \"cols\": %zu,\n"
+            "  \"cubes\": %zu,\n"
+            "  \"fit\": \"%s\",\n"
+            "  \"dither\": \"%s\",\n"
+            "  \"threads\": %zu,\n"
+            "  \"solveSeconds\": %.6f,\n"
+            "  \"cubesPerSecond\": %.1f,\n"
+            "  \"moves\": { \"total\": %zu, \"min\": %zu, \"max\": %zu, \"mean\": %.2f }\n"
+            "}\n",
+            escaped.c_str(), image.getWidth(), image.getHeight(), fit.rows, fit.cols, nCubes, getFitModeName(fitMode),
+            getDitherModeName(ditherMode), nThreads, solveSeconds, solveSeconds > 0 ? nCubes / solveSeconds : 0.0,
+            moves.total, moves.min, moves.max, nCubes > 0 ? static_cast<double>(moves.total) / nCubes : 0.0);
+        file << json;
+        if (!file)
+            throw std::runtime_error(std::string("cannot write ") + path);
+    }
+
+    /* draws the UP face every cube ends with, scale pixels per sticker */
+    void writePreview(const char* path, const Grid& grid, const ColorQuantizer& quantizer, size_t scale) {
+        const CubeArena& cubes = grid.cubes;
+        size_t width = grid.nCols * 3 * scale, height = grid.nRows * 3 * scale;
+        std::vector<unsigned char> rgb(width * height * 3);
+
+        // every cube plays its queue on a copy of its state, then paints its block of the image
+        JobSystem::shared().parallelFor(cubes.size(), 64, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; i++) {
+                CubeState state = cubes.states[i];
+                for (uint32_t m = cubes.queueFront[i]; m < cubes.queueEnd[i]; m++)
+                    state.apply(cubes.movePool[m]);
+                size_t top = i / grid.nCols * 3 * scale, left = i % grid.nCols * 3 * scale;
+                for (unsigned int s = 0; s < 9; s++) {
+                    const glm::vec3& color = quantizer.getStickerColor(state.getColorAt(FaceType::UP, s));
+                    for (size_t y = 0; y < scale; y++) {
+                        unsigned char* pixel = &rgb[((top + s / 3 * scale + y) * width + left + s % 3 * scale) * 3];
+                        for (size_t x = 0; x < scale; x++, pixel += 3) {
+                            pixel[0] = static_cast<unsigned char>(color.r);
+                            pixel[1] = static_cast<unsigned char>(color.g);
+                            pixel[2] = static_cast<unsigned char>(color.b);
+                        }
+                    }
+                }
+            }
+        });
+        BMPImage::save(path, rgb.data(), width, height);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // parse arguments
+    const char* imagePath = nullptr;
+    const char* stickersPath = nullptr;
+    const char* movesPath = nullptr;
+    const char* statsPath = nullptr;
+    const char* previewPath = nullptr;
+    const char* servePath = nullptr;
+    const char* cachePath = nullptr;
+    int rows = 0, cols = 0, budget = 0, scale = 8, cacheMegabytes = 64;
+    FitMode fitMode = FitMode::CROP;
+    DitherMode ditherMode = DitherMode::ERROR_DIFFUSION;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--cubes") == 0 && i + 1 < argc) { // ROWSxCOLS, or N for a square grid
+            if (sscanf(argv[++i], "%dx%d", &rows, &cols) == 1)
+                cols = rows;
+        } else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) // maximum number of cubes
+            budget = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--fit") == 0 && i + 1 < argc) {
+            if (!parseFitMode(argv[++i], fitMode)) {
+                std::cerr << "Unknown fit mode " << argv[i] << std::endl;
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--dither") == 0 && i + 1 < argc) {
+            if (!parseDitherMode(argv[++i], ditherMode)) {
+                std::cerr << "Unknown dithering mode " << argv[i] << std::endl;
+                return 2;
+            }
+        } else if (strcmp(argv[i], "--stickers") == 0 && i + 1 < argc)
+            stickersPath = argv[++i];
+        else if (strcmp(argv[i], "--moves") == 0 && i + 1 < argc) // move list of every cube
+            movesPath = argv[++i];
+        else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) // JSON
+            statsPath = argv[++i];
+        else if (strcmp(argv[i], "--preview") == 0 && i + 1 < argc) // bitmap of the finished mosaic
+            previewPath = argv[++i];
+        else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) // preview pixels per sticker
+            scale = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) // UNIX socket to solve on
+            servePath = argv[++i];
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) // directory to keep the server's solved images in
+            cachePath = argv[++i];
+        else if (strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc) // megabytes the cache may use
+            cacheMegabytes = atoi(argv[++i]);
+        else if (argv[i][0] != '-' && !imagePath)
+            imagePath = argv[i];
+        else {
+            std::cerr << "Unknown argument " << argv[i] << "\n" << USAGE;
+            return 2;
+        }
+    }
+    if (!imagePath && !servePath) {
+        std::cerr << USAGE;
+        return 2;
+    }
+
+    try {
+        ColorQuantizer quantizer = stickersPath ? ColorQuantizer::fromFile(stickersPath) : ColorQuantizer();
+        if (servePath) {
+            std::shared_ptr<SolutionCache> cache;
+            if (cachePath)
+                cache = std::make_shared<SolutionCache>(cachePath, static_cast<uintmax_t>(cacheMegabytes > 0 ? cacheMegabytes : 64) * 1024 * 1024);
+            SolveServer server(servePath, quantizer, cache);
+            server.run();
+            return 1;
+        }
+
+        std::unique_ptr<ImageSource> image = ImageSource::open(imagePath);
+        GridFit fit = rows > 0 && cols > 0
+            ? GridFit::forSize(image->getWidth(), image->getHeight(), rows, cols, fitMode)
+            : GridFit::forBudget(image->getWidth(), image->getHeight(), budget > 0 ? budget : DEFAULT_BUDGET, fitMode);
+
+        // bands are decoded on this thread while the tiles of the ones before are planned on the others
+        auto start = std::chrono::steady_clock::now();
+        ImageStream stream(*image, fit, quantizer, ditherMode);
+        Grid grid(1, 1);
+        grid.solveImage(stream);
+        double solveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const CubeArena& cubes = grid.cubes;
+        MoveStats moves{ 0, SIZE_MAX, 0 };
+        for (size_t i = 0; i < cubes.size(); i++) {
+            size_t n = cubes.queueEnd[i] - cubes.queueFront[i];
+            moves.total += n;
+            moves.min = std::min(moves.min, n);
+            moves.max = std::max(moves.max, n);
+        }
+        if (cubes.size() == 0)
+            moves.min = 0;
+        size_t nThreads = JobSystem::shared().getThreadCount() + 1; // the pool and this thread
+
+        if (movesPath)
+            writeMoves(movesPath, grid);
+        if (statsPath)
+            writeStats(statsPath, imagePath, fit, *image, fitMode, ditherMode, moves, cubes.size(), solveSeconds, nThreads);
+        if (previewPath)
+            writePreview(previewPath, grid, quantizer, static_cast<size_t>(std::max(scale, 1)));
+
+        std::cout << grid.nRows << "x" << grid.nCols << " cubes, " << moves.total << " moves in " << static_cast<long>(solveSeconds * 1000)
+            << " ms on " << nThreads << " threads" << std::endl;
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
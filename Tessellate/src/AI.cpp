@@ -1,25 +1,34 @@
 #include "AI.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <typeinfo>
 
-AI::AI(Cube* cube)
-	: cube(cube), futureCube(new Cube(cube)) {}
+AI::AI(CubeRef cube)
+	: cube(cube), arena(scratch, sizeof(scratch)), instructions(&arena) {
+	cube.getColors(snapshot);
+	std::copy(snapshot, snapshot + 54, futureState.stickers);
+}
 
-AI::~AI() {
-	delete futureCube;
+AI::AI(const Color colors[54])
+	: cube(), arena(scratch, sizeof(scratch)), instructions(&arena) {
+	std::copy(colors, colors + 54, snapshot);
+	std::copy(snapshot, snapshot + 54, futureState.stickers);
 }
 
 void AI::calculatePaint(Color pattern[9]) {
-	// clear pending instructions
-	instructions.clear();
+	// forget the last plan and hand its memory back to the arena in one go
+	std::pmr::vector<Move>(&arena).swap(instructions);
+	arena.release();
+	instructions.reserve(INITIAL_INSTRUCTIONS);
 
 	// create copy of the displayed cube
-	delete futureCube;
-	futureCube = new Cube(cube);
+	if (cube)
+		cube.getColors(snapshot);
+	std::copy(snapshot, snapshot + 54, futureState.stickers);
 
 	// algorithm to "paint" top face
-	if (cube->getQueueSize() == 0) {
+	if (!cube || cube.getQueueSize() == 0) {
 
 		// rotate so that center is on top
 		rotateToTopCenter(pattern[4]);
@@ -36,7 +45,7 @@ void AI::calculatePaint(Color pattern[9]) {
 			loopcounter++;
 			if (loopcounter > 10) {
 				std::cout << "INFINITE LOOP WHEN SOLVING CROSS. Here's the pattern: " << std::endl;
-				futureCube->print();
+				Cube(futureState.stickers).print();
 			}
 			// for each face on the x and z axes
 			for (const FaceType& f : faces_on_xz) {
@@ -45,13 +54,13 @@ void AI::calculatePaint(Color pattern[9]) {
 
 				// if the edge is in the middle layer and not the top layer, rotate the face until the edge is on top
 				if (!isEdgeInTopLayer(f, c) && (isEdgeMiddleLeft(f, c) || isEdgeMiddleRight(f, c))) {
-					std::shared_ptr<Instruction> instruction = std::make_shared<FaceInstruction>(f, isEdgeMiddleLeft(f, Color::WHITE));
+					Move instruction = getFaceMove(f, isEdgeMiddleLeft(f, Color::WHITE));
 					addInstruction(instruction);
 				}
 				// if the edge is in the bottom layer and not the top layer, rotate the face until the edge is on top
 				if (!isEdgeInTopLayer(f, c) && isEdgeInBottomLayer(f, c)) {
-					std::shared_ptr<Instruction> instruction0 = std::make_shared<FaceInstruction>(f);
-					std::shared_ptr<Instruction> instruction1 = std::make_shared<FaceInstruction>(f);
+					Move instruction0 = getFaceMove(f);
+					Move instruction1 = getFaceMove(f);
 					addInstruction(instruction0);
 					addInstruction(instruction1);
 				}
@@ -63,9 +72,9 @@ void AI::calculatePaint(Color pattern[9]) {
 						|| isEdgeMiddleLeft(f, getTargetEdgeColorOf(getRelRightOnY(getRelRightOnY(f)), pattern)) // BACK face's target edge is in middle left
 						)) { 
 					// rotate face cc, rotate DOWN, rotate face clockwise
-					std::shared_ptr<Instruction> instruction0 = std::make_shared<FaceInstruction>(f, false);
-					std::shared_ptr<Instruction> instruction1 = std::make_shared<FaceInstruction>(FaceType::DOWN);
-					std::shared_ptr<Instruction> instruction2 = std::make_shared<FaceInstruction>(f);
+					Move instruction0 = getFaceMove(f, false);
+					Move instruction1 = getFaceMove(FaceType::DOWN);
+					Move instruction2 = getFaceMove(f);
 					addInstruction(instruction0);
 					addInstruction(instruction1);
 					addInstruction(instruction2);
@@ -81,20 +90,20 @@ void AI::calculatePaint(Color pattern[9]) {
 				bool isLTargInBottom = isEdgeInBottomLayer(f, relLeftTarg) && !isEdgeInTopLayer(getRelLeftOnY(f), relLeftTarg); // LEFT face's target edge is in bottom
 
 				if (isRTargInBottom) { // if the RIGHT face's target color is in the bottom layer of this face and it is not in the top layer of the RIGHT face
-					std::shared_ptr<Instruction> rotateD = std::make_shared<FaceInstruction>(FaceType::DOWN);
-					std::shared_ptr<Instruction> rotateRelR = std::make_shared<FaceInstruction>(getRelRightOnY(f));
+					Move rotateD = getFaceMove(FaceType::DOWN);
+					Move rotateRelR = getFaceMove(getRelRightOnY(f));
 					addInstruction(rotateD);
 					addInstruction(rotateRelR);
 					addInstruction(rotateRelR);
 				} else if (isLTargInBottom) {
-					std::shared_ptr<Instruction> rotateDCC = std::make_shared<FaceInstruction>(FaceType::DOWN);
-					std::shared_ptr<Instruction> rotateRelL = std::make_shared<FaceInstruction>(getRelLeftOnY(f));
+					Move rotateDCC = getFaceMove(FaceType::DOWN);
+					Move rotateRelL = getFaceMove(getRelLeftOnY(f));
 					addInstruction(rotateDCC);
 					addInstruction(rotateRelL);
 					addInstruction(rotateRelL);
 				} else if (isBTargInBottom) {
-					std::shared_ptr<Instruction> rotateD = std::make_shared<FaceInstruction>(FaceType::DOWN);
-					std::shared_ptr<Instruction> rotateRelB = std::make_shared<FaceInstruction>(getRelRightOnY(getRelRightOnY(f)));
+					Move rotateD = getFaceMove(FaceType::DOWN);
+					Move rotateRelB = getFaceMove(getRelRightOnY(getRelRightOnY(f)));
 					addInstruction(rotateD);
 					addInstruction(rotateD);
 					addInstruction(rotateRelB);
@@ -119,7 +128,7 @@ void AI::calculatePaint(Color pattern[9]) {
 			Color c = pattern[i];
 
 			// is it already in the correct location?
-			if (futureCube->getFace(FaceType::UP)->getColorAt(i) == c)
+			if (futureState.getColorAt(FaceType::UP, i) == c)
 				continue;
 
 			// if not, locate the tile
@@ -139,15 +148,15 @@ void AI::calculatePaint(Color pattern[9]) {
 			if (!faceFound) {
 				for (const FaceType& f : faces_on_xz) {
 					// if corner is in the top left of a face and that face's top left corner is not correct, bring it to the bottom layer
-					if (isCornerTopLeft(f, c) && !(f == FaceType::FRONT && futureCube->getFace(FaceType::UP)->getColorAt(6) == pattern[6]
-						|| f == FaceType::RIGHT && futureCube->getFace(FaceType::UP)->getColorAt(8) == pattern[8]
-						|| f == FaceType::BACK && futureCube->getFace(FaceType::UP)->getColorAt(2) == pattern[2]
-						|| f == FaceType::LEFT && futureCube->getFace(FaceType::UP)->getColorAt(0) == pattern[0])) {
+					if (isCornerTopLeft(f, c) && !(f == FaceType::FRONT && futureState.getColorAt(FaceType::UP, 6) == pattern[6]
+						|| f == FaceType::RIGHT && futureState.getColorAt(FaceType::UP, 8) == pattern[8]
+						|| f == FaceType::BACK && futureState.getColorAt(FaceType::UP, 2) == pattern[2]
+						|| f == FaceType::LEFT && futureState.getColorAt(FaceType::UP, 0) == pattern[0])) {
 						// rotate face cc, DOWN cc, face clockwise, DOWN clockwise
-						std::shared_ptr<Instruction> instruction0 = std::make_shared<FaceInstruction>(f, false);
-						std::shared_ptr<Instruction> instruction1 = std::make_shared<FaceInstruction>(FaceType::DOWN, false);
-						std::shared_ptr<Instruction> instruction2 = std::make_shared<FaceInstruction>(f);
-						std::shared_ptr<Instruction> instruction3 = std::make_shared<FaceInstruction>(FaceType::DOWN);
+						Move instruction0 = getFaceMove(f, false);
+						Move instruction1 = getFaceMove(FaceType::DOWN, false);
+						Move instruction2 = getFaceMove(f);
+						Move instruction3 = getFaceMove(FaceType::DOWN);
 						addInstruction(instruction0);
 						addInstruction(instruction1);
 						addInstruction(instruction2);
@@ -167,23 +176,23 @@ void AI::calculatePaint(Color pattern[9]) {
 				|| i == 2 && faceWCorner != FaceType::BACK
 				|| i == 6 && faceWCorner != FaceType::FRONT
 				|| i == 8 && faceWCorner != FaceType::RIGHT) {
-				std::shared_ptr<Instruction> down = std::make_shared<FaceInstruction>(FaceType::DOWN);
+				Move down = getFaceMove(FaceType::DOWN);
 				addInstruction(down);
 				faceWCorner = getRelRightOnY(faceWCorner);
 			}
 
 			// if the tile is on the DOWN face, bring it up to a face on x or z
-			if (faceWCorner == FaceType::FRONT && futureCube->getFace(FaceType::DOWN)->getColorAt(0) == c
-				|| faceWCorner == FaceType::RIGHT && futureCube->getFace(FaceType::DOWN)->getColorAt(2) == c
-				|| faceWCorner == FaceType::LEFT && futureCube->getFace(FaceType::DOWN)->getColorAt(6) == c
-				|| faceWCorner == FaceType::BACK && futureCube->getFace(FaceType::DOWN)->getColorAt(8) == c) {
+			if (faceWCorner == FaceType::FRONT && futureState.getColorAt(FaceType::DOWN, 0) == c
+				|| faceWCorner == FaceType::RIGHT && futureState.getColorAt(FaceType::DOWN, 2) == c
+				|| faceWCorner == FaceType::LEFT && futureState.getColorAt(FaceType::DOWN, 6) == c
+				|| faceWCorner == FaceType::BACK && futureState.getColorAt(FaceType::DOWN, 8) == c) {
 
 				// rel left clockwise, down cc, rel left cc, down, down
-				std::shared_ptr<Instruction> relLeft = std::make_shared<FaceInstruction>(getRelLeftOnY(faceWCorner));
-				std::shared_ptr<Instruction> downCC = std::make_shared<FaceInstruction>(FaceType::DOWN, false);
-				std::shared_ptr<Instruction> relLeftCC = std::make_shared<FaceInstruction>(getRelLeftOnY(faceWCorner), false);
-				std::shared_ptr<Instruction> down0 = std::make_shared<FaceInstruction>(FaceType::DOWN);
-				std::shared_ptr<Instruction> down1 = std::make_shared<FaceInstruction>(FaceType::DOWN);
+				Move relLeft = getFaceMove(getRelLeftOnY(faceWCorner));
+				Move downCC = getFaceMove(FaceType::DOWN, false);
+				Move relLeftCC = getFaceMove(getRelLeftOnY(faceWCorner), false);
+				Move down0 = getFaceMove(FaceType::DOWN);
+				Move down1 = getFaceMove(FaceType::DOWN);
 				addInstruction(relLeft);
 				addInstruction(downCC);
 				addInstruction(relLeftCC);
@@ -194,23 +203,23 @@ void AI::calculatePaint(Color pattern[9]) {
 			// the desired tile is now in the bottom left corner of faceWCorner on an x_z face
 
 			// if tile is in the bottom left of this face
-			if (faceWCorner != FaceType::BACK && futureCube->getFace(faceWCorner)->getColorAt(6) == c
-				|| faceWCorner == FaceType::BACK && futureCube->getFace(faceWCorner)->getColorAt(2) == c) {
+			if (faceWCorner != FaceType::BACK && futureState.getColorAt(faceWCorner, 6) == c
+				|| faceWCorner == FaceType::BACK && futureState.getColorAt(faceWCorner, 2) == c) {
 				// down, rel left, down cc, rel left cc
-				std::shared_ptr<Instruction> instruction0 = std::make_shared<FaceInstruction>(FaceType::DOWN);
-				std::shared_ptr<Instruction> instruction1 = std::make_shared<FaceInstruction>(getRelLeftOnY(faceWCorner));
-				std::shared_ptr<Instruction> instruction2 = std::make_shared<FaceInstruction>(FaceType::DOWN, false);
-				std::shared_ptr<Instruction> instruction3 = std::make_shared<FaceInstruction>(getRelLeftOnY(faceWCorner), false);
+				Move instruction0 = getFaceMove(FaceType::DOWN);
+				Move instruction1 = getFaceMove(getRelLeftOnY(faceWCorner));
+				Move instruction2 = getFaceMove(FaceType::DOWN, false);
+				Move instruction3 = getFaceMove(getRelLeftOnY(faceWCorner), false);
 				addInstruction(instruction0);
 				addInstruction(instruction1);
 				addInstruction(instruction2);
 				addInstruction(instruction3);
 			} else { // tile is in the bottom right of the relatively left face
 				// down cc, face cc, down, face
-				std::shared_ptr<Instruction> instruction0 = std::make_shared<FaceInstruction>(FaceType::DOWN, false);
-				std::shared_ptr<Instruction> instruction1 = std::make_shared<FaceInstruction>(faceWCorner, false);
-				std::shared_ptr<Instruction> instruction2 = std::make_shared<FaceInstruction>(FaceType::DOWN);
-				std::shared_ptr<Instruction> instruction3 = std::make_shared<FaceInstruction>(faceWCorner);
+				Move instruction0 = getFaceMove(FaceType::DOWN, false);
+				Move instruction1 = getFaceMove(faceWCorner, false);
+				Move instruction2 = getFaceMove(FaceType::DOWN);
+				Move instruction3 = getFaceMove(faceWCorner);
 				addInstruction(instruction0);
 				addInstruction(instruction1);
 				addInstruction(instruction2);
@@ -220,14 +229,14 @@ void AI::calculatePaint(Color pattern[9]) {
 		/*// verify pattern is correct
 		bool match = true;
 		for (int j = 0; j < 9; j++) {
-			if (futureCube->getFace(static_cast<FaceType>(FaceType::UP))->getColorAt(j) != pattern[j]) {
+			if (futureState.getColorAt(static_cast<FaceType>(FaceType::UP), j) != pattern[j]) {
 				match = false;
 				break;
 			}
 		}
 		std::cout << "UP " << (match ? "matches" : "DOES NOT MATCH") << " the pattern" << std::endl;
 		if (!match)
-			cube->print();
+			cube.print();
 
 		// simplify instruction set
 		std::cout << "simplification: " << '\n';
@@ -239,36 +248,35 @@ void AI::calculatePaint(Color pattern[9]) {
 }
 
 void AI::start() {
-	for (std::shared_ptr<Instruction>& instruction : instructions) { // use the & to avoid copying the instruction objects into the scope
-		cube->addToQueue(instruction);
-	}
+	cube.addToQueue(instructions.data(), instructions.size());
 	instructions.clear();
 }
 
-void AI::addInstruction(std::shared_ptr<Instruction>& instruction) {
-	futureCube->perform(instruction.get(), 0); // perform the instruction instantly on futureCube
+const std::pmr::vector<Move>& AI::getInstructions() const {
+	return instructions;
+}
+
+void AI::addInstruction(Move instruction) {
+	futureState.apply(instruction); // perform the instruction instantly on futureState
 	instructions.push_back(instruction);
 }
 
-void AI::simplifyInstructions(std::vector<std::shared_ptr<Instruction>>& instructions) {
+void AI::simplifyInstructions(std::pmr::vector<Move>& instructions) {
 
 	bool simplified = false; // becomes true if a simplification occurred
 
 	// for each instruction
 	for (int i = 0; i < static_cast<int>(instructions.size()); i++) {
-		std::shared_ptr<Instruction>& inst = instructions[i];
+		Move inst = instructions[i];
 		
 		// simplify face instructions
-		if (inst.get()->isFaceInstruction()) {
+		if (isFaceMove(inst)) {
 
 			// remove unnecessary rotations ex. FFFF
 			if (i + 3 < static_cast<int>(instructions.size())
-				&& instructions[i + 1].get()->isFaceInstruction()
-				&& instructions[i + 2].get()->isFaceInstruction()
-				&& instructions[i + 3].get()->isFaceInstruction()
-				&& *static_cast<FaceInstruction*>(inst.get()) == *static_cast<FaceInstruction*>(instructions[i + 1].get())
-				&& *static_cast<FaceInstruction*>(inst.get()) == *static_cast<FaceInstruction*>(instructions[i + 2].get())
-				&& *static_cast<FaceInstruction*>(inst.get()) == *static_cast<FaceInstruction*>(instructions[i + 3].get())
+				&& inst == instructions[i + 1]
+				&& inst == instructions[i + 2]
+				&& inst == instructions[i + 3]
 				) {
 				instructions.erase(instructions.begin() + i, instructions.begin() + i + 4);
 				i--;
@@ -277,9 +285,8 @@ void AI::simplifyInstructions(std::vector<std::shared_ptr<Instruction>>& instruc
 
 
 			// remove opposing face instructions ex. FF'
-			} else if (i + 1 < static_cast<int>(instructions.size()) && instructions[i + 1].get()->isFaceInstruction()
-				&& static_cast<FaceInstruction*>(inst.get())->getFace() == static_cast<FaceInstruction*>(instructions[i + 1].get())->getFace()
-				&& static_cast<FaceInstruction*>(inst.get())->isClockwise() != static_cast<FaceInstruction*>(instructions[i + 1].get())->isClockwise()
+			} else if (i + 1 < static_cast<int>(instructions.size())
+				&& instructions[i + 1] == getInverseMove(inst)
 				) {
 				instructions.erase(instructions.begin() + i, instructions.begin() + i + 2);
 				i--;
@@ -287,12 +294,10 @@ void AI::simplifyInstructions(std::vector<std::shared_ptr<Instruction>>& instruc
 
 			// optimize inefficient face instructions ex. FFF -> F'
 			} else if (i + 2 < static_cast<int>(instructions.size())
-				&& instructions[i + 1].get()->isFaceInstruction()
-				&& instructions[i + 2].get()->isFaceInstruction()
-				&& *static_cast<FaceInstruction*>(inst.get()) == *static_cast<FaceInstruction*>(instructions[i + 1].get())
-				&& *static_cast<FaceInstruction*>(inst.get()) == *static_cast<FaceInstruction*>(instructions[i + 2].get())
+				&& inst == instructions[i + 1]
+				&& inst == instructions[i + 2]
 				) {
-				static_cast<FaceInstruction*>(inst.get())->setDirection(!static_cast<FaceInstruction*>(inst.get())->isClockwise()); // flip direction of first instruction
+				instructions[i] = getInverseMove(inst); // flip direction of first instruction
 				instructions.erase(instructions.begin() + i + 1, instructions.begin() + i + 3); // erase next and next-next instructions
 				// did not erase inst from instructions; no need to decrement i
 				simplified = true;
@@ -311,8 +316,8 @@ void AI::simplifyInstructions(std::vector<std::shared_ptr<Instruction>>& instruc
 }
 
 void AI::printInstructions() {
-	for (std::shared_ptr<Instruction>& inst : instructions)
-		inst.get()->print();
+	for (Move inst : instructions)
+		std::cout << getMoveName(inst);
 	std::cout << std::endl;
 }
 
@@ -352,7 +357,7 @@ void AI::rotateToTopCenter(Color c) {
 	// find which face has the color
 	FaceType hasColor = static_cast<FaceType>(0);
 	for (int i = 0; i < 6; i++) {
-		if (futureCube->getFace(static_cast<FaceType>(i))->getColorAt(4) == c) {
+		if (futureState.getColorAt(static_cast<FaceType>(i), 4) == c) {
 			hasColor = static_cast<FaceType>(i);
 			break;
 		}
@@ -360,29 +365,29 @@ void AI::rotateToTopCenter(Color c) {
 
 	// add instructions to rotate cube
 	if (hasColor == FaceType::FRONT) {
-		std::shared_ptr<Instruction> instruction = std::make_shared<CubeInstruction>(glm::vec3(-1, 0, 0));
+		Move instruction = Move::X_PRIME;
 		addInstruction(instruction);
 
 	} else if (hasColor == FaceType::UP) {
 		return;
 
 	} else if (hasColor == FaceType::BACK) {
-		std::shared_ptr<Instruction> instruction = std::make_shared<CubeInstruction>(glm::vec3(1, 0, 0));
+		Move instruction = Move::X;
 		addInstruction(instruction);
 
 	} else if (hasColor == FaceType::DOWN) {
-		std::shared_ptr<Instruction> instruction0 = std::make_shared<CubeInstruction>(glm::vec3(1, 0, 0));
-		std::shared_ptr<Instruction> instruction1 = std::make_shared<CubeInstruction>(glm::vec3(1, 0, 0));
+		Move instruction0 = Move::X;
+		Move instruction1 = Move::X;
 		addInstruction(instruction0);
 		addInstruction(instruction1);
 
 
 	} else if (hasColor == FaceType::LEFT) {
-		std::shared_ptr<Instruction> instruction = std::make_shared<CubeInstruction>(glm::vec3(0, 0, -1));
+		Move instruction = Move::Z_PRIME;
 		addInstruction(instruction);
 
 	} else { // right
-		std::shared_ptr<Instruction> instruction = std::make_shared<CubeInstruction>(glm::vec3(0, 0, 1));
+		Move instruction = Move::Z;
 		addInstruction(instruction);
 
 	}
@@ -422,7 +427,7 @@ bool AI::isEdgeInTopLayer(FaceType face, Color color)
 		upSquare = 5;
 		break;
 	}
-	return (futureCube->getFace(FaceType::UP)->getColorAt(upSquare) == color || futureCube->getFace(face)->getColorAt(edgeSquare) == color);
+	return (futureState.getColorAt(FaceType::UP, upSquare) == color || futureState.getColorAt(face, edgeSquare) == color);
 }
 
 bool AI::isEdgeMiddleLeft(FaceType face, Color color)
@@ -431,20 +436,20 @@ bool AI::isEdgeMiddleLeft(FaceType face, Color color)
 	Color relLeftColor = Color::RED; // Color of square on the right edge of the relatively left face
 	switch (face) {
 	case FaceType::FRONT:
-		edgeColor = futureCube->getFace(face)->getColorAt(3);
-		relLeftColor = futureCube->getFace(FaceType::LEFT)->getColorAt(5);
+		edgeColor = futureState.getColorAt(face, 3);
+		relLeftColor = futureState.getColorAt(FaceType::LEFT, 5);
 		break;
 	case FaceType::BACK:
-		edgeColor = futureCube->getFace(face)->getColorAt(5);
-		relLeftColor = futureCube->getFace(FaceType::RIGHT)->getColorAt(5);
+		edgeColor = futureState.getColorAt(face, 5);
+		relLeftColor = futureState.getColorAt(FaceType::RIGHT, 5);
 		break;
 	case FaceType::LEFT:
-		edgeColor = futureCube->getFace(face)->getColorAt(3);
-		relLeftColor = futureCube->getFace(FaceType::BACK)->getColorAt(3);
+		edgeColor = futureState.getColorAt(face, 3);
+		relLeftColor = futureState.getColorAt(FaceType::BACK, 3);
 		break;
 	case FaceType::RIGHT:
-		edgeColor = futureCube->getFace(face)->getColorAt(3);
-		relLeftColor = futureCube->getFace(FaceType::FRONT)->getColorAt(5);
+		edgeColor = futureState.getColorAt(face, 3);
+		relLeftColor = futureState.getColorAt(FaceType::FRONT, 5);
 		break;
 	}
 	return (edgeColor == color || relLeftColor == color);
@@ -456,20 +461,20 @@ bool AI::isEdgeMiddleRight(FaceType face, Color color)
 	Color relRightColor = Color::RED; // Color of square on the right edge of the relatively left face
 	switch (face) {
 	case FaceType::FRONT:
-		edgeColor = futureCube->getFace(face)->getColorAt(5);
-		relRightColor = futureCube->getFace(FaceType::RIGHT)->getColorAt(3);
+		edgeColor = futureState.getColorAt(face, 5);
+		relRightColor = futureState.getColorAt(FaceType::RIGHT, 3);
 		break;
 	case FaceType::BACK:
-		edgeColor = futureCube->getFace(face)->getColorAt(3);
-		relRightColor = futureCube->getFace(FaceType::LEFT)->getColorAt(3);
+		edgeColor = futureState.getColorAt(face, 3);
+		relRightColor = futureState.getColorAt(FaceType::LEFT, 3);
 		break;
 	case FaceType::LEFT:
-		edgeColor = futureCube->getFace(face)->getColorAt(5);
-		relRightColor = futureCube->getFace(FaceType::FRONT)->getColorAt(3);
+		edgeColor = futureState.getColorAt(face, 5);
+		relRightColor = futureState.getColorAt(FaceType::FRONT, 3);
 		break;
 	case FaceType::RIGHT:
-		edgeColor = futureCube->getFace(face)->getColorAt(5);
-		relRightColor = futureCube->getFace(FaceType::BACK)->getColorAt(5);
+		edgeColor = futureState.getColorAt(face, 5);
+		relRightColor = futureState.getColorAt(FaceType::BACK, 5);
 		break;
 	}
 	return (edgeColor == color || relRightColor == color);
@@ -497,30 +502,30 @@ bool AI::isEdgeInBottomLayer(FaceType face, Color color)
 		downSquare = 5;
 		break;
 	}
-	return (futureCube->getFace(FaceType::DOWN)->getColorAt(downSquare) == color || futureCube->getFace(face)->getColorAt(edgeSquare) == color);
+	return (futureState.getColorAt(FaceType::DOWN, downSquare) == color || futureState.getColorAt(face, edgeSquare) == color);
 }
 
 bool AI::isEdgeFlipped(FaceType face, Color color)
 {
 	// return false if a square of Color is on the face
 	if (face == FaceType::FRONT || face == FaceType::RIGHT || face == FaceType::LEFT)
-		return futureCube->getFace(face)->getColorAt(1) == color;
+		return futureState.getColorAt(face, 1) == color;
 	else // back face
-		return futureCube->getFace(face)->getColorAt(7) == color;
+		return futureState.getColorAt(face, 7) == color;
 }
 
 void AI::flipEdge(FaceType face) {
 	// rotate face counterclockwise
-	std::shared_ptr<Instruction> rotFaceCC = std::make_shared<FaceInstruction>(face, false);
+	Move rotFaceCC = getFaceMove(face, false);
 
 	// rotate UP clockwise
-	std::shared_ptr<Instruction> rotUP = std::make_shared<FaceInstruction>(FaceType::UP);
+	Move rotUP = getFaceMove(FaceType::UP);
 
 	// rotate the relatively left face counterclockwise
-	std::shared_ptr<Instruction> rotRelLeftCC = std::make_shared<FaceInstruction>(getRelLeftOnY(face), false);
+	Move rotRelLeftCC = getFaceMove(getRelLeftOnY(face), false);
 
 	// rotate UP counterclockwise
-	std::shared_ptr<Instruction> rotUPCC = std::make_shared<FaceInstruction>(FaceType::UP, false);
+	Move rotUPCC = getFaceMove(FaceType::UP, false);
 
 	// add instructions
 	addInstruction(rotFaceCC);
@@ -550,9 +555,9 @@ bool AI::isCornerTopLeft(FaceType face, Color color)
 		relUpSquareLeft = 0;
 		relLeftTopRight = 6;
 	}
-	return (futureCube->getFace(face)->getColorAt(topLeft) == color // top left of this face
-		|| futureCube->getFace(getRelLeftOnY(face))->getColorAt(relLeftTopRight) == color // relative left's top right
-		|| futureCube->getFace(FaceType::UP)->getColorAt(relUpSquareLeft) == color); // up
+	return (futureState.getColorAt(face, topLeft) == color // top left of this face
+		|| futureState.getColorAt(getRelLeftOnY(face), relLeftTopRight) == color // relative left's top right
+		|| futureState.getColorAt(FaceType::UP, relUpSquareLeft) == color); // up
 }
 
 bool AI::isCornerBottomLeft(FaceType face, Color color) {
@@ -574,7 +579,7 @@ bool AI::isCornerBottomLeft(FaceType face, Color color) {
 		relDownSquare = 6;
 		relLeftBottomRight = 0;
 	}
-	return (futureCube->getFace(face)->getColorAt(bottomLeft) == color // bottom left of this face
-		|| futureCube->getFace(getRelLeftOnY(face))->getColorAt(relLeftBottomRight) == color // relative left's bottom right
-		|| futureCube->getFace(FaceType::DOWN)->getColorAt(relDownSquare) == color); // down 
+	return (futureState.getColorAt(face, bottomLeft) == color // bottom left of this face
+		|| futureState.getColorAt(getRelLeftOnY(face), relLeftBottomRight) == color // relative left's bottom right
+		|| futureState.getColorAt(FaceType::DOWN, relDownSquare) == color); // down 
 }
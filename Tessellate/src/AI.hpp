@@ -1,38 +1,64 @@
 #pragma once
 
+#include <memory_resource>
 #include <vector>
-#include <memory>
 
 #include "Cube.hpp"
+#include "CubeArena.hpp"
 
 class AI {
 private:
-	/* only start() is allowed to touch the displayed cube */
-	Cube* cube;
+	/* bytes of scratch memory a plan can use before the arena falls back to the heap. Plans rarely pass a hundred moves of a byte each */
+	static const size_t SCRATCH_BYTES = 4096;
+	/* moves reserved for a plan up front */
+	static const size_t INITIAL_INSTRUCTIONS = 256;
 
-	std::vector<std::shared_ptr<Instruction>> instructions;
+	/* only start() is allowed to touch the displayed cube. Empty when planning from a snapshot */
+	CubeRef cube;
+	/* the state planning starts from */
+	Color snapshot[54];
 
-	/* when calculating future moves, rotations are made to futureCube behind the scenes instead of to the displayed cube */
-	Cube* futureCube;
+	/* everything a plan allocates comes from this arena, over a buffer inside the planner. The planner never leaves the thread
+	   that plans with it, so neither does its memory: parallel plans share no allocator. Released at the start of every plan */
+	unsigned char scratch[SCRATCH_BYTES];
+	std::pmr::monotonic_buffer_resource arena;
+
+	std::pmr::vector<Move> instructions;
+
+	/* when calculating future moves, rotations are made to futureState behind the scenes instead of to the displayed cube */
+	CubeState futureState;
 	
 public:
-	AI(Cube* cube);
-	~AI();
+	/* moves set aside per tile for a plan before it spills over to the heap. Plans from a fresh cube rarely pass 64 */
+	static const size_t PLAN_SLOT = 64;
+
+	AI(CubeRef cube);
+
+	/* plans from a snapshot of a cube's 54 stickers (see Cube::getColors) without reading the cube itself,
+	   so it can run on any thread while the cube keeps animating. Use getInstructions instead of start */
+	AI(const Color colors[54]);
+
+	AI(const AI&) = delete;
+	AI& operator=(const AI&) = delete;
 
 	/* generates the instructions to rotate the cube in order to achieve the supplied pattern on the UP face */
 	void calculatePaint(Color pattern[9]);
 
 	/* adds instruction set to the cube's queue */
 	void start();
-private:
-	/* adds instructions to AI's queue and adjusts data cube */
-	void addInstruction(std::shared_ptr<Instruction>& instruction);
+
+	/* the planned instructions, to be queued on the cube later. Valid until the next calculatePaint */
+	const std::pmr::vector<Move>& getInstructions() const;
 
 	/**
 	* simplifies the instruction set. Ex. F, F' cancel out. F, F, F turns into F'
 	* Postcondition: state of cube does not change before and after instruction simplification
 	*/
-	void simplifyInstructions(std::vector<std::shared_ptr<Instruction>>& instructions);
+	static void simplifyInstructions(std::pmr::vector<Move>& instructions);
+private:
+	/* adds instructions to AI's queue and adjusts data cube */
+	void addInstruction(Move instruction);
+
 
 	void printInstructions();
 
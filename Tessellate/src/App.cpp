@@ -8,6 +8,8 @@
 #include <functional> // for std::ref
 #include <time.h> // for seeding rng
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
 // include GLEW
 #define GLEW_STATIC
@@ -22,14 +24,17 @@
 
 #include "App.hpp"
 #include "Shader.hpp"
-#include "BMPImage.hpp"
 #include "AI.hpp"
+#include "CommandReader.hpp"
 
-App::App()
- : running(true), camera(glm::vec3(0, 23, 5), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0)), fps(0) { // 0, 110, 5
+App::App(float targetFps)
+ : running(true), camera(glm::vec3(0, 23, 5), glm::vec3(0, 0, 0), glm::vec3(0, 1, 0)), fps(0), showHUD(false), hudRefreshTimer(0), governor(targetFps),
+   imagePath("../dependencies/images/output marilyn.bmp"), imageRows(0), imageCols(0), cubeBudget(17 * 17), fitMode(FitMode::CROP), ditherMode(DitherMode::ERROR_DIFFUSION),
+   video(nullptr), videoFromStdin(false), solve(nullptr), player(nullptr), recorder(nullptr), snapshotPath("tessellate.tsnp") { // 0, 110, 5
 
     // Create grid
     grid = new Grid(1, 1);
+    grid->cubes.addObserver(&timeline);
 
     // seed RNG
     srand(static_cast<unsigned int>(time(0)));
@@ -39,7 +44,7 @@ App::App()
         throw std::runtime_error("Failed to initialize GLFW\n");
     }
 
-    glfwWindowHint(GLFW_SAMPLES, 4); // 4x antialiasing
+    glfwWindowHint(GLFW_SAMPLES, 0); // antialiasing is done offscreen by the RenderTarget
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3); // version 3.x
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3); // version 3.3
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // To make MacOS happy; should not be needed
@@ -94,17 +99,37 @@ App::App()
     // same as above for color data
     glGenBuffers(1, &colorbuffer);
 
-    // initialize buffer data arrays to null (they will be filled in by the cube every frame)
-    for (int i = 0; i < 972; i++) {
-        g_vertex_buffer_data[i] = 0;
-        g_color_buffer_data[i] = 0;
-    }
+    // frame profiler and HUD
+    profiler = new Profiler();
+    overlay = new TextOverlay();
+
+    // offscreen framebuffer for resolution scaling and MSAA
+    renderTarget = new RenderTarget();
 }
 
 App::~App() {
+    // the show is written once it is over
+    if (recorder) {
+        try {
+            recorder->save(recordPath.c_str());
+            std::cout << "Recorded " << recorder->getMoveCount() << " moves to " << recordPath << std::endl;
+        } catch (const std::runtime_error& e) {
+            std::cout << e.what() << std::endl;
+        }
+        delete recorder;
+    }
+
     // delete grid
     delete grid;
 
+    // delete profiler and HUD before the context goes away
+    delete profiler;
+    delete overlay;
+    delete renderTarget;
+    delete video;
+    delete solve;
+    delete player;
+
     // Cleanup VBO and shader
     glDeleteBuffers(1, &vertexbuffer);
     glDeleteBuffers(1, &colorbuffer);
@@ -116,7 +141,9 @@ App::~App() {
 }
 
 void App::start() {
-    std::thread CLIinput(&App::beginInputHandler, this);
+    // the command line cannot share stdin with a video streamed through it
+    if (!videoFromStdin)
+        addCommandChannel(CommandReader::fromStdin()); // to-do: replace CLI input with GUI text box.
     loop();
 }
 
@@ -128,6 +155,136 @@ bool App::isRunning() {
     return running && !glfwWindowShouldClose(window);
 }
 
+void App::setImagePath(const std::string& path) {
+    imagePath = path;
+}
+
+void App::setImageSize(size_t rows, size_t cols) {
+    imageRows = rows;
+    imageCols = cols;
+}
+
+void App::setCubeBudget(size_t maxCubes) {
+    cubeBudget = maxCubes;
+    imageRows = 0;
+    imageCols = 0;
+}
+
+void App::setFitMode(FitMode mode) {
+    fitMode = mode;
+}
+
+void App::setDitherMode(DitherMode mode) {
+    ditherMode = mode;
+}
+
+void App::startVideo(const std::string& path, size_t rawWidth, size_t rawHeight) {
+    FrameSource* source = new FrameSource(path.c_str(), rawWidth, rawHeight);
+    GridFit fit = imageRows > 0 && imageCols > 0 ?
+        GridFit::forSize(source->getWidth(), source->getHeight(), imageRows, imageCols, fitMode) :
+        GridFit::forBudget(source->getWidth(), source->getHeight(), cubeBudget, fitMode);
+
+    delete solve;
+    solve = nullptr;
+    delete player;
+    player = nullptr;
+    delete video;
+    video = new VideoMosaic(source, fit, quantizer, ditherMode);
+    video->start(*grid);
+    videoFromStdin = path == "-";
+    viewWholeGrid();
+    std::cout << "Streaming " << source->getWidth() << "x" << source->getHeight() << " video to " << fit.rows << "x" << fit.cols << " cubes" << std::endl;
+}
+
+void App::addCommandChannel(std::shared_ptr<CommandRing> channel) {
+    commandChannels.push_back(channel);
+}
+
+void App::setStickerColors(const std::string& path) {
+    quantizer = ColorQuantizer::fromFile(path.c_str());
+}
+
+void App::setWorkers(size_t nWorkers, const std::vector<std::string>& command) {
+    coordinator = std::make_shared<ShardCoordinator>(nWorkers, command);
+}
+
+void App::setCache(const std::string& directory, uintmax_t maxBytes) {
+    cache = std::make_shared<SolutionCache>(directory, maxBytes);
+}
+
+void App::startRecording(const std::string& path) {
+    if (!recorder)
+        recorder = new ChoreographyRecorder();
+    recordPath = path;
+    recorder->start(grid->nRows, grid->nCols, grid->cubes);
+    grid->cubes.addObserver(recorder);
+}
+
+void App::playChoreography(const std::string& path) {
+    ChoreographyPlayer* show = new ChoreographyPlayer(path.c_str());
+
+    // a show replaces whatever drove the grid before it
+    delete video;
+    video = nullptr;
+    delete solve;
+    solve = nullptr;
+    delete player;
+    player = show;
+    player->start(*grid);
+    viewWholeGrid();
+    std::cout << "Playing " << path << " on " << player->getRows() << "x" << player->getCols() << " cubes" << std::endl;
+}
+
+void App::setSnapshotPath(const std::string& path) {
+    snapshotPath = path;
+}
+
+void App::saveSnapshot() {
+    try {
+        auto start = std::chrono::steady_clock::now();
+        CameraState state = camera.getState();
+        GridSnapshot::save(snapshotPath.c_str(), *grid, &state, player);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Saved " << grid->nRows << "x" << grid->nCols << " cubes to " << snapshotPath << " in " << elapsed.count() << " ms" << std::endl;
+    } catch (const std::runtime_error& e) {
+        std::cout << "Could not save snapshot: " << e.what() << std::endl;
+    }
+}
+
+void App::loadSnapshot() {
+    try {
+        auto start = std::chrono::steady_clock::now();
+        CameraState state;
+        ShowPosition position;
+        uint32_t saved = GridSnapshot::load(snapshotPath.c_str(), *grid, state, position);
+
+        // the snapshot replaces whatever drove the grid before it, except the show it was taken of
+        delete video;
+        video = nullptr;
+        delete solve;
+        solve = nullptr;
+        delete player;
+        player = nullptr;
+        if (saved & GridSnapshot::HAS_SHOW) {
+            try {
+                std::unique_ptr<ChoreographyPlayer> show(new ChoreographyPlayer(position.path.c_str()));
+                show->resume(*grid, position);
+                player = show.release();
+            } catch (const std::runtime_error& e) {
+                std::cout << "Could not resume show: " << e.what() << std::endl;
+            }
+        }
+        viewWholeGrid();
+        if (saved & GridSnapshot::HAS_CAMERA)
+            camera.setState(state);
+
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Restored " << grid->nRows << "x" << grid->nCols << " cubes from " << snapshotPath << " in " << elapsed.count() << " ms" << std::endl;
+    } catch (const std::runtime_error& e) {
+        std::cout << "Could not load snapshot: " << e.what() << std::endl;
+    }
+}
+
 void App::loop() {
 
     // set up delta time variables
@@ -139,134 +296,261 @@ void App::loop() {
     // to-do: render on a separate thread than calculations
     while (isRunning()) {
 
-        // Clear the screen
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // Use our shader
-        glUseProgram(programID);
-
         // get delta time and fps
         lastTime = currentTime;
         currentTime = glfwGetTime();
-        deltaTime = float(currentTime - lastTime); // to-do: fix bug that distorts vertices when deltaTime is very large
+        deltaTime = float(currentTime - lastTime);
         // deltaTime = 0.1;
         fps = 1 / deltaTime;
 
+        profiler->beginFrame(deltaTime);
+
+        // render into the offscreen target at the resolution and sample count the governor chose
+        QualitySettings quality = governor.getSettings();
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        renderTarget->bind(width, height, quality.resolutionScale, quality.msaaSamples);
+
+        // Clear the screen
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // Use our shader
+        glUseProgram(programID);
+        glBindVertexArray(VertexArrayID);
+
         // main update function
+        profiler->begin(ProfileStage::UPDATE);
         update(deltaTime);
-
-        for (int i = 0; i < grid->cubes.size(); i++) { // for each cube
-
-            glm::mat4 MVP = Projection * camera.view * grid->cubes[i]->model; // Remember, matrix multiplication is the other way around
-            // Send our transformation to the currently bound shader, 
-            // in the "MVP" uniform
-            glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
-
-            // update vertex buffer data
-            grid->cubes[i]->getVertexData(g_vertex_buffer_data);
-            // 1st attribute buffer : vertices
-            glEnableVertexAttribArray(0);
-            glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer); // bind buffer to be modified next
-            glBufferData(GL_ARRAY_BUFFER, sizeof(g_vertex_buffer_data), g_vertex_buffer_data, GL_DYNAMIC_DRAW); // modify data
-            glVertexAttribPointer(
-                0,                  // attribute. No particular reason for 0, but must match the layout in the shader.
-                3,                  // size
-                GL_FLOAT,           // type
-                GL_FALSE,           // normalized?
-                0,                  // stride
-                (void*)0            // array buffer offset
-            );
-
-            // update color vertex buffer data
-            grid->cubes[i]->getColorData(g_color_buffer_data);
-            // 2nd attribute buffer : colors
-            glEnableVertexAttribArray(1);
-            glBindBuffer(GL_ARRAY_BUFFER, colorbuffer);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(g_color_buffer_data), g_color_buffer_data, GL_DYNAMIC_DRAW);
-            glVertexAttribPointer(
-                1,                                // attribute. No particular reason for 1, but must match the layout in the shader.
-                3,                                // size
-                GL_FLOAT,                         // type
-                GL_FALSE,                         // normalized?
-                0,                                // stride
-                (void*)0                          // array buffer offset
-            );
-
-            // draw
-            glDrawArrays(GL_TRIANGLES, 0, 3 * 2 * 9 * 6); // 3 * 2 * 9 * 6 total vertices
-            
-            // disable vertices and colors
-            glDisableVertexAttribArray(0);
-            glDisableVertexAttribArray(1);
+        profiler->end(ProfileStage::UPDATE);
+
+        // Send our transformation to the currently bound shader, in the "MVP" uniform.
+        // Vertices are packed in world space, so one matrix serves every cube
+        glm::mat4 MVP = Projection * camera.view; // Remember, matrix multiplication is the other way around
+        glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &MVP[0][0]);
+
+        // pack every cube into the grid-wide arrays in parallel
+        profiler->begin(ProfileStage::PACK);
+        size_t nFloats = grid->cubes.size() * VertexPacker::FLOATS_PER_CUBE;
+        if (g_vertex_buffer_data.size() != nFloats) { // the grid was resized
+            g_vertex_buffer_data.resize(nFloats);
+            g_color_buffer_data.resize(nFloats);
+        }
+        packer.pack(grid->cubes, g_vertex_buffer_data.data(), g_color_buffer_data.data());
+        profiler->end(ProfileStage::PACK);
+
+        profiler->beginGPU();
+
+        profiler->begin(ProfileStage::UPLOAD);
+        // 1st attribute buffer : vertices
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer); // bind buffer to be modified next
+        glBufferData(GL_ARRAY_BUFFER, nFloats * sizeof(GLfloat), NULL, GL_DYNAMIC_DRAW); // orphan last frame's storage so the upload does not wait for the GPU
+        glBufferSubData(GL_ARRAY_BUFFER, 0, nFloats * sizeof(GLfloat), g_vertex_buffer_data.data()); // modify data
+        glVertexAttribPointer(
+            0,                  // attribute. No particular reason for 0, but must match the layout in the shader.
+            3,                  // size
+            GL_FLOAT,           // type
+            GL_FALSE,           // normalized?
+            0,                  // stride
+            (void*)0            // array buffer offset
+        );
+
+        // 2nd attribute buffer : colors
+        glEnableVertexAttribArray(1);
+        glBindBuffer(GL_ARRAY_BUFFER, colorbuffer);
+        glBufferData(GL_ARRAY_BUFFER, nFloats * sizeof(GLfloat), NULL, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, nFloats * sizeof(GLfloat), g_color_buffer_data.data());
+        glVertexAttribPointer(
+            1,                                // attribute. No particular reason for 1, but must match the layout in the shader.
+            3,                                // size
+            GL_FLOAT,                         // type
+            GL_FALSE,                         // normalized?
+            0,                                // stride
+            (void*)0                          // array buffer offset
+        );
+        profiler->end(ProfileStage::UPLOAD);
+
+        // draw every cube with one call
+        profiler->begin(ProfileStage::DRAW);
+        drawFirsts.clear();
+        drawCounts.clear();
+        for (size_t i = 0; i < grid->cubes.size(); i++) // for each cube
+            addDrawRanges(i, quality.lod);
+        glMultiDrawArrays(GL_TRIANGLES, drawFirsts.data(), drawCounts.data(), static_cast<GLsizei>(drawFirsts.size()));
+
+        // disable vertices and colors
+        glDisableVertexAttribArray(0);
+        glDisableVertexAttribArray(1);
+        profiler->end(ProfileStage::DRAW);
+
+        // upsample to the window
+        profiler->begin(ProfileStage::DRAW);
+        renderTarget->resolve(width, height);
+        profiler->end(ProfileStage::DRAW);
+
+        // draw HUD
+        if (showHUD) {
+            profiler->begin(ProfileStage::DRAW);
+            // percentiles are only recomputed a few times per second
+            hudRefreshTimer -= deltaTime;
+            if (hudRefreshTimer <= 0) {
+                hudLines = profiler->getSummary();
+                hudLines.push_back(governor.describe());
+                hudLines.push_back(JobSystem::shared().describe());
+                if (video)
+                    hudLines.push_back(video->describe());
+                if (solve)
+                    hudLines.push_back(solve->describe());
+                if (player)
+                    hudLines.push_back(player->describe());
+                hudLines.push_back(timeline.describe(grid->cubes));
+                if (coordinator)
+                    hudLines.push_back(coordinator->describe());
+                if (cache)
+                    hudLines.push_back(cache->describe());
+                hudRefreshTimer = 0.25f;
+            }
+            overlay->addLines(hudLines, 10, 10);
+            overlay->draw(width, height);
+            profiler->end(ProfileStage::DRAW);
         }
+        profiler->endGPU();
 
         /* Swap front and back buffers */
+        profiler->begin(ProfileStage::SWAP);
         glfwSwapBuffers(window);
+        profiler->end(ProfileStage::SWAP);
 
         /* Poll for and process events */
+        profiler->begin(ProfileStage::INPUT);
         glfwPollEvents();
+        profiler->end(ProfileStage::INPUT);
+
+        profiler->endFrame();
+
+        // adjust quality for the next frame
+        governor.update(profiler->getFrameCost(), deltaTime);
 
         // sleep for the remainder of the frame 
         //std::this_thread::sleep_for(std::chrono::seconds(long long(1/60.0 - deltaTime)));
-        while (glfwGetTime() - lastTime < 1 / 60.0) {};
+        while (glfwGetTime() - lastTime < 1 / governor.getTargetFps()) {};
     }
 }
 
 void App::update(float deltatime) {
-    grid->update(deltatime);
+    drainCommands();
+    if (video)
+        video->update(*grid);
+    if (solve) {
+        if (solve->update(*grid))
+            viewWholeGrid();
+        if (solve->isFinished()) {
+            delete solve;
+            solve = nullptr;
+        }
+    }
+    if (player) {
+        player->update(grid->cubes);
+        if (player->isFinished()) {
+            delete player;
+            player = nullptr;
+        }
+    }
+    timeline.update(*grid, deltatime);
     camera.update(deltatime);
 }
 
-void App::beginInputHandler() {
-    using namespace std;
-    while (true) {
-        cout << endl << "Enter valid commands (ex. F', B, L, R', U, D):" << endl;
-
-        string commands;
-        cin >> commands;
-
-        bool clockwise, invalid;
-        FaceType face{};
-        // parse input
-        while (commands.length() > 0) {
-            invalid = false;
-            clockwise = !(commands.length() > 1 && commands.at(1) == '\'');
-            switch (toupper(commands.at(0))) {
-            case 'F':
-                face = FaceType::FRONT;
-                break;
-            case 'B':
-                face = FaceType::BACK;
-                break;
-            case 'U':
-                face = FaceType::UP;
-                break;
-            case 'D':
-                face = FaceType::DOWN;
-                break;
-            case 'R':
-                face = FaceType::RIGHT;
-                break;
-            case 'L':
-                face = FaceType::LEFT;
-                break;
-            default:
-                cout << "Invalid command. Skipping." << endl;
-                invalid = true;
-            }
-            // remove chars
-            commands.erase(commands.begin()); // remove first char
-            if (!clockwise) // if there is a ', remove another char
-                commands.erase(commands.begin());
-            if (!invalid) {
-                std::shared_ptr<Instruction> instruction = std::make_shared<FaceInstruction>(face, clockwise);
-                grid->getSelected()->addToQueue(instruction);
-            }
+void App::loadImage() {
+    // an image replaces whatever drove the grid before it. The old solve's pending tiles are dropped
+    delete video;
+    video = nullptr;
+    delete player;
+    player = nullptr;
+    delete solve;
+    solve = new MosaicSolve(imagePath, imageRows, imageCols, cubeBudget, fitMode, quantizer, ditherMode, coordinator, cache);
+}
+
+void App::viewWholeGrid() {
+    // set default camera position to an aerial view 
+    // determine the y value of camera based off of how max rows/columns there are - lower dimension = zoomed out by a higher factor
+    size_t maxDimension = std::max(grid->nCols, grid->nRows);
+    float y = (maxDimension == 1 ? maxDimension * 23 : maxDimension < 4 ? maxDimension * 11 : maxDimension * 7);
+    camera.setDefaultEyePosition(glm::vec3(0, y, 5));
+}
+
+void App::addDrawRanges(size_t index, bool lod) {
+    static const GLsizei VERTICES_PER_FACE = 3 * 2 * 9;
+    GLint first = static_cast<GLint>(index * VertexPacker::VERTICES_PER_CUBE);
+
+    if (!lod || grid->cubes[index].getQueueSize() > 0) { // turning layers can expose any face
+        drawFirsts.push_back(first);
+        drawCounts.push_back(VERTICES_PER_FACE * 6); // 3 * 2 * 9 * 6 total vertices
+        return;
+    }
+
+    // a face is visible when the camera is in front of its plane, 1.5 units from the center along its normal
+    static const glm::vec3 NORMALS[6] = { // Front, Up, Back, Down, Left, Right
+        glm::vec3(0, 0, 1), glm::vec3(0, 1, 0), glm::vec3(0, 0, -1),
+        glm::vec3(0, -1, 0), glm::vec3(-1, 0, 0), glm::vec3(1, 0, 0) };
+    glm::vec3 toEye = camera.getEyePosition() - grid->cubes.positions[index];
+    for (int f = 0; f < 6; f++) {
+        if (glm::dot(NORMALS[f], toEye) > 1.5f) {
+            drawFirsts.push_back(first + f * VERTICES_PER_FACE);
+            drawCounts.push_back(VERTICES_PER_FACE);
         }
-        cout << "Added instruction set to queue." << endl;
     }
 }
 
+void App::drainCommands() {
+    Command command;
+    for (std::shared_ptr<CommandRing>& channel : commandChannels)
+        while (channel->pop(command))
+            execute(command);
+}
+
+void App::execute(const Command& command) {
+    switch (command.type) {
+    case Command::Type::TURN: {
+        grid->getSelected().addToQueue(getFaceMove(command.face, command.clockwise));
+        break;
+    }
+    case Command::Type::SELECT:
+        if (command.row < grid->nRows && command.col < grid->nCols) {
+            for (size_t i = 0; i < grid->cubes.size(); i++)
+                grid->cubes[i].deselect();
+            grid->selectAbsolute(command.row, command.col);
+            if (camera.isInFocusMode()) // focus on cube if camera in focus mode
+                camera.focusOn(grid->getSelected());
+        }
+        break;
+    case Command::Type::SCRAMBLE:
+        grid->getSelected().scramble();
+        break;
+    case Command::Type::RESET:
+        grid->reset();
+        break;
+    case Command::Type::LOAD_IMAGE:
+        loadImage();
+        break;
+    case Command::Type::SEEK:
+        seek(command.seconds);
+        break;
+    case Command::Type::WAIT: // handled by the producer
+        break;
+    }
+}
+
+void App::seek(double seconds) {
+    std::function<void()> refill = [this] {
+        if (player)
+            player->update(grid->cubes);
+    };
+    if (std::isinf(seconds))
+        timeline.seekToEnd(*grid, refill);
+    else
+        timeline.seek(*grid, seconds, refill);
+}
+
 void App::key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
 
     // Query for window user pointer (the app instance)
@@ -280,25 +564,25 @@ void App::key_callback(GLFWwindow* window, int key, int scancode, int action, in
     } else if (mods != GLFW_MOD_SHIFT && key == GLFW_KEY_UP && action == GLFW_PRESS) { // select cube above selection
         app->grid->selectRelative(0, -1);
         if (app->camera.isInFocusMode()) // focus on cube if camera in focus mode
-            app->camera.focusOn(app->grid->getSelected().get());
+            app->camera.focusOn(app->grid->getSelected());
     } else if (mods != GLFW_MOD_SHIFT && key == GLFW_KEY_DOWN && action == GLFW_PRESS) { // select cube below selection
         app->grid->selectRelative(0, 1);
         if (app->camera.isInFocusMode()) // focus on cube if camera in focus mode
-            app->camera.focusOn(app->grid->getSelected().get());
+            app->camera.focusOn(app->grid->getSelected());
     } else if (mods != GLFW_MOD_SHIFT && key == GLFW_KEY_LEFT && action == GLFW_PRESS) { // select cube left of selection
         app->grid->selectRelative(-1, 0);
         if (app->camera.isInFocusMode()) // focus on cube if camera in focus mode
-            app->camera.focusOn(app->grid->getSelected().get());
+            app->camera.focusOn(app->grid->getSelected());
     } else if (mods != GLFW_MOD_SHIFT && key == GLFW_KEY_RIGHT && action == GLFW_PRESS) { // select cube right of selection
         app->grid->selectRelative(1, 0);
         if (app->camera.isInFocusMode()) // focus on cube if camera in focus mode
-            app->camera.focusOn(app->grid->getSelected().get());
+            app->camera.focusOn(app->grid->getSelected());
 
     
     /* CAMERA CONTROLS */
     } else if (mods == GLFW_MOD_SHIFT && key == GLFW_KEY_R && action == GLFW_PRESS) { // deselect all cubes and reset camera
-        for (std::shared_ptr<Cube> c : app->grid->cubes) // deselect all cubes
-            c->deselect();
+        for (size_t i = 0; i < app->grid->cubes.size(); i++) // deselect all cubes
+            app->grid->cubes[i].deselect();
         app->camera.toggleFocusMode(false); // turn off focus mode
         app->camera.reset(); // reset camera
     } else if (mods == GLFW_MOD_SHIFT && key == GLFW_KEY_F && action == GLFW_PRESS) { // toggle focus mode
@@ -309,7 +593,7 @@ void App::key_callback(GLFWwindow* window, int key, int scancode, int action, in
         if (inFocus)
             app->camera.reset();
         else
-            app->camera.focusOn(app->grid->getSelected().get());
+            app->camera.focusOn(app->grid->getSelected());
     } else if (mods == GLFW_MOD_SHIFT && key == GLFW_KEY_RIGHT && action == GLFW_PRESS) { // orbit camera right
         app->camera.vyaw = 1.5f;
     } else if (mods == GLFW_MOD_SHIFT && key == GLFW_KEY_LEFT && action == GLFW_PRESS) { // orbit camera left
@@ -324,49 +608,77 @@ void App::key_callback(GLFWwindow* window, int key, int scancode, int action, in
         app->camera.vpitch = 0;
     
     
+    /* TIMELINE */
+    } else if (key == GLFW_KEY_SPACE && action == GLFW_PRESS) { // play or pause every cube
+        if (app->timeline.isPlaying())
+            app->timeline.pause();
+        else
+            app->timeline.play();
+    } else if (key == GLFW_KEY_END && action == GLFW_PRESS) { // jump to the end of the queued moves
+        app->seek(std::numeric_limits<double>::infinity());
+    } else if (key == GLFW_KEY_LEFT_BRACKET && (action == GLFW_PRESS || action == GLFW_REPEAT)) { // scrub back
+        app->seek(app->timeline.getTime() - 2.0);
+    } else if (key == GLFW_KEY_RIGHT_BRACKET && (action == GLFW_PRESS || action == GLFW_REPEAT)) { // scrub forward
+        app->seek(app->timeline.getTime() + 2.0);
+
+
     } else if (key == GLFW_KEY_M && action == GLFW_PRESS) { // increase solve speed
-        app->grid->getSelected()->solveSpeed += 0.5f;
+        CubeRef cube = app->grid->getSelected();
+        cube.setSolveSpeed(cube.getSolveSpeed() + 0.5f);
     } else if (key == GLFW_KEY_N && action == GLFW_PRESS) { // decrease solve speed
-        app->grid->getSelected()->solveSpeed -= 0.5f;
+        CubeRef cube = app->grid->getSelected();
+        cube.setSolveSpeed(cube.getSolveSpeed() - 0.5f);
     
     
-    } else if (key == GLFW_KEY_F && action == GLFW_PRESS) { // print fps
+    } else if (key == GLFW_KEY_F && action == GLFW_PRESS) { // toggle profiler HUD and print fps
+        app->showHUD = !app->showHUD;
+        app->hudRefreshTimer = 0;
         std::cout << app->fps << std::endl;
+    } else if (key == GLFW_KEY_G && action == GLFW_PRESS) { // toggle adaptive quality
+        app->governor.setEnabled(!app->governor.isEnabled());
+        std::cout << "Adaptive quality " << (app->governor.isEnabled() ? "on" : "off") << std::endl;
+    } else if (key == GLFW_KEY_EQUAL && action == GLFW_PRESS) { // raise target fps
+        app->governor.setTargetFps(app->governor.getTargetFps() + 10);
+    } else if (key == GLFW_KEY_MINUS && action == GLFW_PRESS) { // lower target fps
+        app->governor.setTargetFps(app->governor.getTargetFps() - 10);
+    } else if (key == GLFW_KEY_C && action == GLFW_PRESS) { // toggle streaming frame times to CSV
+        if (app->profiler->isRecordingCSV())
+            app->profiler->stopCSV();
+        else
+            app->profiler->startCSV("profile.csv");
     } else if (key == GLFW_KEY_D && action == GLFW_PRESS) { // print cube 
-        app->grid->getSelected()->print();
+        app->grid->getSelected().print();
     } else if (key == GLFW_KEY_S && action == GLFW_PRESS) { // scramble cube
-        app->grid->getSelected()->scramble();
+        app->grid->getSelected().scramble();
     } else if (key == GLFW_KEY_R && action == GLFW_PRESS) { // reset grid
         app->grid->reset();
     
     
+    } else if (key == GLFW_KEY_F5 && action == GLFW_PRESS) { // save the grid
+        app->saveSnapshot();
+    } else if (key == GLFW_KEY_F9 && action == GLFW_PRESS) { // restore the grid saved last
+        app->loadSnapshot();
     } else if (key == GLFW_KEY_O && action == GLFW_PRESS) { // load image and paint grid
-        BMPImage bmp("../dependencies/images/output marilyn.bmp");
-        app->grid->solveImage(bmp);
-        // set default camera position to an aerial view 
-        // determine the y value of camera based off of how max rows/columns there are - lower dimension = zoomed out by a higher factor
-        size_t maxDimension = std::max(app->grid->nCols, app->grid->nRows);
-        float y = (maxDimension == 1 ? maxDimension * 23 : maxDimension < 4 ? maxDimension * 11 : maxDimension * 7);
-        app->camera.setDefaultEyePosition(glm::vec3(0, y, 5));
+        app->loadImage();
+    } else if (key == GLFW_KEY_T && action == GLFW_PRESS) { // cycle dithering mode for the next image
+        app->ditherMode = static_cast<DitherMode>((static_cast<int>(app->ditherMode) + 1) % 4);
+        std::cout << "Dithering: " << getDitherModeName(app->ditherMode) << std::endl;
     } else if (key == GLFW_KEY_P && action == GLFW_PRESS) { // paint selected cube
         Color paintPattern[9] = { 
             Color::BLUE,   Color::WHITE,   Color::GREEN,
             Color::WHITE,   Color::ORANGE,   Color::WHITE,
             Color::GREEN,   Color::WHITE,   Color::BLUE };
-        AI ai(app->grid->getSelected().get());
+        AI ai(app->grid->getSelected());
         ai.calculatePaint(paintPattern);
         ai.start();
     
     
     } else if (key == GLFW_KEY_X && action == GLFW_PRESS) { // rotate cube across x axis
-        std::shared_ptr<Instruction> instruction = std::make_shared<CubeInstruction>(glm::vec3(1, 0, 0));
-        app->grid->getSelected()->addToQueue(instruction);
+        app->grid->getSelected().addToQueue(Move::X);
     } else if (key == GLFW_KEY_Y && action == GLFW_PRESS) { // rotate cube across y axis
-        std::shared_ptr<Instruction> instruction = std::make_shared<CubeInstruction>(glm::vec3(0, 1, 0));
-        app->grid->getSelected()->addToQueue(instruction);
+        app->grid->getSelected().addToQueue(Move::Y);
     } else if (key == GLFW_KEY_Z && action == GLFW_PRESS) { // rotate cube across z axis
-        std::shared_ptr<Instruction> instruction = std::make_shared<CubeInstruction>(glm::vec3(0, 0, 1));
-        app->grid->getSelected()->addToQueue(instruction);
+        app->grid->getSelected().addToQueue(Move::Z);
     }
 }
 
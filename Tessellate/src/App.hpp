@@ -1,8 +1,23 @@
 #include <thread>
 
-#include "Cube.hpp"
+#include "CubeArena.hpp"
 #include "Grid.hpp"
 #include "Camera.hpp"
+#include "Profiler.hpp"
+#include "TextOverlay.hpp"
+#include "QualityGovernor.hpp"
+#include "RenderTarget.hpp"
+#include "VertexPacker.hpp"
+#include "ColorQuantizer.hpp"
+#include "ThresholdDitherer.hpp"
+#include "GridFit.hpp"
+#include "VideoMosaic.hpp"
+#include "MosaicSolve.hpp"
+#include "ChoreographyPlayer.hpp"
+#include "ChoreographyRecorder.hpp"
+#include "Timeline.hpp"
+#include "GridSnapshot.hpp"
+#include "CommandRing.hpp"
 
 class App {
 private:
@@ -16,16 +31,59 @@ private:
 	GLuint MatrixID;
 	glm::mat4 Projection;
 	Camera camera;
-	/* vertices */
-	GLfloat g_vertex_buffer_data[3 * 3 * 2 * 9 * 6]; // 3 components that make up one vertex * 3 vertices that make up one triangle * 2 triangles that make up one square * 9 squares * 6 faces
+	/* world-space vertices of the whole grid, VertexPacker::FLOATS_PER_CUBE per cube */
+	std::vector<GLfloat> g_vertex_buffer_data;
 	/* colors */
-	GLfloat g_color_buffer_data[3 * 3 * 2 * 9 * 6];
+	std::vector<GLfloat> g_color_buffer_data;
 	/* buffer names */
 	GLuint vertexbuffer;
 	GLuint colorbuffer;
+	/* ranges of the buffers drawn this frame by glMultiDrawArrays */
+	std::vector<GLint> drawFirsts;
+	std::vector<GLsizei> drawCounts;
+	VertexPacker packer;
 	float fps;
+	/* frame timing and the on-screen HUD that displays it */
+	Profiler* profiler;
+	TextOverlay* overlay;
+	bool showHUD;
+	std::vector<std::string> hudLines;
+	float hudRefreshTimer; // seconds until the HUD text is recomputed
+	/* adaptive render quality */
+	QualityGovernor governor;
+	RenderTarget* renderTarget;
+	/* image painted by the O key and how it is fitted to the grid:
+	   exactly imageRows x imageCols cubes if they are set, otherwise the largest grid of at most cubeBudget cubes */
+	std::string imagePath;
+	size_t imageRows, imageCols;
+	size_t cubeBudget;
+	FitMode fitMode;
+	/* maps image colors to stickers */
+	ColorQuantizer quantizer;
+	DitherMode ditherMode;
+	/* live video driving the grid, or nullptr */
+	VideoMosaic* video;
+	bool videoFromStdin;
+	/* image being solved in the background, or nullptr */
+	MosaicSolve* solve;
+	/* worker processes that plan the tiles of images, or nullptr to plan them in this process */
+	std::shared_ptr<ShardCoordinator> coordinator;
+	/* plans of images solved before, or nullptr to plan every image from scratch */
+	std::shared_ptr<SolutionCache> cache;
+	/* recorded show being played back, or nullptr */
+	ChoreographyPlayer* player;
+	/* records every move of the grid to recordPath, or nullptr */
+	ChoreographyRecorder* recorder;
+	std::string recordPath;
+	/* where F5 saves the grid and F9 restores it from */
+	std::string snapshotPath;
+	/* the grid's clock: play, pause and seek */
+	Timeline timeline;
+	/* one ring per producer of commands (stdin, scripts, sockets), drained once per frame */
+	std::vector<std::shared_ptr<CommandRing>> commandChannels;
 public:
-	App();
+	/* targetFps is the frame rate the quality governor tries to hold */
+	App(float targetFps = 60.0f);
 
 	~App();
 	
@@ -35,6 +93,52 @@ public:
 
 	bool isRunning();
 
+	/* sets the image the O key paints */
+	void setImagePath(const std::string& path);
+
+	/* sets how many rows and columns of cubes the image is scaled to */
+	void setImageSize(size_t rows, size_t cols);
+
+	/* fits images to the largest grid of at most maxCubes cubes that keeps their aspect ratio, instead of a fixed size */
+	void setCubeBudget(size_t maxCubes);
+
+	void setFitMode(FitMode mode);
+
+	void setDitherMode(DitherMode mode);
+
+	/* drives the grid from a video stream (see FrameSource). path "-" reads stdin.
+	   The stream is YUV4MPEG2 unless rawWidth and rawHeight are given for raw rgb24 frames */
+	void startVideo(const std::string& path, size_t rawWidth = 0, size_t rawHeight = 0);
+
+	/* executes the commands pushed into channel, once per frame on the simulation thread (see CommandReader) */
+	void addCommandChannel(std::shared_ptr<CommandRing> channel);
+
+	/* matches images against sticker colors measured from a real cube, read from a file (see ColorQuantizer::fromFile) */
+	void setStickerColors(const std::string& path);
+
+	/* plans the tiles of images in nWorkers processes started with command (see ShardCoordinator).
+	   throws std::runtime_error if they cannot be started */
+	void setWorkers(size_t nWorkers, const std::vector<std::string>& command);
+
+	/* keeps the plans of solved images in directory, at most maxBytes of them, so loading an image again skips the planner (see SolutionCache).
+	   throws std::runtime_error if the directory cannot be created */
+	void setCache(const std::string& directory, uintmax_t maxBytes);
+
+	/* records every move the grid makes from now on, and writes the show to path when the app closes (see Choreography) */
+	void startRecording(const std::string& path);
+
+	/* plays the show recorded in path on the grid instead of solving. throws std::runtime_error if it cannot be read */
+	void playChoreography(const std::string& path);
+
+	/* sets the file F5 saves the grid to and F9 restores it from (see GridSnapshot) */
+	void setSnapshotPath(const std::string& path);
+
+	/* saves the grid, the camera and the position of the show being played to the snapshot file */
+	void saveSnapshot();
+
+	/* replaces the grid and the camera with the snapshot file's, and carries on the show it was playing */
+	void loadSnapshot();
+
 private:
 	/* main update/draw loop */
 	void loop();
@@ -42,8 +146,24 @@ private:
 	/* update all relevant objects */
 	void update(float deltatime);
 
-	/* listen for CLI input */
-	void beginInputHandler(); // to-do: replace CLI input with GUI text box.
+	/* starts solving the grid for the image in the background, cancelling any solve still in flight.
+	   Cubes start turning as soon as their tiles are planned */
+	void loadImage();
+
+	/* moves the default camera position high enough to see the whole grid */
+	void viewWholeGrid();
+
+	/* appends the vertex ranges to draw for the cube at index in the grid buffers.
+	   With lod, an idle cube only draws the faces that can be seen from the camera */
+	void addDrawRanges(size_t index, bool lod);
+
+	/* pops every pending command of every channel and executes it */
+	void drainCommands();
+
+	void execute(const Command& command);
+
+	/* moves the timeline to seconds, or to its end if seconds is infinite, keeping a show being played fed */
+	void seek(double seconds);
 
 	/* GUI input callback
 	   Needed to make static. Why? When it isn't static, its signature looks like:
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <cmath>
+
+#include "AreaResampler.hpp"
+#include "RGBImage.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TESSELLATE_SSE
+#include <emmintrin.h>
+#endif
+
+AreaResampler::AreaResampler(size_t srcSize, size_t dstSize)
+	: AreaResampler(srcSize, dstSize, 0, static_cast<double>(srcSize)) {}
+
+AreaResampler::AreaResampler(size_t srcSize, size_t dstSize, double srcStart, double srcSpan)
+	: srcSize(srcSize), dstSize(dstSize), first(1, 0) {
+	double scale = srcSpan / dstSize;
+	for (size_t i = 0; i < dstSize; i++) {
+		double start = srcStart + i * scale;
+		double end = srcStart + (i + 1) * scale;
+		size_t s = static_cast<size_t>(std::max(start, 0.0));
+		size_t e = std::min(srcSize, static_cast<size_t>(std::ceil(end)));
+		for (size_t j = s; j < e; j++) {
+			double covered = std::min(end, j + 1.0) - std::max(start, static_cast<double>(j));
+			if (covered > 0)
+				taps.push_back({ j, static_cast<float>(covered / scale) });
+		}
+		first.push_back(taps.size());
+	}
+}
+
+size_t AreaResampler::getSourceSize() const {
+	return srcSize;
+}
+
+size_t AreaResampler::getTargetSize() const {
+	return dstSize;
+}
+
+const AreaResampler::Tap* AreaResampler::tapsBegin(size_t i) const {
+	return taps.data() + first[i];
+}
+
+const AreaResampler::Tap* AreaResampler::tapsEnd(size_t i) const {
+	return taps.data() + first[i + 1];
+}
+
+void AreaResampler::resampleRow(const float src[], float dst[]) const {
+	static const size_t CHANNELS = RGBImage::CHANNELS;
+	for (size_t x = 0; x < dstSize; x++) {
+#ifdef TESSELLATE_SSE
+		__m128 sum = _mm_setzero_ps();
+		for (const Tap* t = tapsBegin(x); t != tapsEnd(x); t++)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src + t->index * CHANNELS), _mm_set1_ps(t->weight)));
+		_mm_storeu_ps(dst + x * CHANNELS, sum);
+#else
+		float* out = dst + x * CHANNELS;
+		std::fill(out, out + CHANNELS, 0.0f);
+		for (const Tap* t = tapsBegin(x); t != tapsEnd(x); t++)
+			for (size_t c = 0; c < CHANNELS; c++)
+				out[c] += src[t->index * CHANNELS + c] * t->weight;
+#endif
+	}
+}
+
+void AreaResampler::addScaled(const float src[], float weight, float dst[], size_t nFloats) {
+	size_t i = 0;
+#ifdef TESSELLATE_SSE
+	__m128 w = _mm_set1_ps(weight);
+	for (; i + 4 <= nFloats; i += 4)
+		_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), w)));
+#endif
+	for (; i < nFloats; i++)
+		dst[i] += src[i] * weight;
+}
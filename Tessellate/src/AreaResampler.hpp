@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+/* Resamples along one axis by area averaging: every output pixel is the coverage-weighted average of the source pixels under it.
+   Pixels are RGBImage::CHANNELS floats */
+class AreaResampler {
+public:
+	/* a source pixel contributing to an output pixel */
+	struct Tap {
+		size_t index;
+		float weight;
+	};
+private:
+	size_t srcSize, dstSize;
+	std::vector<Tap> taps;
+	std::vector<size_t> first; // taps[first[i] .. first[i + 1]) belong to output pixel i
+public:
+	AreaResampler(size_t srcSize, size_t dstSize);
+
+	/* resamples only the span [srcStart, srcStart + srcSpan) of the source, in source pixels */
+	AreaResampler(size_t srcSize, size_t dstSize, double srcStart, double srcSpan);
+
+	size_t getSourceSize() const;
+	size_t getTargetSize() const;
+
+	/* the source pixels covered by output pixel i */
+	const Tap* tapsBegin(size_t i) const;
+	const Tap* tapsEnd(size_t i) const;
+
+	/* resamples a row of srcSize pixels to dstSize pixels */
+	void resampleRow(const float src[], float dst[]) const;
+
+	/* dst += src * weight over nFloats floats. Accumulates whole rows for the vertical pass */
+	static void addScaled(const float src[], float weight, float dst[], size_t nFloats);
+};
@@ -1,65 +1,126 @@
-#include <cmath>
-#include <map>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
 #include <stdexcept>
 #include <string>
-#include <iostream>
 
 #include "BMPImage.hpp"
+#include "JobSystem.hpp"
 
+namespace {
+	/* compression methods */
+	const unsigned int BI_RGB = 0;
+	const unsigned int BI_RLE8 = 1;
+	const unsigned int BI_BITFIELDS = 3;
+	const unsigned int BI_ALPHABITFIELDS = 6;
 
-BMPImage::BMPImage(const char* const filepath) {
+	/* little-endian fields are assembled byte by byte, so they may sit at any alignment */
+	unsigned int readU16(const unsigned char* p) {
+		return p[0] | (p[1] << 8);
+	}
 
-	std::ifstream inFile;
+	unsigned int readU32(const unsigned char* p) {
+		return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<unsigned int>(p[3]) << 24);
+	}
 
-	inFile.open(filepath, std::ios::binary | std::ios::in);
+	int readS32(const unsigned char* p) {
+		return static_cast<int>(readU32(p));
+	}
 
-	// check state
-	if (!inFile) {
-		throw std::runtime_error("cannot find image file");
+	void writeU16(unsigned char* p, unsigned int v) {
+		p[0] = v & 0xFF;
+		p[1] = (v >> 8) & 0xFF;
 	}
 
-	// read file header
-	inFile.read(header, 54);
-
-	width = *(int*)&header[18];
-	height = *(int*)&header[22];
-	
-	// determine how many bytes are in a row (with padding)
-	size_t byteWidthWPadding( (width * 3 + 3) & (~3));
-	size_t nPaddingBytes = byteWidthWPadding - width * 3; // byte width w/ padding minus byte width
-
-	// allocate space for data
-	dataSize = 3 * width * height; // 3 bytes per pixel. no room for padding.
-	data = new char[dataSize];
-
-	// read file into data excluding padding bytes
-	unsigned int nPaddingBytesSeen = 0; // how many padding bytes have been thrown away so far
-	char shitByte; // used to read worthless padding bytes into
-	for (int i = 0; i < dataSize + nPaddingBytesSeen; i++) { // for each byte
-		if (i % byteWidthWPadding >= width * 3) { // if this byte is a padding byte
-			// don't store it
-			inFile.read(&shitByte, 1);
-			nPaddingBytesSeen++;
-		} else {
-			inFile.read(data + i - nPaddingBytesSeen, 1);
-		}
+	void writeU32(unsigned char* p, unsigned int v) {
+		for (int i = 0; i < 4; i++)
+			p[i] = (v >> (8 * i)) & 0xFF;
 	}
 
-	// reflect image vertically
-	char temp = 0;
-	for (int r = 0; r < height / 2; r++) { // for each row of pixels
-		for (int c = 0; c < width * 3; c++) { // for each byte
-			temp = data[(height - 1 - r) * width * 3 + c];
-			data[(height - 1 - r) * width * 3 + c] = data[r * width * 3 + c];
-			data[r * width * 3 + c] = temp;
-		}
+	/* index of the lowest set bit of a mask */
+	unsigned int lowestBit(unsigned int mask) {
+		unsigned int shift = 0;
+		while (shift < 32 && !(mask & (1u << shift)))
+			shift++;
+		return shift;
+	}
+}
+
+BMPImage::BMPImage(const char* const filepath)
+	: file(filepath), width(0), height(0), bitsPerPixel(0), palette{}, shifts{ 16, 8, 0 } {
+
+	const unsigned char* bytes = file.getData();
+	size_t size = file.getSize();
+
+	// file header (14 bytes) and the start of the info header
+	if (size < 54 || bytes[0] != 'B' || bytes[1] != 'M')
+		throw std::runtime_error(std::string(filepath) + " is not a bitmap image");
+
+	size_t pixelOffset = readU32(bytes + 10); // bfOffBits
+	size_t infoSize = readU32(bytes + 14);
+	int signedWidth = readS32(bytes + 18);
+	int signedHeight = readS32(bytes + 22); // negative for top-down images
+	bitsPerPixel = readU16(bytes + 28);
+	unsigned int compression = readU32(bytes + 30);
+	size_t nColors = readU32(bytes + 46);
+
+	if (signedWidth <= 0 || signedHeight == 0 || signedHeight == INT_MIN)
+		throw std::runtime_error(std::string(filepath) + " has invalid dimensions");
+	width = signedWidth;
+	height = std::abs(signedHeight);
+	bool topDown = signedHeight < 0;
+
+	bool supported =
+		(bitsPerPixel == 24 && compression == BI_RGB) ||
+		(bitsPerPixel == 32 && (compression == BI_RGB || compression == BI_BITFIELDS || compression == BI_ALPHABITFIELDS)) ||
+		(bitsPerPixel == 8 && (compression == BI_RGB || compression == BI_RLE8));
+	if (!supported)
+		throw std::runtime_error(std::string(filepath) + ": unsupported bitmap format (" + std::to_string(bitsPerPixel) + " bits per pixel, compression " + std::to_string(compression) + ")");
+	if (pixelOffset >= size)
+		throw std::runtime_error(std::string(filepath) + " is truncated");
+
+	if (bitsPerPixel == 8)
+		readPalette(14 + infoSize, nColors == 0 ? 256 : nColors);
+	if (compression == BI_BITFIELDS || compression == BI_ALPHABITFIELDS)
+		readMasks(14 + 40); // right after a BITMAPINFOHEADER, or inside the larger V4/V5 headers
+
+	if (compression == BI_RLE8) {
+		if (topDown)
+			throw std::runtime_error(std::string(filepath) + ": RLE8 images cannot be top-down");
+		decodeRLE8(bytes + pixelOffset, bytes + size);
+		return;
 	}
 
-	inFile.close();
+	// rows are padded to 4 bytes
+	size_t stride = (width * bitsPerPixel / 8 + 3) & ~static_cast<size_t>(3);
+	if ((size - pixelOffset) / stride < height)
+		throw std::runtime_error(std::string(filepath) + " is truncated");
+
+	rows.resize(height);
+	for (size_t r = 0; r < height; r++) // for each row of pixels
+		rows[r] = bytes + pixelOffset + (topDown ? r : height - 1 - r) * stride;
 }
 
-BMPImage::~BMPImage() {
-	delete[] data;
+template <typename Visitor>
+void BMPImage::forEachPixel(size_t row, Visitor visit) const {
+	const unsigned char* p = rows[row];
+	switch (bitsPerPixel) {
+	case 8:
+		for (size_t c = 0; c < width; c++)
+			visit(palette[p[c]][0], palette[p[c]][1], palette[p[c]][2]);
+		break;
+	case 24:
+		for (size_t c = 0; c < width; c++, p += 3) // stored as bgr
+			visit(p[2], p[1], p[0]);
+		break;
+	case 32:
+		for (size_t c = 0; c < width; c++, p += 4) {
+			unsigned int pixel = readU32(p);
+			visit((pixel >> shifts[0]) & 0xFF, (pixel >> shifts[1]) & 0xFF, (pixel >> shifts[2]) & 0xFF);
+		}
+		break;
+	}
 }
 
 size_t BMPImage::getWidth() const {
@@ -71,43 +132,141 @@ size_t BMPImage::getHeight() const
 	return height;
 }
 
-void BMPImage::getPixels(Color output[]) const {
-	for (int i = 0; i < dataSize; i += 3) { // for each pixel
-		// extract rgb values
-		unsigned char b = data[i + 0];
-		unsigned char g = data[i + 1];
-		unsigned char r = data[i + 2]; 
-		glm::vec3 pixel(r, g, b);
-		output[i / 3] = getClosestColor(pixel);
+void BMPImage::getPixels(Color output[], const ColorQuantizer& quantizer) const {
+	if (bitsPerPixel == 8) {
+		// match each palette entry once instead of every pixel
+		Color colors[256];
+		quantizer.quantizeRow(&palette[0][0], 256, colors);
+		for (size_t r = 0; r < height; r++)
+			for (size_t c = 0; c < width; c++)
+				*output++ = colors[rows[r][c]];
+		return;
 	}
+
+	// rows are quantized in bands, one job each
+	static const size_t MIN_PIXELS_PER_JOB = 1 << 15;
+	JobSystem::shared().parallelFor(height, std::max<size_t>(1, MIN_PIXELS_PER_JOB / width), [&](size_t first, size_t last) {
+		for (size_t row = first; row < last; row++) {
+			Color* out = output + row * width;
+			forEachPixel(row, [&out, &quantizer](unsigned char r, unsigned char g, unsigned char b) {
+				*out++ = quantizer.quantize(r, g, b);
+			});
+		}
+	});
 }
 
-Color getClosestColor(glm::vec3 color)
-{
-	static const glm::vec3 const RGBVALUES[6] = {
-		glm::vec3(255, 0, 0), // RED
-		glm::vec3(255, 165, 0), // ORANGE
-		glm::vec3(255, 255, 0), // YELLOW
-		glm::vec3(0, 255, 0), // GREEN
-		glm::vec3(0, 0, 255), // BLUE
-		glm::vec3(255, 255, 255) }; // WHITE
-	Color closestC = Color::RED;
-	int closestD = INT_MAX;
-
-	for (int i = 0; i < 6; i++) { // for each color
-		int distance = getEuchlidianDistance(color, RGBVALUES[i]);
-		if (distance < closestD) {
-			closestD = distance;
-			closestC = static_cast<Color>(i);
+void BMPImage::getRGB(unsigned char output[]) const {
+	for (size_t r = 0; r < height; r++)
+		getRGBRow(r, output + r * width * 3);
+}
+
+void BMPImage::getRGBRow(size_t row, unsigned char output[]) const {
+	forEachPixel(row, [&output](unsigned char r, unsigned char g, unsigned char b) {
+		output[0] = r;
+		output[1] = g;
+		output[2] = b;
+		output += 3;
+	});
+}
+
+void BMPImage::save(const char* const filepath, const unsigned char rgb[], size_t width, size_t height) {
+	size_t stride = (width * 3 + 3) & ~static_cast<size_t>(3); // rows are padded to 4 bytes
+	if (width == 0 || height == 0 || width > INT_MAX / 3 || stride * height > UINT_MAX - 54)
+		throw std::runtime_error(std::string("cannot save a ") + std::to_string(width) + "x" + std::to_string(height) + " bitmap");
+
+	// file header and a BITMAPINFOHEADER for a top-down image
+	unsigned char header[54] = { 'B', 'M' };
+	writeU32(header + 2, static_cast<unsigned int>(54 + stride * height));
+	writeU32(header + 10, 54);
+	writeU32(header + 14, 40);
+	writeU32(header + 18, static_cast<unsigned int>(width));
+	writeU32(header + 22, static_cast<unsigned int>(-static_cast<int>(height)));
+	writeU16(header + 26, 1);
+	writeU16(header + 28, 24);
+	writeU32(header + 30, BI_RGB);
+	writeU32(header + 34, static_cast<unsigned int>(stride * height));
+	writeU32(header + 38, 2835); // 72 dpi
+	writeU32(header + 42, 2835);
+
+	std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw std::runtime_error(std::string("cannot open ") + filepath + " for writing");
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	std::vector<unsigned char> row(stride, 0);
+	for (size_t r = 0; r < height; r++) {
+		const unsigned char* pixel = rgb + r * width * 3;
+		for (size_t c = 0; c < width; c++) { // stored as b, g, r
+			row[c * 3 + 0] = pixel[c * 3 + 2];
+			row[c * 3 + 1] = pixel[c * 3 + 1];
+			row[c * 3 + 2] = pixel[c * 3 + 0];
 		}
+		file.write(reinterpret_cast<const char*>(row.data()), stride);
 	}
-	return closestC;
+	if (!file)
+		throw std::runtime_error(std::string("cannot write ") + filepath);
 }
 
-int getEuchlidianDistance(glm::vec3 color1, glm::vec3 color2)
-{
-	int dr = color1.r - color2.r;
-	int dg = color1.g - color2.g;
-	int db = color1.b - color2.b;
-	return sqrt(dr * dr + dg * dg + db * db);
+void BMPImage::readPalette(size_t offset, size_t nColors) {
+	const unsigned char* bytes = file.getData();
+	if (nColors > 256 || offset + nColors * 4 > file.getSize())
+		throw std::runtime_error("bitmap palette is invalid");
+	for (size_t i = 0; i < nColors; i++) { // stored as bgr + one unused byte
+		palette[i][0] = bytes[offset + i * 4 + 2];
+		palette[i][1] = bytes[offset + i * 4 + 1];
+		palette[i][2] = bytes[offset + i * 4 + 0];
+	}
+}
+
+void BMPImage::readMasks(size_t offset) {
+	if (offset + 12 > file.getSize())
+		throw std::runtime_error("bitmap color masks are missing");
+	for (int i = 0; i < 3; i++) { // red, green, blue
+		unsigned int mask = readU32(file.getData() + offset + i * 4);
+		if (mask == 0)
+			throw std::runtime_error("bitmap color mask is empty");
+		// keep the top 8 bits of each channel
+		unsigned int shift = lowestBit(mask);
+		unsigned int bits = 0;
+		while (shift + bits < 32 && (mask & (1u << (shift + bits))))
+			bits++;
+		shifts[i] = bits > 8 ? shift + bits - 8 : shift;
+	}
+}
+
+void BMPImage::decodeRLE8(const unsigned char* begin, const unsigned char* end) {
+	expanded.assign(width * height, 0);
+	size_t x = 0, y = 0; // y counts from the bottom row, as stored
+	const unsigned char* p = begin;
+
+	while (p + 1 < end && y < height) {
+		unsigned int count = p[0];
+		unsigned int value = p[1];
+		p += 2;
+
+		if (count > 0) { // encoded run: count copies of one index
+			for (unsigned int i = 0; i < count && x < width; i++)
+				expanded[y * width + x++] = value;
+		} else if (value == 0) { // end of line
+			x = 0;
+			y++;
+		} else if (value == 1) { // end of bitmap
+			break;
+		} else if (value == 2) { // delta
+			if (p + 1 >= end)
+				break;
+			x += p[0];
+			y += p[1];
+			p += 2;
+		} else { // absolute run of value indices, padded to 2 bytes
+			if (static_cast<size_t>(end - p) < value)
+				throw std::runtime_error("RLE8 bitmap is truncated");
+			for (unsigned int i = 0; i < value && x < width; i++)
+				expanded[y * width + x++] = p[i];
+			p += (value + 1) & ~1u;
+		}
+	}
+
+	rows.resize(height);
+	for (size_t r = 0; r < height; r++)
+		rows[r] = &expanded[(height - 1 - r) * width];
 }
@@ -1,27 +1,58 @@
 #pragma once
 
-#include <fstream>
+#include <vector>
 
 #include "Square.hpp"
+#include "ImageSource.hpp"
+#include "MappedFile.hpp"
+#include "ColorQuantizer.hpp"
 
-static Color getClosestColor(glm::vec3 color);
-
-/* return the euchlidian distance between two colors */
-static int getEuchlidianDistance(glm::vec3 color1, glm::vec3 color2);
-
-class BMPImage {
+/* A bitmap image file, mapped into memory and decoded in place.
+   Supports 24 and 32-bit (including bitfields) images stored top-down or bottom-up, and 8-bit paletted images, raw or RLE8 compressed */
+class BMPImage : public ImageSource {
 private:
+	MappedFile file;
 	size_t width, height;
-	char header[54]; // file metadata 54 bytes long
-	char* data;
-	size_t dataSize;
+	unsigned int bitsPerPixel;
+	/* start of every row of pixels, top row first. Bottom-up files are addressed in reverse instead of flipped */
+	std::vector<const unsigned char*> rows;
+	/* rgb of every palette entry of an 8-bit image */
+	unsigned char palette[256][3];
+	/* 32-bit bitfields: the right shift that moves each of red, green and blue into the low byte */
+	unsigned int shifts[3];
+	/* palette indices of an RLE8 image, expanded at load time */
+	std::vector<unsigned char> expanded;
 public:
 
+	/* throws std::runtime_error if the file cannot be read or its format is unsupported */
 	BMPImage(const char* const filepath);
-	~BMPImage();
 
-	size_t getWidth() const;
-	size_t getHeight() const;
-	void getPixels(Color output[]) const;
+	size_t getWidth() const override;
+	size_t getHeight() const override;
+
+	/* writes the closest sticker color of every pixel, row-major, top row first */
+	void getPixels(Color output[], const ColorQuantizer& quantizer) const;
+
+	/* writes 3 bytes (r, g, b) per pixel, row-major, top row first */
+	void getRGB(unsigned char output[]) const;
+
+	void getRGBRow(size_t row, unsigned char output[]) const override;
+
+	/* writes width * height pixels of 3 bytes (r, g, b), row-major, top row first, as a 24-bit bitmap.
+	   throws std::runtime_error if the file cannot be written */
+	static void save(const char* const filepath, const unsigned char rgb[], size_t width, size_t height);
+
+private:
+	/* reads the palette of an 8-bit image */
+	void readPalette(size_t offset, size_t nColors);
+
+	/* computes the shifts of 32-bit bitfield masks */
+	void readMasks(size_t offset);
+
+	/* expands RLE8 data into expanded and points rows into it */
+	void decodeRLE8(const unsigned char* begin, const unsigned char* end);
 
-};
\ No newline at end of file
+	/* calls visit(r, g, b) for every pixel of a row, left to right */
+	template <typename Visitor>
+	void forEachPixel(size_t row, Visitor visit) const;
+};
@@ -36,17 +36,34 @@ void Camera::lookAt(glm::vec3 refPosition) {
 
 void Camera::setDefaultEyePosition(glm::vec3 defaultEyePosition) { this->defaultEyePosition = defaultEyePosition; }
 
+glm::vec3 Camera::getEyePosition() const { return eyePosition; }
+
 bool Camera::isInFocusMode() const { return focusMode; }
 
 void Camera::toggleFocusMode(bool state) { focusMode = state; }
 
 /* move close to a cube if in focus mode */
 
-void Camera::focusOn(Cube* cube) {
+void Camera::focusOn(CubeRef cube) {
 	if (!isInFocusMode())
 		throw std::runtime_error("Cannot focus camera if focus mode is disabled.");
-	translateTo(cube->getPosition() + glm::vec3(4, 7, 6));
-	lookAt(cube->getPosition());
+	translateTo(cube.getPosition() + glm::vec3(4, 7, 6));
+	lookAt(cube.getPosition());
+}
+
+CameraState Camera::getState() const {
+	return CameraState{ defaultEyePosition, eyePosition, refPosition, up, vyaw, vpitch, focusMode, view };
+}
+
+void Camera::setState(const CameraState& state) {
+	defaultEyePosition = state.defaultEyePosition;
+	eyePosition = state.eyePosition;
+	refPosition = state.refPosition;
+	up = state.up;
+	vyaw = state.vyaw;
+	vpitch = state.vpitch;
+	focusMode = state.focusMode;
+	view = state.view;
 }
 
 void Camera::moveAround(float dyaw, float dpitch) {
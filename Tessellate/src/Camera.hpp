@@ -3,7 +3,8 @@
 
 #include <glm/glm.hpp>
 
-#include "Cube.hpp"
+#include "CubeArena.hpp"
+#include "CameraState.hpp"
 
 class Camera {
 private:
@@ -37,6 +38,9 @@ public:
 	/* sets the default position of the camera */
 	void setDefaultEyePosition(glm::vec3 defaultEyePosition);
 
+	/* get world coordinates of the camera */
+	glm::vec3 getEyePosition() const;
+
 	/* returns if camera is in focus mode */
 	bool isInFocusMode() const;
 
@@ -44,7 +48,12 @@ public:
 	void toggleFocusMode(bool state);
 
 	/* move close to a cube if in focus mode */
-	void focusOn(Cube* cube);
+	void focusOn(CubeRef cube);
+
+	CameraState getState() const;
+
+	/* puts the camera exactly where state says, movement included */
+	void setState(const CameraState& state);
 
 private:
 	/* translate around refPosition while maintaining constant distance from it. Adjusts pan/tilt to look at refPosition, too. Aka an arcball camera. */
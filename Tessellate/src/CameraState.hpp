@@ -0,0 +1,14 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+/* everything that places a Camera, so it can be saved with a grid and put back exactly */
+struct CameraState {
+	glm::vec3 defaultEyePosition;
+	glm::vec3 eyePosition;
+	glm::vec3 refPosition;
+	glm::vec3 up;
+	float vyaw, vpitch;
+	bool focusMode;
+	glm::mat4 view;
+};
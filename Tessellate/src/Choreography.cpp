@@ -0,0 +1,40 @@
+#include "Choreography.hpp"
+
+const char* const Choreography::MAGIC = "TSCH";
+
+namespace {
+	unsigned char getNibble(const unsigned char* stream, size_t i) {
+		return i % 2 == 0 ? stream[i / 2] & 0x0F : stream[i / 2] >> 4;
+	}
+}
+
+size_t Choreography::encode(Move move, unsigned char nibbles[2]) {
+	unsigned char value = static_cast<unsigned char>(move);
+	if (value < N_FACE_MOVES) {
+		nibbles[0] = value;
+		return 1;
+	}
+	nibbles[0] = ESCAPE;
+	nibbles[1] = static_cast<unsigned char>(value - N_FACE_MOVES);
+	return 2;
+}
+
+bool Choreography::decode(const unsigned char* stream, size_t nNibbles, size_t& cursor, Move& move) {
+	if (cursor >= nNibbles)
+		return false;
+	unsigned char value = getNibble(stream, cursor);
+	if (value < N_FACE_MOVES) {
+		move = static_cast<Move>(value);
+		cursor++;
+		return true;
+	}
+	// 12 to 14 are unused; an escape needs the nibble after it
+	if (value != ESCAPE || cursor + 1 >= nNibbles)
+		return false;
+	unsigned char rotation = getNibble(stream, cursor + 1);
+	if (rotation >= N_MOVES - N_FACE_MOVES)
+		return false;
+	move = static_cast<Move>(N_FACE_MOVES + rotation);
+	cursor += 2;
+	return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Move.hpp"
+
+/* The on-disk format of a recorded show: the moves every cube of a grid made, so the show replays without being solved again.
+   All fields are little-endian:
+	header        "TSCH", uint32 version, uint32 rows, uint32 cols, uint64 total moves                  24 bytes
+	index         per cube: uint64 offset of its stream in the file, uint32 nibbles, uint32 moves         16 bytes each
+	start states  per cube: 54 sticker bytes, Color values in the order of CubeState                     54 bytes each
+	streams       per cube: its moves as nibbles, two to a byte, low nibble first
+   A face turn is the single nibble of its Move value. Rotations of the whole cube are rare, so they take two:
+   ESCAPE, then the Move value minus N_FACE_MOVES. The index gives the stream of any cube without reading the others */
+class Choreography {
+public:
+	static const uint32_t VERSION = 1;
+
+	static const size_t HEADER_BYTES = 24;
+	static const size_t INDEX_BYTES = 16;
+	static const size_t STATE_BYTES = 54;
+
+	static const unsigned char ESCAPE = 15;
+
+	/* the "TSCH" the file starts with */
+	static const char* const MAGIC;
+
+	/* writes the nibbles of move to nibbles and returns how many there are, 1 or 2 */
+	static size_t encode(Move move, unsigned char nibbles[2]);
+
+	/* decodes the move starting at nibble cursor of a stream of nNibbles and advances cursor past it.
+	   Returns false at the end of the stream and on codes no move has */
+	static bool decode(const unsigned char* stream, size_t nNibbles, size_t& cursor, Move& move);
+};
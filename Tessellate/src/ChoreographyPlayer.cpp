@@ -0,0 +1,147 @@
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "ChoreographyPlayer.hpp"
+#include "Choreography.hpp"
+#include "Grid.hpp"
+
+namespace {
+	uint32_t getU32(const unsigned char* in) {
+		return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+	}
+
+	uint64_t getU64(const unsigned char* in) {
+		return getU32(in) | (static_cast<uint64_t>(getU32(in + 4)) << 32);
+	}
+}
+
+ChoreographyPlayer::ChoreographyPlayer(const char* filepath)
+	: file(filepath), path(filepath), nRows(0), nCols(0), nTotalMoves(0), nFed(0) {
+	const unsigned char* data = file.getData();
+	size_t size = file.getSize();
+	std::string name(filepath);
+	if (size < Choreography::HEADER_BYTES || memcmp(data, Choreography::MAGIC, 4) != 0)
+		throw std::runtime_error(name + " is not a choreography");
+	if (getU32(data + 4) != Choreography::VERSION)
+		throw std::runtime_error(name + " is a choreography of another version");
+	nRows = getU32(data + 8);
+	nCols = getU32(data + 12);
+	nTotalMoves = getU64(data + 16);
+
+	// every stream must lie inside the file, behind the index and the start states
+	size_t n = nRows * nCols;
+	size_t perCube = Choreography::INDEX_BYTES + Choreography::STATE_BYTES;
+	if (nRows == 0 || nCols == 0 || n / nCols != nRows || n > (size - Choreography::HEADER_BYTES) / perCube)
+		throw std::runtime_error(name + " is truncated");
+	uint64_t streamsStart = Choreography::HEADER_BYTES + n * perCube;
+	for (size_t i = 0; i < n; i++) {
+		const unsigned char* entry = data + Choreography::HEADER_BYTES + i * Choreography::INDEX_BYTES;
+		uint64_t offset = getU64(entry);
+		uint64_t bytes = (getU32(entry + 8) + 1ull) / 2;
+		if (offset < streamsStart || offset > size || bytes > size - offset)
+			throw std::runtime_error(name + " has a stream outside the file");
+	}
+	const unsigned char* states = data + Choreography::HEADER_BYTES + n * Choreography::INDEX_BYTES;
+	for (size_t i = 0; i < n * Choreography::STATE_BYTES; i++)
+		if (states[i] > static_cast<unsigned char>(Color::WHITE))
+			throw std::runtime_error(name + " has a sticker of no color");
+}
+
+size_t ChoreographyPlayer::getRows() const {
+	return nRows;
+}
+
+size_t ChoreographyPlayer::getCols() const {
+	return nCols;
+}
+
+void ChoreographyPlayer::start(Grid& grid) {
+	grid.resize(nRows, nCols);
+
+	size_t n = nRows * nCols;
+	const unsigned char* states = file.getData() + Choreography::HEADER_BYTES + n * Choreography::INDEX_BYTES;
+	for (size_t i = 0; i < n; i++)
+		for (size_t s = 0; s < Choreography::STATE_BYTES; s++)
+			grid.cubes.states[i].stickers[s] = static_cast<Color>(states[i * Choreography::STATE_BYTES + s]);
+	grid.cubes.notifyResize(nRows, nCols); // a show played while recording is recorded from its start states
+
+	cursors.assign(n, 0);
+	active.resize(n);
+	for (size_t i = 0; i < n; i++)
+		active[i] = static_cast<uint32_t>(i);
+	nFed = 0;
+}
+
+void ChoreographyPlayer::resume(const Grid& grid, const ShowPosition& position) {
+	size_t n = nRows * nCols;
+	if (grid.nRows != nRows || grid.nCols != nCols || position.cursors.size() != n)
+		throw std::runtime_error(path + " is for a grid of another size");
+	std::vector<size_t> resumed(n);
+	std::vector<uint32_t> unfinished;
+	for (size_t i = 0; i < n; i++) {
+		const unsigned char* stream;
+		size_t nNibbles;
+		getStream(i, stream, nNibbles);
+		if (position.cursors[i] > nNibbles)
+			throw std::runtime_error(path + " is shorter than the position to resume from");
+		resumed[i] = static_cast<size_t>(position.cursors[i]);
+		if (resumed[i] < nNibbles)
+			unfinished.push_back(static_cast<uint32_t>(i));
+	}
+	cursors.swap(resumed);
+	active.swap(unfinished);
+	nFed = position.nFed;
+}
+
+ShowPosition ChoreographyPlayer::getPosition() const {
+	return ShowPosition{ path, nFed, std::vector<uint64_t>(cursors.begin(), cursors.end()) };
+}
+
+void ChoreographyPlayer::update(CubeArena& cubes) {
+	Move moves[FEED_MOVES];
+	for (size_t a = 0; a < active.size();) {
+		uint32_t i = active[a];
+		if (i >= cubes.size()) { // the grid was resized under the show
+			active.clear();
+			break;
+		}
+		if (cubes[i].getQueueSize() >= LOW_WATER) {
+			a++;
+			continue;
+		}
+
+		const unsigned char* stream;
+		size_t nNibbles;
+		getStream(i, stream, nNibbles);
+		size_t n = 0;
+		while (n < FEED_MOVES && Choreography::decode(stream, nNibbles, cursors[i], moves[n]))
+			n++;
+		cubes.push(i, moves, n);
+		nFed += n;
+
+		if (n < FEED_MOVES) { // the end of the stream, or a code no move has
+			active[a] = active.back();
+			active.pop_back();
+		} else {
+			a++;
+		}
+	}
+}
+
+bool ChoreographyPlayer::isFinished() const {
+	return active.empty();
+}
+
+std::string ChoreographyPlayer::describe() const {
+	char line[96];
+	snprintf(line, sizeof(line), "PLAY %llu/%llu MOVES", static_cast<unsigned long long>(nFed), static_cast<unsigned long long>(nTotalMoves));
+	return line;
+}
+
+void ChoreographyPlayer::getStream(size_t index, const unsigned char*& stream, size_t& nNibbles) const {
+	const unsigned char* entry = file.getData() + Choreography::HEADER_BYTES + index * Choreography::INDEX_BYTES;
+	stream = file.getData() + getU64(entry);
+	nNibbles = getU32(entry + 8);
+}
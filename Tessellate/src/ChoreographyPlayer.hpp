@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+class Grid;
+class CubeArena;
+
+/* how far a show has played, so it can carry on from there */
+struct ShowPosition {
+	std::string path;
+	uint64_t nFed; // moves queued so far
+	std::vector<uint64_t> cursors; // next nibble of each cube's stream
+};
+
+/* Plays a Choreography back on a grid. The file is mapped rather than read, and each cube's queue is topped up from its stream
+   only when it is about to run dry, so starting a show costs the same whatever its length */
+class ChoreographyPlayer {
+public:
+	/* a cube is topped up once fewer moves than this are queued on it */
+	static const size_t LOW_WATER = 8;
+	/* moves decoded into a queue at a time */
+	static const size_t FEED_MOVES = 32;
+private:
+	MappedFile file;
+	std::string path;
+	size_t nRows, nCols;
+	uint64_t nTotalMoves, nFed;
+	std::vector<size_t> cursors; // next nibble of each cube's stream
+	std::vector<uint32_t> active; // cubes whose streams have moves left
+public:
+	/* maps filepath and checks its header and index. throws std::runtime_error if it is not a choreography */
+	ChoreographyPlayer(const char* filepath);
+
+	size_t getRows() const;
+	size_t getCols() const;
+
+	/* resizes grid to the show and sets every cube to its start state */
+	void start(Grid& grid);
+
+	/* carries on from position on a grid already in the state it was in then, ex. restored from a GridSnapshot.
+	   throws std::runtime_error if position does not fit this show or the grid is not its size */
+	void resume(const Grid& grid, const ShowPosition& position);
+
+	ShowPosition getPosition() const;
+
+	/* tops up the queues of the cubes about to run dry. Must run on the thread that pushes to cubes, between updates */
+	void update(CubeArena& cubes);
+
+	/* true once every move was queued */
+	bool isFinished() const;
+
+	/* a line for the HUD, ex. "PLAY 1200/4800 MOVES" */
+	std::string describe() const;
+
+private:
+	/* reads the index entry of cube index */
+	void getStream(size_t index, const unsigned char*& stream, size_t& nNibbles) const;
+};
@@ -0,0 +1,107 @@
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "ChoreographyRecorder.hpp"
+#include "Choreography.hpp"
+
+namespace {
+	void putU32(std::vector<unsigned char>& out, uint32_t v) {
+		for (int i = 0; i < 4; i++)
+			out.push_back((v >> (8 * i)) & 0xFF);
+	}
+
+	void putU64(std::vector<unsigned char>& out, uint64_t v) {
+		for (int i = 0; i < 8; i++)
+			out.push_back((v >> (8 * i)) & 0xFF);
+	}
+}
+
+ChoreographyRecorder::ChoreographyRecorder()
+	: nRows(0), nCols(0) {}
+
+void ChoreographyRecorder::start(size_t rows, size_t cols, const CubeArena& cubes) {
+	nRows = rows;
+	nCols = cols;
+	starts = cubes.states;
+	streams.assign(cubes.size(), std::vector<unsigned char>());
+	nNibbles.assign(cubes.size(), 0);
+	nMoves.assign(cubes.size(), 0);
+}
+
+void ChoreographyRecorder::restart(size_t index, const CubeState& state) {
+	if (index >= starts.size())
+		return;
+	starts[index] = state;
+	streams[index].clear();
+	nNibbles[index] = 0;
+	nMoves[index] = 0;
+}
+
+void ChoreographyRecorder::record(size_t index, Move move) {
+	if (index >= starts.size())
+		return;
+	unsigned char nibbles[2];
+	size_t n = Choreography::encode(move, nibbles);
+	std::vector<unsigned char>& stream = streams[index];
+	for (size_t i = 0; i < n; i++) {
+		if (nNibbles[index] % 2 == 0)
+			stream.push_back(nibbles[i]);
+		else
+			stream.back() |= nibbles[i] << 4;
+		nNibbles[index]++;
+	}
+	nMoves[index]++;
+}
+
+void ChoreographyRecorder::onMove(size_t index, Move move, float ago) {
+	record(index, move);
+}
+
+void ChoreographyRecorder::onRestart(size_t index, const CubeState& state) {
+	restart(index, state);
+}
+
+void ChoreographyRecorder::onResize(size_t rows, size_t cols, const CubeArena& cubes) {
+	start(rows, cols, cubes);
+}
+
+size_t ChoreographyRecorder::getMoveCount() const {
+	size_t total = 0;
+	for (uint32_t n : nMoves)
+		total += n;
+	return total;
+}
+
+void ChoreographyRecorder::save(const char* filepath) const {
+	size_t n = starts.size();
+	std::vector<unsigned char> head;
+	head.reserve(Choreography::HEADER_BYTES + n * (Choreography::INDEX_BYTES + Choreography::STATE_BYTES));
+
+	head.insert(head.end(), Choreography::MAGIC, Choreography::MAGIC + 4);
+	putU32(head, Choreography::VERSION);
+	putU32(head, static_cast<uint32_t>(nRows));
+	putU32(head, static_cast<uint32_t>(nCols));
+	putU64(head, getMoveCount());
+
+	// the streams follow the start states back to back
+	uint64_t offset = Choreography::HEADER_BYTES + n * (Choreography::INDEX_BYTES + Choreography::STATE_BYTES);
+	for (size_t i = 0; i < n; i++) {
+		putU64(head, offset);
+		putU32(head, nNibbles[i]);
+		putU32(head, nMoves[i]);
+		offset += streams[i].size();
+	}
+	for (const CubeState& state : starts)
+		for (Color color : state.stickers)
+			head.push_back(static_cast<unsigned char>(color));
+
+	std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+	if (!file)
+		throw std::runtime_error(std::string("cannot open ") + filepath + " for writing");
+	file.write(reinterpret_cast<const char*>(head.data()), head.size());
+	for (const std::vector<unsigned char>& stream : streams)
+		file.write(reinterpret_cast<const char*>(stream.data()), stream.size());
+	if (!file)
+		throw std::runtime_error(std::string("cannot write ") + filepath);
+}
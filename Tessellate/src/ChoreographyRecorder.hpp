@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CubeArena.hpp"
+
+/* Records every move the cubes of a grid finish into a Choreography. Attach it with CubeArena::addObserver.
+   A cube changed without a move, by a reset or a scramble, starts its stream over from its new state,
+   so the recording holds the last uninterrupted run of each cube */
+class ChoreographyRecorder : public CubeObserver {
+private:
+	size_t nRows, nCols;
+	std::vector<CubeState> starts;
+	std::vector<std::vector<unsigned char>> streams; // nibbles, two to a byte, low nibble first
+	std::vector<uint32_t> nNibbles, nMoves;
+public:
+	ChoreographyRecorder();
+
+	/* forgets what was recorded and starts over from the current state of the rows * cols cubes */
+	void start(size_t rows, size_t cols, const CubeArena& cubes);
+
+	/* the stream of cube index starts over from state */
+	void restart(size_t index, const CubeState& state);
+
+	/* appends a move cube index finished. Cubes of disjoint ranges may record in parallel */
+	void record(size_t index, Move move);
+
+	void onMove(size_t index, Move move, float ago) override;
+	void onRestart(size_t index, const CubeState& state) override;
+	void onResize(size_t rows, size_t cols, const CubeArena& cubes) override;
+
+	size_t getMoveCount() const;
+
+	/* writes the recording to filepath. throws std::runtime_error if it cannot be written */
+	void save(const char* filepath) const;
+};
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "ColorQuantizer.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TESSELLATE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace {
+	/* sRGB byte to linear light */
+	float toLinear(unsigned char c) {
+		static const struct Table {
+			float values[256];
+			Table() {
+				for (int i = 0; i < 256; i++) {
+					float v = i / 255.0f;
+					values[i] = v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+				}
+			}
+		} table;
+		return table.values[c];
+	}
+
+	/* linear sRGB to OKLab (Bjorn Ottosson, 2020) */
+	glm::vec3 toOKLab(float r, float g, float b) {
+		float l = std::cbrt(0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b);
+		float m = std::cbrt(0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b);
+		float s = std::cbrt(0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b);
+		return glm::vec3(
+			0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s,
+			1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s,
+			0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s);
+	}
+
+	glm::vec3 toOKLab(unsigned char r, unsigned char g, unsigned char b) {
+		return toOKLab(toLinear(r), toLinear(g), toLinear(b));
+	}
+}
+
+const glm::vec3 ColorQuantizer::STANDARD_STICKERS[6] = {
+	glm::vec3(183, 18, 52), // RED
+	glm::vec3(255, 88, 0), // ORANGE
+	glm::vec3(255, 213, 0), // YELLOW
+	glm::vec3(0, 155, 72), // GREEN
+	glm::vec3(0, 70, 173), // BLUE
+	glm::vec3(255, 255, 255) }; // WHITE
+
+ColorQuantizer::ColorQuantizer()
+	: ColorQuantizer(STANDARD_STICKERS) {}
+
+ColorQuantizer::ColorQuantizer(const glm::vec3 stickers[6]) {
+	for (int i = 0; i < 6; i++) {
+		this->stickers[i] = stickers[i];
+		glm::vec3 lab = toOKLab(
+			static_cast<unsigned char>(glm::clamp(stickers[i].r, 0.0f, 255.0f) + 0.5f),
+			static_cast<unsigned char>(glm::clamp(stickers[i].g, 0.0f, 255.0f) + 0.5f),
+			static_cast<unsigned char>(glm::clamp(stickers[i].b, 0.0f, 255.0f) + 0.5f));
+		stickerL[i] = lab.x;
+		stickerA[i] = lab.y;
+		stickerB[i] = lab.z;
+	}
+	for (int i = 6; i < 8; i++) { // far outside the OKLab gamut
+		stickerL[i] = 1.0e6f;
+		stickerA[i] = 1.0e6f;
+		stickerB[i] = 1.0e6f;
+	}
+	build();
+}
+
+ColorQuantizer ColorQuantizer::fromFile(const char* const filepath) {
+	std::ifstream inFile(filepath);
+	if (!inFile)
+		throw std::runtime_error(std::string("cannot find sticker color file ") + filepath);
+
+	glm::vec3 colors[6];
+	int nColors = 0;
+	std::string line;
+	while (nColors < 6 && std::getline(inFile, line)) {
+		if (line.empty() || line[0] == '#')
+			continue;
+		std::istringstream values(line);
+		float r, g, b;
+		if (!(values >> r >> g >> b))
+			throw std::runtime_error(std::string("invalid sticker color \"") + line + "\" in " + filepath);
+		colors[nColors++] = glm::vec3(r, g, b);
+	}
+	if (nColors < 6)
+		throw std::runtime_error(std::string(filepath) + " must list 6 sticker colors");
+	return ColorQuantizer(colors);
+}
+
+Color ColorQuantizer::quantize(unsigned char r, unsigned char g, unsigned char b) const {
+	unsigned char index = lut[cellIndex(r, g, b)];
+	if (index == AMBIGUOUS)
+		index = findClosest(r, g, b);
+	return static_cast<Color>(index);
+}
+
+void ColorQuantizer::quantizeRow(const unsigned char rgb[], size_t n, Color output[]) const {
+	const unsigned char* table = lut.data();
+	size_t i = 0;
+	// four independent lookups per iteration keep several loads in flight
+	for (; i + 4 <= n; i += 4, rgb += 12) {
+		unsigned char i0 = table[cellIndex(rgb[0], rgb[1], rgb[2])];
+		unsigned char i1 = table[cellIndex(rgb[3], rgb[4], rgb[5])];
+		unsigned char i2 = table[cellIndex(rgb[6], rgb[7], rgb[8])];
+		unsigned char i3 = table[cellIndex(rgb[9], rgb[10], rgb[11])];
+		output[i + 0] = static_cast<Color>(i0 != AMBIGUOUS ? i0 : findClosest(rgb[0], rgb[1], rgb[2]));
+		output[i + 1] = static_cast<Color>(i1 != AMBIGUOUS ? i1 : findClosest(rgb[3], rgb[4], rgb[5]));
+		output[i + 2] = static_cast<Color>(i2 != AMBIGUOUS ? i2 : findClosest(rgb[6], rgb[7], rgb[8]));
+		output[i + 3] = static_cast<Color>(i3 != AMBIGUOUS ? i3 : findClosest(rgb[9], rgb[10], rgb[11]));
+	}
+	for (; i < n; i++, rgb += 3)
+		output[i] = quantize(rgb[0], rgb[1], rgb[2]);
+}
+
+const glm::vec3& ColorQuantizer::getStickerColor(Color color) const {
+	return stickers[static_cast<int>(color)];
+}
+
+void ColorQuantizer::build() {
+	// classify the corners of every cell. Corner k sits at sRGB value k * CELL_SIZE, clamped to 255
+	static const int CELL_SIZE = 256 / CELLS;
+	static const int CORNERS = CELLS + 1;
+	std::vector<unsigned char> corners(CORNERS * CORNERS * CORNERS);
+	for (int r = 0; r < CORNERS; r++)
+		for (int g = 0; g < CORNERS; g++)
+			for (int b = 0; b < CORNERS; b++)
+				corners[(r * CORNERS + g) * CORNERS + b] = findClosest(
+					static_cast<unsigned char>(std::min(r * CELL_SIZE, 255)),
+					static_cast<unsigned char>(std::min(g * CELL_SIZE, 255)),
+					static_cast<unsigned char>(std::min(b * CELL_SIZE, 255)));
+
+	// a cell is decided when all 8 of its corners agree
+	lut.resize(CELLS * CELLS * CELLS);
+	for (int r = 0; r < CELLS; r++) {
+		for (int g = 0; g < CELLS; g++) {
+			for (int b = 0; b < CELLS; b++) {
+				unsigned char first = corners[(r * CORNERS + g) * CORNERS + b];
+				bool agree = true;
+				for (int k = 1; k < 8 && agree; k++)
+					agree = corners[((r + (k >> 2)) * CORNERS + g + ((k >> 1) & 1)) * CORNERS + b + (k & 1)] == first;
+				lut[(r * CELLS + g) * CELLS + b] = agree ? first : AMBIGUOUS;
+			}
+		}
+	}
+}
+
+unsigned char ColorQuantizer::findClosest(unsigned char r, unsigned char g, unsigned char b) const {
+	glm::vec3 lab = toOKLab(r, g, b);
+
+#ifdef TESSELLATE_SSE
+	// squared distances to stickers 0-3 and 4-7 side by side
+	__m128 l = _mm_set1_ps(lab.x), a = _mm_set1_ps(lab.y), bb = _mm_set1_ps(lab.z);
+	float distances[8];
+	for (int half = 0; half < 2; half++) {
+		__m128 dl = _mm_sub_ps(l, _mm_loadu_ps(stickerL + half * 4));
+		__m128 da = _mm_sub_ps(a, _mm_loadu_ps(stickerA + half * 4));
+		__m128 db = _mm_sub_ps(bb, _mm_loadu_ps(stickerB + half * 4));
+		__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dl, dl), _mm_mul_ps(da, da)), _mm_mul_ps(db, db));
+		_mm_storeu_ps(distances + half * 4, d);
+	}
+#else
+	float distances[8];
+	for (int i = 0; i < 8; i++) {
+		float dl = lab.x - stickerL[i], da = lab.y - stickerA[i], db = lab.z - stickerB[i];
+		distances[i] = dl * dl + da * da + db * db;
+	}
+#endif
+
+	unsigned char closest = 0;
+	for (unsigned char i = 1; i < 6; i++)
+		if (distances[i] < distances[closest])
+			closest = i;
+	return closest;
+}
+
+size_t ColorQuantizer::cellIndex(unsigned char r, unsigned char g, unsigned char b) {
+	static const int SHIFT = 8 - CELL_BITS;
+	return (static_cast<size_t>(r >> SHIFT) << (2 * CELL_BITS)) | ((g >> SHIFT) << CELL_BITS) | (b >> SHIFT);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include "Square.hpp"
+
+/* Maps RGB colors to the closest sticker color.
+   Closeness is measured in OKLab, a perceptually uniform color space, against sticker colors that can be measured from a real cube.
+   Lookups go through a precomputed table of 64x64x64 RGB cells. A cell whose corners disagree on the closest sticker straddles
+   a boundary between two colors, and pixels in it fall back to an exact search. */
+class ColorQuantizer {
+public:
+	static const int CELL_BITS = 6; // 64 cells per channel
+	static const int CELLS = 1 << CELL_BITS;
+private:
+	static const unsigned char AMBIGUOUS = 0xFF;
+
+	glm::vec3 stickers[6]; // sRGB, 0..255, in the order of the Color enum
+	/* sticker colors in OKLab, split per channel so the exact search compares a pixel against all stickers at once.
+	   Padded to 8 with entries that are never closest */
+	float stickerL[8], stickerA[8], stickerB[8];
+	std::vector<unsigned char> lut; // CELLS^3 sticker indices, or AMBIGUOUS
+public:
+	/* uses STANDARD_STICKERS */
+	ColorQuantizer();
+
+	/* stickers holds 6 sRGB colors (0..255) in the order of the Color enum */
+	ColorQuantizer(const glm::vec3 stickers[6]);
+
+	/* the sticker colors of an official cube, in sRGB */
+	static const glm::vec3 STANDARD_STICKERS[6];
+
+	/* reads 6 lines of "r g b" (0..255) in the order red, orange, yellow, green, blue, white. Lines starting with # are ignored.
+	   Throws std::runtime_error if the file cannot be read */
+	static ColorQuantizer fromFile(const char* const filepath);
+
+	/* returns the closest sticker color */
+	Color quantize(unsigned char r, unsigned char g, unsigned char b) const;
+
+	/* quantizes n pixels of 8-bit interleaved rgb */
+	void quantizeRow(const unsigned char rgb[], size_t n, Color output[]) const;
+
+	/* returns the sRGB value (0..255) of a sticker */
+	const glm::vec3& getStickerColor(Color color) const;
+
+private:
+	/* builds the lookup table */
+	void build();
+
+	/* searches every sticker for the one closest to an sRGB color */
+	unsigned char findClosest(unsigned char r, unsigned char g, unsigned char b) const;
+
+	static size_t cellIndex(unsigned char r, unsigned char g, unsigned char b);
+};
@@ -0,0 +1,125 @@
+#include <cctype>
+#include <limits>
+#include <sstream>
+
+#include "Command.hpp"
+
+Command Command::turn(FaceType face, bool clockwise) {
+	Command command{};
+	command.type = Type::TURN;
+	command.face = face;
+	command.clockwise = clockwise;
+	return command;
+}
+
+namespace {
+	bool parseFace(char c, FaceType& face) {
+		switch (toupper(c)) {
+		case 'F': face = FaceType::FRONT; return true;
+		case 'B': face = FaceType::BACK; return true;
+		case 'U': face = FaceType::UP; return true;
+		case 'D': face = FaceType::DOWN; return true;
+		case 'R': face = FaceType::RIGHT; return true;
+		case 'L': face = FaceType::LEFT; return true;
+		default: return false;
+		}
+	}
+
+	/* parses word as a whole number */
+	template <typename T>
+	bool parseNumber(const std::string& word, T& value) {
+		std::istringstream number(word);
+		return number >> value && number.peek() == EOF;
+	}
+}
+
+bool parseCommands(const std::string& line, std::vector<Command>& commands, std::string& error) {
+	std::istringstream stream(line);
+	std::vector<std::string> words;
+	for (std::string word; stream >> word;)
+		words.push_back(word);
+	bool valid = true;
+	auto fail = [&](const std::string& message) {
+		if (valid)
+			error = message;
+		valid = false;
+	};
+	// the word after word i, uppercased. Empty past the end of the line
+	auto argument = [&](size_t i) {
+		std::string upper;
+		if (i + 1 < words.size()) {
+			for (char c : words[i + 1])
+				upper += static_cast<char>(toupper(c));
+		}
+		return upper;
+	};
+
+	// a keyword with missing or invalid arguments is skipped. Arguments that are not numbers are left to be parsed as words of their own
+	for (size_t w = 0; w < words.size(); w++) {
+		const std::string& word = words[w];
+		std::string keyword;
+		for (char c : word)
+			keyword += static_cast<char>(toupper(c));
+
+		Command command{};
+		if (keyword == "SELECT") {
+			command.type = Command::Type::SELECT;
+			if (!parseNumber(argument(w), command.row) || !parseNumber(argument(w + 1), command.col)) {
+				fail("SELECT needs a row and a column");
+				continue;
+			}
+			w += 2;
+			commands.push_back(command);
+		} else if (keyword == "WAIT") {
+			command.type = Command::Type::WAIT;
+			if (!parseNumber(argument(w), command.seconds)) {
+				fail("WAIT needs a number of seconds");
+				continue;
+			}
+			w++;
+			if (command.seconds < 0) {
+				fail("WAIT needs a number of seconds");
+				continue;
+			}
+			commands.push_back(command);
+		} else if (keyword == "SCRAMBLE") {
+			command.type = Command::Type::SCRAMBLE;
+			commands.push_back(command);
+		} else if (keyword == "RESET") {
+			command.type = Command::Type::RESET;
+			commands.push_back(command);
+		} else if (keyword == "SEEK") {
+			command.type = Command::Type::SEEK;
+			std::string target = argument(w);
+			if (target == "END") {
+				command.seconds = std::numeric_limits<float>::infinity();
+			} else if (!parseNumber(target, command.seconds)) {
+				fail("SEEK needs a number of seconds or END");
+				continue;
+			}
+			w++;
+			if (command.seconds < 0) {
+				fail("SEEK needs a number of seconds or END");
+				continue;
+			}
+			commands.push_back(command);
+		} else if (keyword == "LOAD") {
+			command.type = Command::Type::LOAD_IMAGE;
+			commands.push_back(command);
+		} else {
+			// a sequence of turns, each a face optionally followed by ' for counterclockwise
+			for (size_t i = 0; i < word.length(); i++) {
+				FaceType face{};
+				if (!parseFace(word[i], face)) {
+					fail(std::string("invalid turn ") + word[i] + " in " + word);
+					continue;
+				}
+				bool clockwise = !(i + 1 < word.length() && word[i + 1] == '\'');
+				if (!clockwise)
+					i++;
+				commands.push_back(Command::turn(face, clockwise));
+			}
+		}
+	}
+	return valid;
+}
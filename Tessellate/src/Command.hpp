@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Face.hpp"
+
+/* Something the simulation is asked to do, parsed from text typed on the command line, read from a script or received on a socket */
+struct Command {
+	enum class Type {
+		TURN, // turn a face of the selected cube
+		SELECT, // select the cube at row, col
+		SCRAMBLE, // scramble the selected cube
+		RESET, // reset every cube
+		LOAD_IMAGE, // paint the grid with the current image, like the O key
+		SEEK, // move the grid's timeline to seconds, or to its end if seconds is infinite
+		WAIT // pause the producer for seconds before it sends the next command. Never reaches the simulation
+	};
+
+	Type type;
+	FaceType face;
+	bool clockwise;
+	unsigned int row, col;
+	float seconds;
+
+	static Command turn(FaceType face, bool clockwise);
+};
+
+/* parses one line of commands: whitespace-separated words, each a keyword (SELECT <row> <col>, SCRAMBLE, RESET, LOAD, WAIT <seconds>, SEEK <seconds>|END)
+   or a sequence of face turns such as F'BL. Keywords and faces are case-insensitive.
+   Valid commands are appended even if others are not: a keyword missing its arguments is skipped, and the words after it are still parsed.
+   returns false and describes the first invalid word in error */
+bool parseCommands(const std::string& line, std::vector<Command>& commands, std::string& error);
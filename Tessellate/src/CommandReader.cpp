@@ -0,0 +1,115 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "CommandReader.hpp"
+
+void CommandReader::send(CommandRing& ring, const std::string& line, const std::string& source) {
+	std::vector<Command> commands;
+	std::string error;
+	if (!parseCommands(line, commands, error))
+		std::cout << source << ": " << error << ". Skipping." << std::endl;
+
+	for (const Command& command : commands) {
+		if (command.type == Command::Type::WAIT) {
+			std::this_thread::sleep_for(std::chrono::duration<float>(command.seconds));
+			continue;
+		}
+		// the simulation frees slots every frame
+		while (!ring.push(command))
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+std::shared_ptr<CommandRing> CommandReader::fromStdin() {
+	std::shared_ptr<CommandRing> ring = std::make_shared<CommandRing>();
+	std::thread([ring] {
+		std::string line;
+		do {
+			std::cout << std::endl << "Enter valid commands (ex. F', B, L, R', U, D, SELECT 0 1, SCRAMBLE, RESET, LOAD):" << std::endl;
+			if (!std::getline(std::cin, line))
+				return;
+			send(*ring, line, "stdin");
+			std::cout << "Added instruction set to queue." << std::endl;
+		} while (true);
+	}).detach();
+	return ring;
+}
+
+std::shared_ptr<CommandRing> CommandReader::fromScript(const std::string& path) {
+	std::shared_ptr<std::ifstream> script = std::make_shared<std::ifstream>(path);
+	if (!*script)
+		throw std::runtime_error("cannot open script " + path);
+
+	std::shared_ptr<CommandRing> ring = std::make_shared<CommandRing>();
+	std::thread([ring, script, path] {
+		std::string line;
+		while (std::getline(*script, line))
+			send(*ring, line.substr(0, line.find('#')), path);
+		std::cout << "Finished script " << path << std::endl;
+	}).detach();
+	return ring;
+}
+
+#ifdef _WIN32
+
+std::shared_ptr<CommandRing> CommandReader::fromSocket(const std::string& path) {
+	throw std::runtime_error("command sockets are not supported on Windows. Use a script instead");
+}
+
+#else
+
+std::shared_ptr<CommandRing> CommandReader::fromSocket(const std::string& path) {
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	if (path.length() >= sizeof(address.sun_path))
+		throw std::runtime_error("socket path is too long: " + path);
+	strcpy(address.sun_path, path.c_str());
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0)
+		throw std::runtime_error("cannot create socket " + path);
+	unlink(path.c_str()); // left behind by a previous run
+	if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listener, 4) < 0) {
+		close(listener);
+		throw std::runtime_error("cannot listen on socket " + path);
+	}
+	std::cout << "Listening for commands on " << path << std::endl;
+
+	std::shared_ptr<CommandRing> ring = std::make_shared<CommandRing>();
+	std::thread([ring, listener, path] {
+		for (;;) {
+			int client = accept(listener, nullptr, nullptr);
+			if (client < 0)
+				continue;
+
+			// split the byte stream into lines
+			std::string pending;
+			char buffer[4096];
+			ssize_t n;
+			while ((n = read(client, buffer, sizeof(buffer))) > 0) {
+				pending.append(buffer, n);
+				size_t newline;
+				while ((newline = pending.find('\n')) != std::string::npos) {
+					send(*ring, pending.substr(0, newline), path);
+					pending.erase(0, newline + 1);
+				}
+			}
+			send(*ring, pending, path);
+			close(client);
+		}
+	}).detach();
+	return ring;
+}
+
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "CommandRing.hpp"
+
+/* Producers of commands. Each reads text on its own thread and pushes the parsed commands into a ring of its own,
+   which the simulation drains once per frame. The threads are detached because they block on input that may never come;
+   the ring is shared so it lives as long as whichever side finishes last */
+class CommandReader {
+public:
+	/* reads lines typed on stdin */
+	static std::shared_ptr<CommandRing> fromStdin();
+
+	/* reads a script, one line of commands at a time. Text after # is a comment.
+	   throws std::runtime_error if the file cannot be opened */
+	static std::shared_ptr<CommandRing> fromScript(const std::string& path);
+
+	/* listens on a UNIX domain socket and reads lines from one client at a time.
+	   throws std::runtime_error if the socket cannot be created, and on Windows */
+	static std::shared_ptr<CommandRing> fromSocket(const std::string& path);
+
+private:
+	/* parses a line and pushes its commands, waiting while the ring is full. WAIT pauses here, on the producer's thread */
+	static void send(CommandRing& ring, const std::string& line, const std::string& source);
+};
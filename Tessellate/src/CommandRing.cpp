@@ -0,0 +1,25 @@
+#include "CommandRing.hpp"
+
+CommandRing::CommandRing()
+	: slots{}, head(0), tail(0) {
+}
+
+bool CommandRing::push(const Command& command) {
+	size_t h = head.load(std::memory_order_relaxed);
+	if (h - tail.load(std::memory_order_acquire) == CAPACITY)
+		return false;
+	slots[h & (CAPACITY - 1)] = command;
+	// publishes the slot to the consumer
+	head.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+bool CommandRing::pop(Command& command) {
+	size_t t = tail.load(std::memory_order_relaxed);
+	if (t == head.load(std::memory_order_acquire))
+		return false;
+	command = slots[t & (CAPACITY - 1)];
+	// hands the slot back to the producer
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "Command.hpp"
+
+/* A lock-free single-producer, single-consumer queue of commands.
+   One producer thread pushes and the simulation thread pops, without either ever blocking the other */
+class CommandRing {
+public:
+	/* a power of two, so positions wrap with a mask */
+	static const size_t CAPACITY = 256;
+private:
+	static const size_t CACHE_LINE = 64;
+
+	Command slots[CAPACITY];
+	/* positions only ever increase. Each is written by one side and read by the other, and sits on its own cache line */
+	std::atomic<size_t> head; // next slot to write, owned by the producer
+	char headPadding[CACHE_LINE - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> tail; // next slot to read, owned by the consumer
+	char tailPadding[CACHE_LINE - sizeof(std::atomic<size_t>)];
+public:
+	CommandRing();
+
+	CommandRing(const CommandRing&) = delete;
+	CommandRing& operator=(const CommandRing&) = delete;
+
+	/* producer only. returns false if the ring is full */
+	bool push(const Command& command);
+
+	/* consumer only. returns false if the ring is empty */
+	bool pop(Command& command);
+};
@@ -0,0 +1,413 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "CubeArena.hpp"
+#include "Cube.hpp"
+
+namespace {
+	/* moves a queue's segment of the pool holds at least, so short queues do not move around while they grow */
+	const size_t MIN_SEGMENT = 16;
+
+	const float DEFAULT_SOLVE_SPEED = 2.6f;
+
+	/* how far a selected cube is lifted out of the grid */
+	const glm::vec3 SELECTION_LIFT(0, 7, 0);
+
+	/* where every vertex of every sticker sits when no layer is turning. The same for all cubes */
+	struct RestGeometry {
+		glm::vec3 vertices[6][9][6];
+		glm::vec3 centers[6][9];
+
+		RestGeometry() {
+			using namespace glm;
+
+			float x = -1.5;
+			float y = 1.5;
+			float z = 1.5;
+
+			// generate the front face's vertices
+			for (int i = 0; i < 9; i++) {
+				vertices[static_cast<int>(FaceType::FRONT)][i][0] = vec3(x, y, z); // top left triangle, starting at the right angle going clockwise
+				vertices[static_cast<int>(FaceType::FRONT)][i][1] = vec3(x + 1, y, z);
+				vertices[static_cast<int>(FaceType::FRONT)][i][2] = vec3(x, y - 1, z);
+				vertices[static_cast<int>(FaceType::FRONT)][i][3] = vec3(x + 1, y - 1, z); // bottom right triangle, same as above
+				vertices[static_cast<int>(FaceType::FRONT)][i][4] = vec3(x, y - 1, z);
+				vertices[static_cast<int>(FaceType::FRONT)][i][5] = vec3(x + 1, y, z);
+
+				x += 1;
+				if (x >= 1.5) {
+					x = -1.5; // go back to beginning column
+					y -= 1; // go down a row
+				}
+			}
+
+			// generate other faces' vertices by rotating the front face's vertices around the model origin
+			mat4 model = mat4(1.0f);
+			mat4 toFace[6] = {
+				model,
+				glm::rotate(model, -half_pi<float>(), vec3(1.0f, 0.0f, 0.0f)), // up
+				glm::rotate(model, pi<float>(), vec3(1.0f, 0.0f, 0.0f)), // back
+				glm::rotate(model, half_pi<float>(), vec3(1.0f, 0.0f, 0.0f)), // down
+				glm::rotate(model, -half_pi<float>(), vec3(0.0f, 1.0f, 0.0f)), // left
+				glm::rotate(model, half_pi<float>(), vec3(0.0f, 1.0f, 0.0f)) }; // right
+			for (int f = 1; f < 6; f++) { // for each face but the front
+				for (int i = 0; i < 9; i++) { // for each square
+					for (int j = 0; j < 6; j++) { // for each vertex
+						vec3 rotated = toFace[f] * vec4(vertices[static_cast<int>(FaceType::FRONT)][i][j], 0.0f);
+						// remove the rounding error of the rotation so rest positions are exact
+						vertices[f][i][j] = vec3(round(rotated.x * 2) / 2.0f, round(rotated.y * 2) / 2.0f, round(rotated.z * 2) / 2.0f);
+					}
+				}
+			}
+
+			// sticker centers decide which layer a sticker belongs to
+			for (int f = 0; f < 6; f++) {
+				for (int i = 0; i < 9; i++)
+					centers[f][i] = (vertices[f][i][1] + vertices[f][i][2]) / 2.0f;
+			}
+		}
+	};
+
+	const RestGeometry& getRestGeometry() {
+		static const RestGeometry geometry;
+		return geometry;
+	}
+
+	/* outward normal of each face. Front, Up, Back, Down, Left, Right */
+	const glm::vec3 FACE_NORMALS[6] = {
+		glm::vec3(0, 0, 1), glm::vec3(0, 1, 0), glm::vec3(0, 0, -1),
+		glm::vec3(0, -1, 0), glm::vec3(-1, 0, 0), glm::vec3(1, 0, 0) };
+
+	/* timing curve of a turn: starts and ends slowly. t is the fraction of the turn in [0, 1] */
+	float ease(float t) {
+		return t * t * (3 - 2 * t);
+	}
+}
+
+CubeRef::CubeRef()
+	: arena(nullptr), index(0) {}
+
+CubeRef::CubeRef(CubeArena& arena, size_t index)
+	: arena(&arena), index(index) {}
+
+CubeRef::operator bool() const {
+	return arena != nullptr;
+}
+
+size_t CubeRef::getIndex() const {
+	return index;
+}
+
+void CubeRef::addToQueue(Move move) {
+	arena->push(index, &move, 1);
+}
+
+void CubeRef::addToQueue(const std::shared_ptr<Instruction>& instruction) {
+	addToQueue(toMove(*instruction));
+}
+
+void CubeRef::addToQueue(const Move moves[], size_t n) {
+	arena->push(index, moves, n);
+}
+
+size_t CubeRef::getQueueSize() const {
+	return arena->queueEnd[index] - arena->queueFront[index];
+}
+
+void CubeRef::getColors(Color colors[54]) const {
+	std::copy(arena->states[index].stickers, arena->states[index].stickers + 54, colors);
+}
+
+const CubeState& CubeRef::getState() const {
+	return arena->states[index];
+}
+
+void CubeRef::scramble() {
+	for (int i = 0; i < 1000; i++)
+		arena->states[index].apply(getFaceMove(static_cast<FaceType>(rand() % 6), rand() % 2));
+	arena->notifyRestart(index);
+}
+
+void CubeRef::print() const {
+	Color colors[54];
+	getColors(colors);
+	Cube(colors).print();
+}
+
+void CubeRef::reset() {
+	arena->reset(index);
+}
+
+float CubeRef::getSolveSpeed() const {
+	return arena->solveSpeeds[index];
+}
+
+void CubeRef::setSolveSpeed(float speed) {
+	arena->solveSpeeds[index] = speed;
+}
+
+glm::vec3 CubeRef::getPosition() const {
+	return arena->positions[index];
+}
+
+bool CubeRef::isSelected() const {
+	return arena->selected[index] != 0;
+}
+
+void CubeRef::select() {
+	if (!arena->selected[index]) {
+		arena->selected[index] = 1;
+		arena->positions[index] += SELECTION_LIFT;
+	}
+}
+
+void CubeRef::deselect() {
+	if (arena->selected[index]) {
+		arena->selected[index] = 0;
+		arena->positions[index] -= SELECTION_LIFT;
+	}
+}
+
+CubeArena::CubeArena()
+	: nAbandoned(0) {}
+
+void CubeArena::resize(size_t n) {
+	states.assign(n, CubeState::standard());
+	positions.assign(n, glm::vec3(0.0f));
+	turnProgress.assign(n, 0.0f);
+	solveSpeeds.assign(n, DEFAULT_SOLVE_SPEED);
+	selected.assign(n, 0);
+	queueStart.assign(n, 0);
+	queueFront.assign(n, 0);
+	queueEnd.assign(n, 0);
+	queueLimit.assign(n, 0);
+	movePool.clear();
+	nAbandoned = 0;
+}
+
+size_t CubeArena::size() const {
+	return states.size();
+}
+
+CubeRef CubeArena::operator[](size_t index) {
+	return CubeRef(*this, index);
+}
+
+void CubeArena::update(size_t first, size_t last, float deltatime) {
+	for (size_t i = first; i < last; i++) {
+		uint32_t front = queueFront[i];
+		if (front == queueEnd[i] || solveSpeeds[i] <= 0) // idle cubes cost two compares
+			continue;
+
+		// progress is kept as a fraction of a quarter turn so changing the solve speed mid-turn does not jump
+		float progress = turnProgress[i] + deltatime * solveSpeeds[i] / glm::half_pi<float>();
+
+		// apply every move that has finished, carrying the leftover time into the next one
+		while (front != queueEnd[i] && progress >= 1.0f) {
+			progress -= 1.0f;
+			Move move = movePool[front++];
+			states[i].apply(move);
+			for (CubeObserver* observer : observers) // the leftover progress is how long ago the move finished
+				observer->onMove(i, move, progress * glm::half_pi<float>() / solveSpeeds[i]);
+		}
+		if (front == queueEnd[i]) { // the segment is empty: the next moves can start at its beginning
+			progress = 0;
+			front = queueEnd[i] = queueStart[i];
+		}
+		queueFront[i] = front;
+		turnProgress[i] = progress;
+	}
+}
+
+void CubeArena::push(size_t index, const Move moves[], size_t n) {
+	size_t pending = queueEnd[index] - queueFront[index];
+	if (queueEnd[index] + n > queueLimit[index]) {
+		size_t capacity = queueLimit[index] - queueStart[index];
+		if (pending + n <= capacity) { // there is room before the pending moves
+			std::copy(movePool.begin() + queueFront[index], movePool.begin() + queueEnd[index], movePool.begin() + queueStart[index]);
+		} else { // move to a bigger segment at the end of the pool
+			size_t newCapacity = std::max(MIN_SEGMENT, std::max(capacity * 2, pending + n));
+			size_t start = movePool.size();
+			if (start + newCapacity > std::numeric_limits<uint32_t>::max())
+				throw std::runtime_error("too many moves queued on the grid");
+			movePool.resize(start + newCapacity);
+			std::copy(movePool.begin() + queueFront[index], movePool.begin() + queueEnd[index], movePool.begin() + start);
+			nAbandoned += capacity;
+			queueStart[index] = static_cast<uint32_t>(start);
+			queueLimit[index] = static_cast<uint32_t>(start + newCapacity);
+		}
+		queueFront[index] = queueStart[index];
+		queueEnd[index] = static_cast<uint32_t>(queueStart[index] + pending);
+	}
+	std::copy(moves, moves + n, movePool.begin() + queueEnd[index]);
+	queueEnd[index] += static_cast<uint32_t>(n);
+
+	if (nAbandoned > movePool.size() / 2)
+		compact();
+}
+
+bool CubeArena::pushInPlace(size_t index, const Move moves[], size_t n) {
+	if (queueEnd[index] + n > queueLimit[index])
+		return false;
+	std::copy(moves, moves + n, movePool.begin() + queueEnd[index]);
+	queueEnd[index] += static_cast<uint32_t>(n);
+	return true;
+}
+
+void CubeArena::reserveQueues(size_t capacity) {
+	if (size() * capacity > std::numeric_limits<uint32_t>::max())
+		throw std::runtime_error("too many moves queued on the grid");
+	movePool.resize(size() * capacity);
+	nAbandoned = 0;
+	for (size_t i = 0; i < size(); i++) {
+		queueStart[i] = queueFront[i] = queueEnd[i] = static_cast<uint32_t>(i * capacity);
+		queueLimit[i] = static_cast<uint32_t>((i + 1) * capacity);
+	}
+}
+
+void CubeArena::pushFront(size_t index, const Move moves[], size_t n) {
+	std::vector<Move> pending(movePool.begin() + queueFront[index], movePool.begin() + queueEnd[index]);
+	turnProgress[index] = 0;
+	queueFront[index] = queueEnd[index] = queueStart[index];
+	push(index, moves, n);
+	push(index, pending.data(), pending.size());
+}
+
+void CubeArena::setQueues(const uint32_t lengths[], const Move moves[], size_t nMoves) {
+	if (nMoves > std::numeric_limits<uint32_t>::max())
+		throw std::runtime_error("too many moves queued on the grid");
+	movePool.assign(moves, moves + nMoves);
+	nAbandoned = 0;
+
+	// the queues lie back to back, each in a segment exactly its size. The first push moves one to the end of the pool
+	uint32_t offset = 0;
+	for (size_t i = 0; i < size(); i++) {
+		if (lengths[i] > nMoves - offset)
+			throw std::runtime_error("queues hold more moves than given");
+		queueStart[i] = queueFront[i] = offset;
+		offset += lengths[i];
+		queueEnd[i] = queueLimit[i] = offset;
+	}
+}
+
+void CubeArena::reset() {
+	for (size_t i = 0; i < size(); i++)
+		reset(i);
+	// every segment is empty, so the pool can start over
+	movePool.clear();
+	std::fill(queueStart.begin(), queueStart.end(), 0);
+	std::fill(queueFront.begin(), queueFront.end(), 0);
+	std::fill(queueEnd.begin(), queueEnd.end(), 0);
+	std::fill(queueLimit.begin(), queueLimit.end(), 0);
+	nAbandoned = 0;
+}
+
+void CubeArena::reset(size_t index) {
+	states[index] = CubeState::standard();
+	turnProgress[index] = 0;
+	queueFront[index] = queueEnd[index] = queueStart[index];
+	notifyRestart(index);
+}
+
+void CubeArena::addObserver(CubeObserver* observer) {
+	if (std::find(observers.begin(), observers.end(), observer) == observers.end())
+		observers.push_back(observer);
+}
+
+void CubeArena::removeObserver(CubeObserver* observer) {
+	observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+}
+
+void CubeArena::notifyResize(size_t rows, size_t cols) {
+	for (CubeObserver* observer : observers)
+		observer->onResize(rows, cols, *this);
+}
+
+void CubeArena::notifyRestart(size_t index) {
+	for (CubeObserver* observer : observers)
+		observer->onRestart(index, states[index]);
+}
+
+float CubeArena::getTurnAngle(size_t index) const {
+	if (queueFront[index] == queueEnd[index])
+		return 0;
+	return ease(std::min(std::max(turnProgress[index], 0.0f), 1.0f)) * glm::half_pi<float>();
+}
+
+float CubeArena::getTurnDuration(size_t index) const {
+	if (solveSpeeds[index] <= 0)
+		return std::numeric_limits<float>::infinity();
+	return glm::half_pi<float>() / solveSpeeds[index];
+}
+
+void CubeArena::getVertexData(size_t index, float vertex_buffer_data[]) const {
+	const RestGeometry& rest = getRestGeometry();
+
+	// a single rotation for every sticker the front move turns
+	glm::mat3 rotation(1.0f);
+	glm::vec3 layerNormal(0.0f); // stickers whose center lies more than 0.5 along this are in the turning layer
+	bool wholeCube = false;
+	if (queueFront[index] != queueEnd[index]) {
+		Move move = movePool[queueFront[index]];
+		float angle = getTurnAngle(index);
+		if (isFaceMove(move)) {
+			layerNormal = FACE_NORMALS[static_cast<int>(getMoveFace(move))];
+			// a clockwise turn (seen from outside the face) is a positive rotation around the inward normal
+			rotation = glm::mat3(glm::rotate(glm::mat4(1.0f), isMoveClockwise(move) ? angle : -angle, -layerNormal));
+		} else {
+			wholeCube = true;
+			rotation = glm::mat3(glm::rotate(glm::mat4(1.0f), angle, getMoveAxis(move)));
+		}
+	}
+
+	// cubes are only ever translated, so the model transform is an offset
+	glm::vec3 position = positions[index];
+	for (int i = 0; i < 6; i++) { // for each face
+		for (int j = 0; j < 9; j++) { // for each square
+			bool moving = wholeCube || glm::dot(rest.centers[i][j], layerNormal) > 0.5f;
+			for (int k = 0; k < 6; k++) { // for each vertex
+				glm::vec3 vertex = (moving ? rotation * rest.vertices[i][j][k] : rest.vertices[i][j][k]) + position;
+				vertex_buffer_data[i * 9 * 6 * 3 + j * 6 * 3 + k * 3 + 0] = vertex.x;
+				vertex_buffer_data[i * 9 * 6 * 3 + j * 6 * 3 + k * 3 + 1] = vertex.y;
+				vertex_buffer_data[i * 9 * 6 * 3 + j * 6 * 3 + k * 3 + 2] = vertex.z;
+			}
+		}
+	}
+}
+
+void CubeArena::getColorData(size_t index, float color_buffer_data[]) const {
+	static const glm::vec3 RGB[6] = { // in the order of Color
+		glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.6470588f, 0.0f), glm::vec3(1.0f, 1.0f, 0.0f),
+		glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 1.0f, 1.0f) };
+
+	const CubeState& state = states[index];
+	for (int i = 0; i < 54; i++) { // for each square
+		const glm::vec3& color = RGB[static_cast<int>(state.stickers[i])];
+		for (int k = 0; k < 6; k++) { // for each vertex
+			color_buffer_data[i * 6 * 3 + k * 3 + 0] = color.r;
+			color_buffer_data[i * 6 * 3 + k * 3 + 1] = color.g;
+			color_buffer_data[i * 6 * 3 + k * 3 + 2] = color.b;
+		}
+	}
+}
+
+void CubeArena::compact() {
+	std::vector<Move> pool;
+	pool.reserve(movePool.size() - nAbandoned);
+	for (size_t i = 0; i < size(); i++) {
+		size_t pending = queueEnd[i] - queueFront[i];
+		size_t start = pool.size();
+		// idle cubes give up their segment. Busy ones keep only their pending moves
+		pool.insert(pool.end(), movePool.begin() + queueFront[i], movePool.begin() + queueEnd[i]);
+		queueStart[i] = queueFront[i] = static_cast<uint32_t>(start);
+		queueEnd[i] = queueLimit[i] = static_cast<uint32_t>(start + pending);
+	}
+	movePool.swap(pool);
+	nAbandoned = 0;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "CubeState.hpp"
+
+class CubeArena;
+
+/* Told about everything that happens to the cubes of a CubeArena, to record it or to keep a history of it (see CubeArena::addObserver) */
+class CubeObserver {
+public:
+	virtual ~CubeObserver() {}
+
+	/* cube index finished move, ago seconds before the end of the update that finished it.
+	   Called from CubeArena::update, for disjoint ranges of cubes in parallel */
+	virtual void onMove(size_t index, Move move, float ago) = 0;
+
+	/* cube index was changed without a move, by a reset or a scramble */
+	virtual void onRestart(size_t index, const CubeState& state) = 0;
+
+	/* every cube was replaced: the arena now holds a grid of rows x cols cubes in new states */
+	virtual void onResize(size_t rows, size_t cols, const CubeArena& cubes) = 0;
+};
+
+/* A handle to one cube of a CubeArena. Cheap to copy; valid until the arena is resized */
+class CubeRef {
+private:
+	CubeArena* arena;
+	size_t index;
+public:
+	/* a handle to no cube */
+	CubeRef();
+
+	CubeRef(CubeArena& arena, size_t index);
+
+	explicit operator bool() const;
+
+	size_t getIndex() const;
+
+	/* appends a move to the cube's queue */
+	void addToQueue(Move move);
+
+	void addToQueue(const std::shared_ptr<Instruction>& instruction);
+
+	/* appends n moves to the cube's queue */
+	void addToQueue(const Move moves[], size_t n);
+
+	/* returns the number of pending moves in the queue */
+	size_t getQueueSize() const;
+
+	/* writes the colors of all 54 squares, face by face in the order of FaceType */
+	void getColors(Color colors[54]) const;
+
+	const CubeState& getState() const;
+
+	/* 1000 random face turns, applied instantly */
+	void scramble();
+
+	void print() const;
+
+	/* clears the queue and reverts to the standard colors */
+	void reset();
+
+	/* how fast a face rotates, in radians per second. Turns pause while it is not positive */
+	float getSolveSpeed() const;
+
+	void setSolveSpeed(float speed);
+
+	/* get world coordinates of cube's center */
+	glm::vec3 getPosition() const;
+
+	bool isSelected() const;
+
+	void select();
+
+	void deselect();
+};
+
+/* Every cube of a grid, stored as parallel arrays instead of one object per cube: cube i is element i of each array.
+   A pass over one property streams through memory, and a cube costs about a hundred bytes plus its queued moves.
+   The queues are segments of one shared move pool. Cube i's pending moves are movePool[queueFront[i], queueEnd[i]),
+   inside a segment of the pool that starts at queueStart[i] and ends at queueLimit[i]. Queues are only appended to
+   by one thread at a time, and not while update runs. Render geometry is derived on demand by getVertexData and getColorData */
+class CubeArena {
+public:
+	static const size_t FLOATS_PER_CUBE = 3 * 3 * 2 * 9 * 6; // 3 floats per vertex * 3 vertices per triangle * 2 triangles per square * 9 squares * 6 faces
+public:
+	std::vector<CubeState> states;
+	std::vector<glm::vec3> positions; // 3D coordinates of the center of each cube, lifted while selected
+	std::vector<float> turnProgress; // fraction of a quarter turn the front move of each queue has completed
+	std::vector<float> solveSpeeds; // radians per second
+	std::vector<unsigned char> selected;
+	std::vector<uint32_t> queueStart, queueFront, queueEnd, queueLimit; // offsets into movePool
+	std::vector<Move> movePool;
+private:
+	size_t nAbandoned; // moves of the pool in segments no cube uses anymore
+	std::vector<CubeObserver*> observers;
+public:
+	CubeArena();
+
+	/* replaces every cube with n standard cubes at the origin, with empty queues */
+	void resize(size_t n);
+
+	size_t size() const;
+
+	CubeRef operator[](size_t index);
+
+	/* advances the turn animations of cubes first to last - 1 by deltatime, applying every move that finishes.
+	   Touches nothing outside those cubes, so disjoint ranges can be updated in parallel */
+	void update(size_t first, size_t last, float deltatime);
+
+	/* appends n moves to the queue of cube index */
+	void push(size_t index, const Move moves[], size_t n);
+
+	/* appends n moves to the queue of cube index only if they fit in its segment as it is. Touches nothing of the other cubes
+	   nor the size of the pool, so different cubes can be filled in parallel. returns false, changing nothing, if they do not fit */
+	bool pushInPlace(size_t index, const Move moves[], size_t n);
+
+	/* gives every cube an empty segment of capacity moves, back to back, so plans can be written into the pool in parallel with pushInPlace.
+	   Every queue must be empty, ex. right after resize. Reuses the pool's memory when it is big enough */
+	void reserveQueues(size_t capacity);
+
+	/* puts n moves in front of the pending moves of cube index, to be made first, and restarts its turn animation */
+	void pushFront(size_t index, const Move moves[], size_t n);
+
+	/* replaces every queue at once: cube i gets the next lengths[i] of the nMoves moves. For restoring a saved grid in one pass */
+	void setQueues(const uint32_t lengths[], const Move moves[], size_t nMoves);
+
+	/* clears every queue and reverts every cube to the standard colors */
+	void reset();
+
+	/* clears the queue of cube index and reverts it to the standard colors */
+	void reset(size_t index);
+
+	/* from now on every move a cube finishes and every reset is reported to observer, until it is removed */
+	void addObserver(CubeObserver* observer);
+
+	void removeObserver(CubeObserver* observer);
+
+	/* tells the observers the cubes were replaced by a grid of rows x cols, after a resize or after their states were set */
+	void notifyResize(size_t rows, size_t cols);
+
+	/* tells the observers cube index was changed without a move */
+	void notifyRestart(size_t index);
+
+	/* angle in radians the front move of cube index has turned so far, after easing. 0 when idle */
+	float getTurnAngle(size_t index) const;
+
+	/* seconds one quarter turn of cube index takes at its solve speed */
+	float getTurnDuration(size_t index) const;
+
+	/* writes the world-space vertices of cube index, FLOATS_PER_CUBE floats, from the stickers' rest positions and the current turn angle */
+	void getVertexData(size_t index, float vertex_buffer_data[]) const;
+
+	/* writes the color of every vertex of cube index, FLOATS_PER_CUBE floats */
+	void getColorData(size_t index, float color_buffer_data[]) const;
+
+private:
+	/* rebuilds the move pool with only the pending moves, once enough of it is abandoned */
+	void compact();
+};
@@ -0,0 +1,33 @@
+#include <algorithm>
+
+#include "CubeState.hpp"
+#include "Cube.hpp"
+
+const CubeState& CubeState::standard() {
+	static const CubeState state = [] {
+		CubeState s;
+		Cube().getColors(s.stickers);
+		return s;
+	}();
+	return state;
+}
+
+void CubeState::apply(Move move) {
+	const unsigned char* from = getMovePermutation(move);
+	Color before[54];
+	std::copy(stickers, stickers + 54, before);
+	for (int i = 0; i < 54; i++)
+		stickers[i] = before[from[i]];
+}
+
+Color CubeState::getColorAt(FaceType face, unsigned int index) const {
+	return stickers[static_cast<int>(face) * 9 + index];
+}
+
+bool CubeState::operator==(const CubeState& other) const {
+	return std::equal(stickers, stickers + 54, other.stickers);
+}
+
+bool CubeState::operator!=(const CubeState& other) const {
+	return !(*this == other);
+}
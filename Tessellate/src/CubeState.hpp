@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Move.hpp"
+
+/* The 54 stickers of a cube and nothing else, in 54 bytes. Stickers are stored face by face in the order of FaceType (see Cube::getColors) */
+struct CubeState {
+	Color stickers[54];
+
+	/* the solved cube every grid starts with */
+	static const CubeState& standard();
+
+	/* instantly applies move through its permutation table */
+	void apply(Move move);
+
+	Color getColorAt(FaceType face, unsigned int index) const;
+
+	bool operator==(const CubeState& other) const;
+	bool operator!=(const CubeState& other) const;
+};
@@ -0,0 +1,75 @@
+#include <algorithm>
+
+#include "ErrorDiffuser.hpp"
+#include "RGBImage.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TESSELLATE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace {
+	const size_t CHANNELS = RGBImage::CHANNELS;
+}
+
+ErrorDiffuser::ErrorDiffuser(size_t width, const ColorQuantizer& quantizer)
+	: width(width), quantizer(quantizer), stickers{}, errorRows(2 * (width + 2) * CHANNELS, 0.0f) {
+	for (int i = 0; i < 6; i++)
+		for (int c = 0; c < 3; c++)
+			stickers[i][c] = quantizer.getStickerColor(static_cast<Color>(i))[c];
+	current = errorRows.data();
+	next = current + (width + 2) * CHANNELS;
+}
+
+void ErrorDiffuser::ditherRow(const float row[], Color output[]) {
+#ifdef TESSELLATE_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 max = _mm_set1_ps(255.0f);
+	const __m128 right = _mm_set1_ps(7 / 16.0f);
+	const __m128 belowLeft = _mm_set1_ps(3 / 16.0f);
+	const __m128 below = _mm_set1_ps(5 / 16.0f);
+	const __m128 belowRight = _mm_set1_ps(1 / 16.0f);
+#endif
+
+	for (size_t x = 0; x < width; x++) {
+		float* err = current + (x + 1) * CHANNELS; // error buffers are offset by the left border pixel
+		float* errBelow = next + (x + 1) * CHANNELS;
+#ifdef TESSELLATE_SSE
+		__m128 pixel = _mm_add_ps(_mm_loadu_ps(row + x * CHANNELS), _mm_loadu_ps(err));
+		pixel = _mm_min_ps(_mm_max_ps(pixel, zero), max);
+
+		int rounded[CHANNELS];
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(rounded), _mm_cvtps_epi32(pixel));
+		Color closest = quantizer.quantize(rounded[0], rounded[1], rounded[2]);
+		output[x] = closest;
+
+		// push the quantization error onto the unvisited neighbours
+		__m128 error = _mm_sub_ps(pixel, _mm_loadu_ps(stickers[static_cast<int>(closest)]));
+		float* errRight = err + CHANNELS;
+		_mm_storeu_ps(errRight, _mm_add_ps(_mm_loadu_ps(errRight), _mm_mul_ps(error, right)));
+		_mm_storeu_ps(errBelow - CHANNELS, _mm_add_ps(_mm_loadu_ps(errBelow - CHANNELS), _mm_mul_ps(error, belowLeft)));
+		_mm_storeu_ps(errBelow, _mm_add_ps(_mm_loadu_ps(errBelow), _mm_mul_ps(error, below)));
+		_mm_storeu_ps(errBelow + CHANNELS, _mm_add_ps(_mm_loadu_ps(errBelow + CHANNELS), _mm_mul_ps(error, belowRight)));
+#else
+		float pixel[CHANNELS];
+		for (size_t c = 0; c < CHANNELS; c++)
+			pixel[c] = std::min(std::max(row[x * CHANNELS + c] + err[c], 0.0f), 255.0f);
+
+		Color closest = quantizer.quantize(
+			static_cast<unsigned char>(pixel[0] + 0.5f), static_cast<unsigned char>(pixel[1] + 0.5f), static_cast<unsigned char>(pixel[2] + 0.5f));
+		output[x] = closest;
+
+		// push the quantization error onto the unvisited neighbours
+		for (size_t c = 0; c < CHANNELS; c++) {
+			float error = pixel[c] - stickers[static_cast<int>(closest)][c];
+			err[CHANNELS + c] += error * 7 / 16.0f;
+			(errBelow - CHANNELS)[c] += error * 3 / 16.0f;
+			errBelow[c] += error * 5 / 16.0f;
+			errBelow[CHANNELS + c] += error * 1 / 16.0f;
+		}
+#endif
+	}
+	// the next row becomes the current one and the old current row is recycled
+	std::swap(current, next);
+	std::fill(next, next + (width + 2) * CHANNELS, 0.0f);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+#include "ColorQuantizer.hpp"
+
+/* Floyd-Steinberg dithering fed one row at a time, top to bottom. Only the error carried into the current and the next row is kept,
+   so images of any height can be dithered as they stream in */
+class ErrorDiffuser {
+private:
+	size_t width;
+	const ColorQuantizer& quantizer; // must outlive the diffuser
+	float stickers[6][4]; // sticker colors padded to a whole pixel
+	/* error carried into the current and the next row. One extra pixel on each side absorbs error pushed off the edges */
+	std::vector<float> errorRows;
+	float* current;
+	float* next;
+public:
+	ErrorDiffuser(size_t width, const ColorQuantizer& quantizer);
+
+	/* maps a row of width pixels (RGBImage::CHANNELS floats each, 0..255) to sticker colors,
+	   diffusing the difference to the chosen sticker's color onto the unvisited neighbours */
+	void ditherRow(const float row[], Color output[]);
+};
@@ -0,0 +1,153 @@
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#include "FrameSource.hpp"
+
+FrameSource::Shared::~Shared() {
+	if (ownsFile && file)
+		fclose(file);
+}
+
+FrameSource::FrameSource(const char* const path, size_t rawWidth, size_t rawHeight)
+	: shared(std::make_shared<Shared>()), width(rawWidth), height(rawHeight) {
+
+	shared->ownsFile = strcmp(path, "-") != 0;
+	if (shared->ownsFile) {
+		shared->file = fopen(path, "rb");
+	} else {
+		shared->file = stdin;
+#ifdef _WIN32
+		_setmode(_fileno(stdin), _O_BINARY);
+#endif
+	}
+	if (!shared->file)
+		throw std::runtime_error(std::string("cannot open video stream ") + path);
+
+	VideoFrame::Format format = VideoFrame::Format::RGB24;
+	shared->isY4M = rawWidth == 0 || rawHeight == 0;
+	if (shared->isY4M) {
+		// stream header: YUV4MPEG2 W<width> H<height> [C<colorspace>] and other parameters we do not need
+		std::string header;
+		if (!readLine(shared->file, header) || header.compare(0, 10, "YUV4MPEG2 ") != 0)
+			throw std::runtime_error("video stream is not YUV4MPEG2. Pass the size of raw rgb24 frames instead");
+		std::istringstream params(header.substr(10));
+		std::string param;
+		std::string colorspace = "420jpeg";
+		while (params >> param) {
+			if (param[0] == 'W')
+				width = std::stoul(param.substr(1));
+			else if (param[0] == 'H')
+				height = std::stoul(param.substr(1));
+			else if (param[0] == 'C')
+				colorspace = param.substr(1);
+		}
+		if (colorspace.compare(0, 3, "444") == 0)
+			format = VideoFrame::Format::YUV444;
+		else if (colorspace.compare(0, 3, "422") == 0)
+			format = VideoFrame::Format::YUV422;
+		else if (colorspace.compare(0, 3, "420") == 0)
+			format = VideoFrame::Format::YUV420;
+		else if (colorspace == "mono")
+			format = VideoFrame::Format::GRAY;
+		else
+			throw std::runtime_error("unsupported YUV4MPEG2 colorspace " + colorspace);
+	}
+	if (width == 0 || height == 0)
+		throw std::runtime_error("video stream has no frame size");
+
+	for (std::unique_ptr<VideoFrame>& frame : shared->frames)
+		frame.reset(new VideoFrame(width, height, format));
+	shared->writing = 0;
+	shared->ready = 1;
+	shared->reading = 2;
+	shared->fresh = false;
+	shared->finished = false;
+	shared->stopping = false;
+	shared->nFrames = 0;
+	shared->nDropped = 0;
+
+	// the thread cannot be interrupted while it waits for input, so it is detached and keeps the shared state alive itself
+	std::thread(&FrameSource::readFrames, shared).detach();
+}
+
+FrameSource::~FrameSource() {
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	shared->stopping = true;
+}
+
+size_t FrameSource::getWidth() const {
+	return width;
+}
+
+size_t FrameSource::getHeight() const {
+	return height;
+}
+
+const VideoFrame* FrameSource::acquire() {
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	if (!shared->fresh)
+		return nullptr;
+	std::swap(shared->reading, shared->ready);
+	shared->fresh = false;
+	return shared->frames[shared->reading].get();
+}
+
+bool FrameSource::isFinished() const {
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	return shared->finished && !shared->fresh;
+}
+
+size_t FrameSource::getFrameCount() const {
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	return shared->nFrames;
+}
+
+size_t FrameSource::getDroppedCount() const {
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	return shared->nDropped;
+}
+
+void FrameSource::readFrames(std::shared_ptr<Shared> shared) {
+	std::string frameHeader;
+	while (true) {
+		VideoFrame* frame;
+		{
+			std::lock_guard<std::mutex> lock(shared->mutex);
+			if (shared->stopping)
+				return;
+			frame = shared->frames[shared->writing].get();
+		}
+
+		// every y4m frame starts with a FRAME line
+		bool complete = !shared->isY4M || (readLine(shared->file, frameHeader) && frameHeader.compare(0, 5, "FRAME") == 0);
+		complete = complete && fread(frame->getData(), 1, frame->getSize(), shared->file) == frame->getSize();
+
+		std::lock_guard<std::mutex> lock(shared->mutex);
+		if (!complete) {
+			shared->finished = true;
+			return;
+		}
+		// publish the frame. One the consumer never took is dropped
+		std::swap(shared->writing, shared->ready);
+		if (shared->fresh)
+			shared->nDropped++;
+		shared->fresh = true;
+		shared->nFrames++;
+	}
+}
+
+bool FrameSource::readLine(FILE* file, std::string& line) {
+	line.clear();
+	int c;
+	while ((c = fgetc(file)) != EOF && c != '\n')
+		line.push_back(static_cast<char>(c));
+	return c != EOF;
+}
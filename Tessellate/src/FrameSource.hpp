@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "VideoFrame.hpp"
+
+/* Reads uncompressed video frames from stdin or a FIFO on a background thread, for example from
+   ffmpeg -i input.mp4 -f yuv4mpegpipe -pix_fmt yuv444p -
+   Frames are read straight into one of three buffers that are recycled, never copied. Only the newest frame is kept:
+   if the consumer has not taken a frame by the time the next one is complete, the older one is dropped so latency stays bounded */
+class FrameSource {
+private:
+	/* state shared with the reader thread, which may outlive the FrameSource while it is blocked in a read */
+	struct Shared {
+		FILE* file;
+		bool ownsFile; // false for stdin
+		bool isY4M;
+		std::mutex mutex;
+		std::unique_ptr<VideoFrame> frames[3];
+		int writing, ready, reading; // which buffer the reader fills, which holds the newest complete frame, which the consumer holds
+		bool fresh; // ready holds a frame the consumer has not taken
+		bool finished; // the stream ended
+		bool stopping; // the FrameSource was destroyed
+		size_t nFrames, nDropped;
+
+		~Shared();
+	};
+	std::shared_ptr<Shared> shared;
+	size_t width, height;
+public:
+	/* path "-" reads stdin. Streams are YUV4MPEG2 unless rawWidth and rawHeight are given, in which case they are raw rgb24.
+	   Blocks until the stream header is read. Throws std::runtime_error if the stream cannot be opened or parsed */
+	FrameSource(const char* const path, size_t rawWidth = 0, size_t rawHeight = 0);
+	~FrameSource();
+
+	FrameSource(const FrameSource&) = delete;
+	FrameSource& operator=(const FrameSource&) = delete;
+
+	size_t getWidth() const;
+	size_t getHeight() const;
+
+	/* returns the newest complete frame that has not been returned yet, or nullptr if there is none.
+	   The frame stays valid until the next call */
+	const VideoFrame* acquire();
+
+	/* true once the stream has ended */
+	bool isFinished() const;
+
+	size_t getFrameCount() const;
+	size_t getDroppedCount() const;
+
+private:
+	/* body of the reader thread */
+	static void readFrames(std::shared_ptr<Shared> shared);
+
+	/* reads bytes up to and excluding the next newline. Returns false at the end of the stream */
+	static bool readLine(FILE* file, std::string& line);
+};
@@ -1,8 +1,20 @@
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <math.h>
+#include <mutex>
 
 #include "Grid.hpp"
 #include "AI.hpp"
+#include "JobSystem.hpp"
+
+namespace {
+    /* cubes animated by one job */
+    const size_t UPDATE_CHUNK = 256;
+
+    /* tiles planned by one job, so the jobs themselves cost little next to the plans. Small enough to balance plans of uneven length */
+    const size_t TILES_PER_JOB = 16;
+}
 
 Grid::Grid(size_t rows, size_t columns) {
     resize(rows, columns);
@@ -41,70 +53,127 @@ void Grid::resize(size_t rows, size_t columns) {
     nRows = rows;
     nCols = columns;
 
-    // destroy all cubes
-    cubes.clear();
+    // replace all cubes with standard ones
+    cubes.resize(rows * columns);
 
-    // cubes.push_back(std::make_shared<Cube>());
-    // cubes[0]->translate(glm::vec3(-10.0f, 0.0f, -5.0f));
     for (int r = 0; r < rows; r++) {
         for (int c = 0; c < columns; c++) {
-            // create cube
-            std::shared_ptr<Cube> cube = std::make_shared<Cube>();
-
             // translate
-            cube->translate(calcCoords(r, c));
-
-            // add to cubes
-            cubes.push_back(cube);
+            cubes.positions[r * columns + c] = calcCoords(r, c);
         }
     }
+
+    // recordings and histories follow the grid to its new size
+    cubes.notifyResize(rows, columns);
 }
 
 void Grid::update(float deltatime) {
-	for (std::shared_ptr<Cube>& cube : cubes)
-		cube->update(deltatime);
+	// cubes animate independently of each other
+	JobSystem::shared().parallelFor(cubes.size(), UPDATE_CHUNK, [&](size_t first, size_t last) {
+		cubes.update(first, last, deltatime);
+	});
 }
 
 void Grid::reset() {
-	for (std::shared_ptr<Cube>& cubeptr : cubes) {
-		cubeptr->reset();
-	}
+	cubes.reset();
 	std::cout << "Reset cubes" << std::endl;
 }
 
-void Grid::solveImage(BMPImage& bmp) {
+void Grid::solveImage(BMPImage& bmp, const ColorQuantizer& quantizer) {
     size_t width = bmp.getWidth();
     size_t height = bmp.getHeight();
 
+    // allocate and fill memory for Color array
+    Color* pixels = new Color[width * height];
+    bmp.getPixels(pixels, quantizer);
+
+    solveImage(pixels, width, height);
+
+    // release memory
+    delete[] pixels;
+}
+
+void Grid::solveImage(const Color pixels[], size_t width, size_t height) {
     // resize grid
     resize(ceil(height / 3.0f), ceil(width / 3.0f));
 
-    // allocate and fill memory for Color array
-    Color* pixels = new Color[width * height];
-    bmp.getPixels(pixels);
+    // stickers past the right or bottom edge of an image that is not a multiple of 3 are white
+    auto pixelAt = [&](size_t r, size_t c) {
+        return r < height && c < width ? pixels[r * width + c] : Color::WHITE;
+    };
 
-    for (int r = 0; r < width; r += 3) { // per row
-        for (int c = 0; c < width; c += 3) { // per column
+    // every tile is planned by a job of its own, straight into its cube's segment of the move pool
+    size_t nTiles = nRows * nCols;
+    cubes.reserveQueues(AI::PLAN_SLOT);
+    Spill spill;
+    JobSystem::shared().parallelFor(nTiles, TILES_PER_JOB, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+            size_t r = i / nCols * 3, c = i % nCols * 3;
             Color paintpattern[9] = {
-                pixels[(r + 0) * width + c], pixels[(r + 0) * width + c + 1], pixels[(r + 0) * width + c + 2],
-                pixels[(r + 1) * width + c], pixels[(r + 1) * width + c + 1], pixels[(r + 1) * width + c + 2],
-                pixels[(r + 2) * width + c], pixels[(r + 2) * width + c + 1], pixels[(r + 2) * width + c + 2]
+                pixelAt(r + 0, c), pixelAt(r + 0, c + 1), pixelAt(r + 0, c + 2),
+                pixelAt(r + 1, c), pixelAt(r + 1, c + 1), pixelAt(r + 1, c + 2),
+                pixelAt(r + 2, c), pixelAt(r + 2, c + 1), pixelAt(r + 2, c + 2)
             };
-            AI ai(cubes[r / 3 * nCols + c / 3].get());
-            ai.calculatePaint(paintpattern);
-            ai.start();
+            planTile(i, paintpattern, spill);
+        }
+    });
+    queueSpill(spill);
+}
+
+void Grid::solveImage(ImageStream& stream) {
+    resize(stream.getRows(), stream.getCols());
+    cubes.reserveQueues(AI::PLAN_SLOT);
+
+    // tiles are planned by jobs while the next band is decoded. They are children of one job that finishes with the last of them
+    JobSystem& jobs = JobSystem::shared();
+    JobSystem::JobHandle solved = jobs.create([] {});
+    Spill spill;
+
+    size_t width = nCols * 3;
+    std::vector<Color> band(ImageStream::BAND_ROWS * width); // the only pixels held at once
+    for (size_t r = 0; stream.nextBand(band.data()); r++) { // per band of cubes
+        for (size_t first = 0; first < nCols; first += TILES_PER_JOB) { // per run of columns
+            size_t n = std::min(TILES_PER_JOB, nCols - first);
+            std::array<Color, 9 * TILES_PER_JOB> patterns;
+            for (size_t t = 0; t < n; t++) {
+                size_t c = (first + t) * 3;
+                for (size_t y = 0; y < 3; y++)
+                    for (size_t x = 0; x < 3; x++)
+                        patterns[t * 9 + y * 3 + x] = band[y * width + c + x];
+            }
+            size_t i = r * nCols + first;
+            Spill* spilled = &spill;
+            jobs.run(jobs.create([this, i, n, spilled, patterns]() mutable {
+                for (size_t t = 0; t < n; t++)
+                    planTile(i + t, &patterns[t * 9], *spilled);
+            }, solved));
         }
     }
+    jobs.run(solved);
+    jobs.wait(solved);
+    queueSpill(spill);
+}
 
-    // release memory
-    delete[] pixels;
+void Grid::planTile(size_t index, Color pattern[9], Spill& spill) {
+    AI ai(cubes.states[index].stickers);
+    ai.calculatePaint(pattern);
+    const std::pmr::vector<Move>& moves = ai.getInstructions();
+    if (!cubes.pushInPlace(index, moves.data(), moves.size())) {
+        std::lock_guard<std::mutex> lock(spill.mutex);
+        spill.plans.emplace_back(index, std::vector<Move>(moves.begin(), moves.end()));
+    }
+}
+
+void Grid::queueSpill(const Spill& spill) {
+    for (const std::pair<size_t, std::vector<Move>>& plan : spill.plans)
+        cubes.push(plan.first, plan.second.data(), plan.second.size());
 }
 
 void Grid::selectRelative(unsigned int dx, unsigned int dy) {
     // if none are selected, select first cube and return
     bool foundSelected = false;
-    for (std::shared_ptr<Cube> c : cubes) {
-        if (c->isSelected()) {
+    for (size_t i = 0; i < cubes.size(); i++) {
+        if (cubes.selected[i]) {
             foundSelected = true;
             break;
         }
@@ -116,13 +185,13 @@ void Grid::selectRelative(unsigned int dx, unsigned int dy) {
 
     for (int r = 0; r < nRows; r++) {
         for (int c = 0; c < nCols; c++) {
-            if (cubes[r * nCols + c]->isSelected()) {
+            if (cubes.selected[r * nCols + c]) {
                 int newIndex = r * nCols + c + dx + dy * nCols; // index of newly selected cube
                 if (newIndex >= 0 && newIndex < cubes.size()) { // if bounds check
                     // deselect old cube
-                    cubes[r * nCols + c]->deselect();
+                    cubes[r * nCols + c].deselect();
                     // select new cube
-                    cubes[newIndex]->select();
+                    cubes[newIndex].select();
                     return;
                 }
             }
@@ -130,11 +199,11 @@ void Grid::selectRelative(unsigned int dx, unsigned int dy) {
     }
 }
 
-std::shared_ptr<Cube> Grid::getSelected()
+CubeRef Grid::getSelected()
 {
-    for (std::shared_ptr<Cube> c : cubes) {
-        if (c->isSelected())
-            return c;
+    for (size_t i = 0; i < cubes.size(); i++) {
+        if (cubes.selected[i])
+            return cubes[i];
     }
     // if none were selected, select and return first cube
     selectAbsolute(0, 0);
@@ -142,7 +211,7 @@ std::shared_ptr<Cube> Grid::getSelected()
 }
 
 void Grid::selectAbsolute(unsigned int row, unsigned int column) {
-    cubes[row * nCols + column]->select();
+    cubes[row * nCols + column].select();
 }
 
 glm::vec3 Grid::calcCoords(unsigned int row, unsigned int column) {
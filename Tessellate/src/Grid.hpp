@@ -1,20 +1,24 @@
 #pragma once
 #include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
-#include "Cube.hpp"
+#include "CubeArena.hpp"
 #include "BMPImage.hpp"
+#include "ImageStream.hpp"
 
 class Grid {
 public:
 	size_t nRows, nCols;
-	std::vector<std::shared_ptr<Cube>> cubes;
+	CubeArena cubes; // cube r * nCols + c is at row r, column c
 public:
 	Grid(size_t rows, size_t cols);
 	
 	/* destroy all cubes and create more to fulfill size parameters */
 	void resize(size_t rows, size_t cols);
 
-	/* updates the cubes' animations when supplied with deltatime */
+	/* updates the cubes' animations when supplied with deltatime, in one pass over the arena */
 	void update(float deltatime);
 
 	/* reset all cubes and queues to their original states */
@@ -23,18 +27,37 @@ public:
 	/** solve grid for supplied image
 	* 
 	*/
-	void solveImage(BMPImage& bmp);
+	void solveImage(BMPImage& bmp, const ColorQuantizer& quantizer);
+
+	/* solve grid for an image that is already mapped to sticker colors. pixels holds width * height colors, row-major */
+	void solveImage(const Color pixels[], size_t width, size_t height);
+
+	/* solve grid for a streamed image, one band of cubes at a time as soon as it is decoded */
+	void solveImage(ImageStream& stream);
 
 	/* selecs a cube orthagonal to the current selection. does nothing if no cubes are selected or grid bounds are hit */
 	void selectRelative(unsigned int dx, unsigned int dy);
 
 	/* return the selected cube, or the first if none */
-	std::shared_ptr<Cube> getSelected();
+	CubeRef getSelected();
 	
 	/* deselects all cubes in grid */
 	void selectAbsolute(unsigned int row, unsigned int column);
 
 private:
+	/* plans too long for their cube's segment of the pool, queued once the parallel planning is done. Rare: see AI::PLAN_SLOT */
+	struct Spill {
+		std::mutex mutex;
+		std::vector<std::pair<size_t, std::vector<Move>>> plans;
+	};
+
+	/* plans the moves that paint pattern on the UP face of cube index, from its current state, and writes them into its segment
+	   of the pool (see CubeArena::reserveQueues), or into spill if they do not fit. Touches no other cube, so tiles can be planned in parallel */
+	void planTile(size_t index, Color pattern[9], Spill& spill);
+
+	/* queues the plans that spilled over on their cubes */
+	void queueSpill(const Spill& spill);
+
 	/* calculates the coordinates of a cube in grid */
 	glm::vec3 calcCoords(unsigned int row, unsigned int column);
 };
\ No newline at end of file
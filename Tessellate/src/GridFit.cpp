@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "GridFit.hpp"
+
+namespace {
+	/* how many cubes the image covers on a rows x cols grid once its aspect ratio is kept:
+	   cropping hides, and letterboxing leaves empty, the fraction by which the aspect ratios differ */
+	double coveredCubes(size_t rows, size_t cols, double aspect) {
+		double ratio = static_cast<double>(cols) / rows / aspect;
+		return rows * cols * std::min(ratio, 1 / ratio);
+	}
+}
+
+bool parseFitMode(const char* name, FitMode& mode) {
+	static const FitMode MODES[3] = { FitMode::STRETCH, FitMode::CROP, FitMode::LETTERBOX };
+	for (FitMode m : MODES) {
+		if (strcmp(name, getFitModeName(m)) == 0) {
+			mode = m;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char* getFitModeName(FitMode mode) {
+	switch (mode) {
+	case FitMode::STRETCH:
+		return "stretch";
+	case FitMode::CROP:
+		return "crop";
+	case FitMode::LETTERBOX:
+		return "letterbox";
+	}
+	return "unknown";
+}
+
+GridFit GridFit::forSize(size_t srcWidth, size_t srcHeight, size_t rows, size_t cols, FitMode mode) {
+	if (srcWidth == 0 || srcHeight == 0 || rows == 0 || cols == 0)
+		throw std::invalid_argument("cannot fit an empty image or grid");
+
+	size_t outWidth = cols * 3;
+	size_t outHeight = rows * 3;
+	double scaleX = static_cast<double>(outWidth) / srcWidth;
+	double scaleY = static_cast<double>(outHeight) / srcHeight;
+
+	GridFit fit = { rows, cols, 0, 0, static_cast<double>(srcWidth), static_cast<double>(srcHeight), 0, 0, outWidth, outHeight };
+	if (mode == FitMode::CROP) { // the larger scale fills the grid; center the part that fits
+		double scale = std::max(scaleX, scaleY);
+		fit.srcWidth = std::min(outWidth / scale, static_cast<double>(srcWidth));
+		fit.srcHeight = std::min(outHeight / scale, static_cast<double>(srcHeight));
+		fit.srcX = (srcWidth - fit.srcWidth) / 2;
+		fit.srcY = (srcHeight - fit.srcHeight) / 2;
+	} else if (mode == FitMode::LETTERBOX) { // the smaller scale fits the whole image; center it
+		double scale = std::min(scaleX, scaleY);
+		fit.dstWidth = std::min(outWidth, std::max<size_t>(1, static_cast<size_t>(std::round(srcWidth * scale))));
+		fit.dstHeight = std::min(outHeight, std::max<size_t>(1, static_cast<size_t>(std::round(srcHeight * scale))));
+		fit.dstX = (outWidth - fit.dstWidth) / 2;
+		fit.dstY = (outHeight - fit.dstHeight) / 2;
+	}
+	return fit;
+}
+
+GridFit GridFit::forBudget(size_t srcWidth, size_t srcHeight, size_t maxCubes, FitMode mode) {
+	if (srcWidth == 0 || srcHeight == 0 || maxCubes == 0)
+		throw std::invalid_argument("cannot fit an empty image or grid");
+
+	double aspect = static_cast<double>(srcWidth) / srcHeight; // of the grid in cubes, too, since cubes are square
+	size_t bestRows = 1, bestCols = 1;
+	for (size_t rows = 1; rows <= maxCubes; rows++) {
+		// the column counts on either side of the ideal one, within the budget
+		double ideal = rows * aspect;
+		size_t candidates[2] = { static_cast<size_t>(std::floor(ideal)), static_cast<size_t>(std::ceil(ideal)) };
+		for (size_t cols : candidates) {
+			cols = std::min(std::max<size_t>(cols, 1), maxCubes / rows);
+			if (cols > 0 && coveredCubes(rows, cols, aspect) > coveredCubes(bestRows, bestCols, aspect)) {
+				bestRows = rows;
+				bestCols = cols;
+			}
+		}
+	}
+	return forSize(srcWidth, srcHeight, bestRows, bestCols, mode);
+}
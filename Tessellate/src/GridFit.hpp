@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+/* what happens when the image and the grid have different aspect ratios */
+enum class FitMode {
+	STRETCH, // scale each axis independently
+	CROP, // fill the grid and cut off the overhanging edges
+	LETTERBOX // fit the whole image and fill the bars with white stickers
+};
+
+/* parses "stretch", "crop" or "letterbox". Returns false for anything else */
+bool parseFitMode(const char* name, FitMode& mode);
+
+const char* getFitModeName(FitMode mode);
+
+/* How a source image maps onto a grid of cubes: which part of the source is used and where it lands among the 3*rows x 3*cols stickers */
+struct GridFit {
+	size_t rows, cols; // in cubes
+	/* the part of the source that is used, in source pixels */
+	double srcX, srcY, srcWidth, srcHeight;
+	/* where that part lands, in stickers. Stickers outside it are filled */
+	size_t dstX, dstY, dstWidth, dstHeight;
+
+	/* fits the image to exactly rows x cols cubes */
+	static GridFit forSize(size_t srcWidth, size_t srcHeight, size_t rows, size_t cols, FitMode mode);
+
+	/* picks the grid of at most maxCubes cubes on which the image, with its aspect ratio kept, covers the most cubes. Then fits the image to it */
+	static GridFit forBudget(size_t srcWidth, size_t srcHeight, size_t maxCubes, FitMode mode);
+};
@@ -0,0 +1,228 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "GridSnapshot.hpp"
+#include "Grid.hpp"
+#include "MappedFile.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+	const char* const MAGIC = "TSNP";
+	const size_t HEADER_BYTES = 4 + 3 * 4 + 8 + 2 * 4;
+	const size_t CAMERA_BYTES = 4 * 12 + 2 * 4 + 4 + 64;
+	/* bytes of every cube, its show cursor aside */
+	const size_t CUBE_BYTES = 54 + 12 + 4 + 4 + 1 + 4;
+
+	// the columns are copied between the arena and the file as they are
+	static_assert(sizeof(CubeState) == 54, "a cube state must be its 54 stickers");
+	static_assert(sizeof(glm::vec3) == 12 && sizeof(glm::mat4) == 64, "glm vectors must be packed floats");
+	static_assert(sizeof(Move) == 1 && sizeof(Color) == 1, "moves and colors must be one byte");
+
+	bool isLittleEndian() {
+		uint32_t one = 1;
+		unsigned char first;
+		memcpy(&first, &one, 1);
+		return first == 1;
+	}
+
+	void put(unsigned char*& out, const void* data, size_t n) {
+		if (n > 0)
+			memcpy(out, data, n);
+		out += n;
+	}
+
+	void putU32(unsigned char*& out, uint32_t v) {
+		for (int i = 0; i < 4; i++)
+			*out++ = (v >> (8 * i)) & 0xFF;
+	}
+
+	void putU64(unsigned char*& out, uint64_t v) {
+		for (int i = 0; i < 8; i++)
+			*out++ = (v >> (8 * i)) & 0xFF;
+	}
+
+	void get(const unsigned char*& in, void* data, size_t n) {
+		memcpy(data, in, n);
+		in += n;
+	}
+
+	uint32_t getU32(const unsigned char* in) {
+		return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+	}
+
+	uint64_t getU64(const unsigned char* in) {
+		return getU32(in) | (static_cast<uint64_t>(getU32(in + 4)) << 32);
+	}
+}
+
+void GridSnapshot::save(const char* filepath, const Grid& grid, const CameraState* camera, const ChoreographyPlayer* show) {
+	if (!isLittleEndian())
+		throw std::runtime_error("snapshots can only be saved on little-endian machines");
+	const CubeArena& cubes = grid.cubes;
+	size_t n = cubes.size();
+	ShowPosition position;
+	if (show) {
+		position = show->getPosition();
+		if (position.cursors.size() != n) // the grid was resized under the show
+			show = nullptr;
+	}
+	uint64_t nQueued = 0;
+	for (size_t i = 0; i < n; i++)
+		nQueued += cubes.queueEnd[i] - cubes.queueFront[i];
+
+	// everything is packed into one buffer first, so the file is written in one go
+	std::vector<unsigned char> content(HEADER_BYTES + (camera ? CAMERA_BYTES : 0) + (show ? position.path.size() + 8 : 0)
+		+ n * (CUBE_BYTES + (show ? 8 : 0)) + nQueued);
+	unsigned char* out = content.data();
+	put(out, MAGIC, 4);
+	putU32(out, VERSION);
+	putU32(out, static_cast<uint32_t>(grid.nRows));
+	putU32(out, static_cast<uint32_t>(grid.nCols));
+	putU64(out, nQueued);
+	putU32(out, (camera ? HAS_CAMERA : 0) | (show ? HAS_SHOW : 0));
+	putU32(out, show ? static_cast<uint32_t>(position.path.size()) : 0);
+	if (camera) {
+		put(out, &camera->defaultEyePosition, 12);
+		put(out, &camera->eyePosition, 12);
+		put(out, &camera->refPosition, 12);
+		put(out, &camera->up, 12);
+		put(out, &camera->vyaw, 4);
+		put(out, &camera->vpitch, 4);
+		putU32(out, camera->focusMode ? 1 : 0);
+		put(out, &camera->view, 64);
+	}
+	if (show) {
+		put(out, position.path.data(), position.path.size());
+		putU64(out, position.nFed);
+	}
+
+	put(out, cubes.states.data(), n * sizeof(CubeState));
+	put(out, cubes.positions.data(), n * sizeof(glm::vec3));
+	put(out, cubes.turnProgress.data(), n * sizeof(float));
+	put(out, cubes.solveSpeeds.data(), n * sizeof(float));
+	put(out, cubes.selected.data(), n);
+	for (size_t i = 0; i < n; i++)
+		putU32(out, cubes.queueEnd[i] - cubes.queueFront[i]);
+	if (show)
+		put(out, position.cursors.data(), n * sizeof(uint64_t));
+	for (size_t i = 0; i < n; i++) // the pending part of every queue, without the gaps between segments
+		put(out, cubes.movePool.data() + cubes.queueFront[i], cubes.queueEnd[i] - cubes.queueFront[i]);
+
+	// written under a name of its own, then renamed over the last snapshot, so a crash while saving leaves that one whole
+	std::string temporary = std::string(filepath) + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		if (!file)
+			throw std::runtime_error("cannot open " + temporary + " for writing");
+		file.write(reinterpret_cast<const char*>(content.data()), content.size());
+		if (!file)
+			throw std::runtime_error("cannot write " + temporary);
+	}
+	std::error_code error;
+	fs::rename(temporary, filepath, error);
+	if (error) {
+		fs::remove(temporary, error);
+		throw std::runtime_error(std::string("cannot write ") + filepath);
+	}
+}
+
+uint32_t GridSnapshot::load(const char* filepath, Grid& grid, CameraState& camera, ShowPosition& show) {
+	if (!isLittleEndian())
+		throw std::runtime_error("snapshots can only be loaded on little-endian machines");
+	MappedFile file(filepath);
+	const unsigned char* data = file.getData();
+	size_t size = file.getSize();
+	std::string name(filepath);
+	if (size < HEADER_BYTES || memcmp(data, MAGIC, 4) != 0)
+		throw std::runtime_error(name + " is not a grid snapshot");
+	if (getU32(data + 4) != VERSION)
+		throw std::runtime_error(name + " is a snapshot of another version");
+	size_t rows = getU32(data + 8);
+	size_t cols = getU32(data + 12);
+	uint64_t nQueued = getU64(data + 16);
+	uint32_t flags = getU32(data + 24);
+	size_t pathBytes = getU32(data + 28);
+
+	// checked one step at a time, so a corrupt header cannot overflow the sums
+	size_t n = rows * cols;
+	size_t fixed = HEADER_BYTES + (flags & HAS_CAMERA ? CAMERA_BYTES : 0) + (flags & HAS_SHOW ? 8 : 0);
+	size_t perCube = CUBE_BYTES + (flags & HAS_SHOW ? 8 : 0);
+	if (rows == 0 || cols == 0 || n / cols != rows || size < fixed || pathBytes > size - fixed
+		|| n > (size - fixed - pathBytes) / perCube || nQueued != size - fixed - pathBytes - n * perCube)
+		throw std::runtime_error(name + " is truncated");
+
+	const unsigned char* in = data + HEADER_BYTES;
+	CameraState savedCamera{};
+	if (flags & HAS_CAMERA) {
+		get(in, &savedCamera.defaultEyePosition, 12);
+		get(in, &savedCamera.eyePosition, 12);
+		get(in, &savedCamera.refPosition, 12);
+		get(in, &savedCamera.up, 12);
+		get(in, &savedCamera.vyaw, 4);
+		get(in, &savedCamera.vpitch, 4);
+		savedCamera.focusMode = getU32(in) != 0;
+		in += 4;
+		get(in, &savedCamera.view, 64);
+	}
+	ShowPosition savedShow{};
+	if (flags & HAS_SHOW) {
+		savedShow.path.assign(reinterpret_cast<const char*>(in), pathBytes);
+		in += pathBytes;
+		savedShow.nFed = getU64(in);
+		in += 8;
+	}
+	const unsigned char* stickers = in;
+	const unsigned char* positions = stickers + n * sizeof(CubeState);
+	const unsigned char* turnProgress = positions + n * sizeof(glm::vec3);
+	const unsigned char* solveSpeeds = turnProgress + n * sizeof(float);
+	const unsigned char* selected = solveSpeeds + n * sizeof(float);
+	const unsigned char* lengths = selected + n;
+	const unsigned char* cursors = lengths + n * sizeof(uint32_t);
+	const unsigned char* moves = cursors + (flags & HAS_SHOW ? n * sizeof(uint64_t) : 0);
+
+	// every byte that becomes an enum must be one of its values, and the queues must add up to the moves stored
+	for (size_t i = 0; i < n * sizeof(CubeState); i++)
+		if (stickers[i] > static_cast<unsigned char>(Color::WHITE))
+			throw std::runtime_error(name + " has a sticker of no color");
+	uint64_t nCounted = 0;
+	for (size_t i = 0; i < n; i++) {
+		if (selected[i] > 1)
+			throw std::runtime_error(name + " is corrupt");
+		nCounted += getU32(lengths + i * sizeof(uint32_t));
+	}
+	if (nCounted != nQueued)
+		throw std::runtime_error(name + " is corrupt");
+	for (uint64_t i = 0; i < nQueued; i++)
+		if (moves[i] >= N_MOVES)
+			throw std::runtime_error(name + " has a move that does not exist");
+
+	// import every column in one copy
+	CubeArena& cubes = grid.cubes;
+	grid.nRows = rows;
+	grid.nCols = cols;
+	cubes.resize(n);
+	memcpy(cubes.states.data(), stickers, n * sizeof(CubeState));
+	memcpy(cubes.positions.data(), positions, n * sizeof(glm::vec3));
+	memcpy(cubes.turnProgress.data(), turnProgress, n * sizeof(float));
+	memcpy(cubes.solveSpeeds.data(), solveSpeeds, n * sizeof(float));
+	memcpy(cubes.selected.data(), selected, n);
+	std::vector<uint32_t> queueLengths(n);
+	memcpy(queueLengths.data(), lengths, n * sizeof(uint32_t));
+	cubes.setQueues(queueLengths.data(), reinterpret_cast<const Move*>(moves), nQueued);
+	cubes.notifyResize(rows, cols); // recordings and histories start over from the restored grid
+
+	if (flags & HAS_CAMERA)
+		camera = savedCamera;
+	if (flags & HAS_SHOW) {
+		savedShow.cursors.resize(n);
+		memcpy(savedShow.cursors.data(), cursors, n * sizeof(uint64_t));
+		show = std::move(savedShow);
+	}
+	return flags & (HAS_CAMERA | HAS_SHOW);
+}
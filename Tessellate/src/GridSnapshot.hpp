@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+#include "CameraState.hpp"
+#include "ChoreographyPlayer.hpp"
+
+class Grid;
+
+/* The whole state of a grid in one file, so a show can be put back exactly as it was after a restart.
+   Saving packs everything into one buffer and writes it in one go, to a temporary name that is then renamed over the old snapshot.
+   Loading maps the file and copies each column straight into the arena. Layout:
+	"TSNP", uint32 version, uint32 rows, uint32 cols, uint64 queued moves, uint32 flags, uint32 show path bytes
+	with HAS_CAMERA: 4 * 3 floats eye default, eye, target and up, float yaw and pitch speed, uint32 focus mode, 16 floats view matrix
+	with HAS_SHOW: the show's path, uint64 moves fed
+	per cube, one column after the other: 54 sticker bytes | 3 float position | float turn progress | float solve speed |
+		selected byte | uint32 queued moves | with HAS_SHOW, uint64 show cursor
+	every queued move, one byte each, cube after cube
+   Numbers are little-endian and floats are IEEE 754 singles, copied as they lie in memory */
+class GridSnapshot {
+public:
+	static const uint32_t VERSION = 1;
+
+	/* flags: what else was saved with the grid */
+	static const uint32_t HAS_CAMERA = 1;
+	static const uint32_t HAS_SHOW = 2;
+
+	/* writes grid to filepath, with camera and the position of show if they are given. throws std::runtime_error if it cannot be written */
+	static void save(const char* filepath, const Grid& grid, const CameraState* camera = nullptr, const ChoreographyPlayer* show = nullptr);
+
+	/* replaces grid with the one saved in filepath and tells the grid's observers, as a resize would.
+	   The camera and show position are written to camera and show if they were saved, and the flags say which were.
+	   throws std::runtime_error, leaving grid as it was, if filepath is not a snapshot */
+	static uint32_t load(const char* filepath, Grid& grid, CameraState& camera, ShowPosition& show);
+};
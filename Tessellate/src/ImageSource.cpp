@@ -0,0 +1,28 @@
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "ImageSource.hpp"
+#include "BMPImage.hpp"
+#include "PNGImage.hpp"
+#include "PNMImage.hpp"
+#include "TGAImage.hpp"
+
+std::unique_ptr<ImageSource> ImageSource::open(const char* const filepath) {
+	unsigned char magic[8] = {};
+	FILE* file = fopen(filepath, "rb");
+	if (!file)
+		throw std::runtime_error(std::string("cannot open file ") + filepath);
+	size_t nRead = fread(magic, 1, sizeof(magic), file);
+	fclose(file);
+
+	if (nRead >= 8 && memcmp(magic, PNGImage::SIGNATURE, 8) == 0)
+		return std::unique_ptr<ImageSource>(new PNGImage(filepath));
+	if (nRead >= 2 && magic[0] == 'B' && magic[1] == 'M')
+		return std::unique_ptr<ImageSource>(new BMPImage(filepath));
+	if (nRead >= 2 && magic[0] == 'P' && (magic[1] == '5' || magic[1] == '6'))
+		return std::unique_ptr<ImageSource>(new PNMImage(filepath));
+	// TGA has no magic number. Anything else is tried as one, and rejected by its header checks
+	return std::unique_ptr<ImageSource>(new TGAImage(filepath));
+}
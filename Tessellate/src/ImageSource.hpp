@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+/* Anything the image pipeline can read pixels from, one row at a time */
+class ImageSource {
+public:
+	virtual ~ImageSource() {}
+
+	virtual size_t getWidth() const = 0;
+	virtual size_t getHeight() const = 0;
+
+	/* writes 3 bytes (r, g, b) for every pixel of one row, counted from the top */
+	virtual void getRGBRow(size_t row, unsigned char output[]) const = 0;
+
+	/* opens a BMP, PNG, PPM/PGM or TGA image, chosen by the magic bytes at the start of the file rather than its extension.
+	   throws std::runtime_error if the file cannot be read or its format is unsupported */
+	static std::unique_ptr<ImageSource> open(const char* const filepath);
+};
@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "ImageStream.hpp"
+#include "RGBImage.hpp"
+
+namespace {
+	/* letterbox bars are white */
+	const float FILL = 255.0f;
+}
+
+ImageStream::ImageStream(const ImageSource& source, size_t rows, size_t cols, const ColorQuantizer& quantizer, DitherMode mode)
+	: ImageStream(source, GridFit::forSize(source.getWidth(), source.getHeight(), rows, cols, FitMode::STRETCH), quantizer, mode) {}
+
+ImageStream::ImageStream(const ImageSource& source, const GridFit& fit, const ColorQuantizer& quantizer, DitherMode mode)
+	: source(source), fit(fit),
+	horizontal(source.getWidth(), fit.dstWidth, fit.srcX, fit.srcWidth), vertical(source.getHeight(), fit.dstHeight, fit.srcY, fit.srcHeight),
+	mode(mode), diffuser(fit.cols * 3, quantizer), ditherer(mode == DitherMode::ERROR_DIFFUSION ? DitherMode::BAYER4 : mode, quantizer),
+	sourceRGB(source.getWidth() * 3), sourceRow(source.getWidth() * RGBImage::CHANNELS, 0.0f),
+	narrowRow(fit.dstWidth * RGBImage::CHANNELS), narrowIndex(SIZE_MAX),
+	outputRow(fit.cols * 3 * RGBImage::CHANNELS), fillRow(fit.cols * 3 * RGBImage::CHANNELS, FILL), nextRow(0) {}
+
+size_t ImageStream::getRows() const {
+	return fit.rows;
+}
+
+size_t ImageStream::getCols() const {
+	return fit.cols;
+}
+
+bool ImageStream::nextBand(Color band[]) {
+	if (nextRow >= fit.rows * BAND_ROWS)
+		return false;
+
+	size_t width = fit.cols * 3;
+	for (size_t i = 0; i < BAND_ROWS; i++, nextRow++) {
+		// start from the fill so letterbox bars need no special case
+		outputRow = fillRow;
+		if (nextRow >= fit.dstY && nextRow < fit.dstY + fit.dstHeight) {
+			// average the source rows under this output row into the image's columns
+			float* content = outputRow.data() + fit.dstX * RGBImage::CHANNELS;
+			std::fill(content, content + narrowRow.size(), 0.0f);
+			size_t row = nextRow - fit.dstY;
+			for (const AreaResampler::Tap* t = vertical.tapsBegin(row); t != vertical.tapsEnd(row); t++) {
+				readSourceRow(t->index);
+				AreaResampler::addScaled(narrowRow.data(), t->weight, content, narrowRow.size());
+			}
+		}
+		if (mode == DitherMode::ERROR_DIFFUSION)
+			diffuser.ditherRow(outputRow.data(), band + i * width);
+		else
+			ditherer.ditherRow(outputRow.data(), width, nextRow, band + i * width);
+	}
+	return true;
+}
+
+void ImageStream::readSourceRow(size_t index) {
+	// rows on a boundary between two output rows are needed by both
+	if (index == narrowIndex)
+		return;
+
+	source.getRGBRow(index, sourceRGB.data());
+	for (size_t x = 0; x < source.getWidth(); x++)
+		for (size_t c = 0; c < 3; c++)
+			sourceRow[x * RGBImage::CHANNELS + c] = sourceRGB[x * 3 + c];
+	horizontal.resampleRow(sourceRow.data(), narrowRow.data());
+	narrowIndex = index;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+#include "ImageSource.hpp"
+#include "AreaResampler.hpp"
+#include "ErrorDiffuser.hpp"
+#include "ThresholdDitherer.hpp"
+#include "GridFit.hpp"
+
+/* Converts an image to sticker colors one band of cubes (3 rows of stickers) at a time.
+   Source rows are read only when a band needs them, then downsampled, dithered and quantized,
+   so peak memory is proportional to the image width rather than its area. */
+class ImageStream {
+public:
+	static const size_t BAND_ROWS = 3;
+private:
+	const ImageSource& source; // must outlive the stream
+	GridFit fit;
+	AreaResampler horizontal, vertical;
+	DitherMode mode;
+	ErrorDiffuser diffuser; // used for DitherMode::ERROR_DIFFUSION
+	ThresholdDitherer ditherer; // used for every other mode
+	std::vector<unsigned char> sourceRGB; // one source row as read
+	std::vector<float> sourceRow; // the same row as floats
+	std::vector<float> narrowRow; // the last source row read, resampled to the output width
+	size_t narrowIndex; // which source row narrowRow holds
+	std::vector<float> outputRow; // the output row being accumulated
+	std::vector<float> fillRow; // an output row of letterbox fill
+	size_t nextRow; // next output row
+public:
+	/* scales source to rows x cols cubes. quantizer must outlive the stream */
+	ImageStream(const ImageSource& source, size_t rows, size_t cols, const ColorQuantizer& quantizer, DitherMode mode = DitherMode::ERROR_DIFFUSION);
+
+	/* crops or letterboxes source as described by fit */
+	ImageStream(const ImageSource& source, const GridFit& fit, const ColorQuantizer& quantizer, DitherMode mode = DitherMode::ERROR_DIFFUSION);
+
+	size_t getRows() const;
+	size_t getCols() const;
+
+	/* writes the next band of BAND_ROWS rows of 3 * cols stickers, row-major. Returns false once every band was emitted */
+	bool nextBand(Color band[]);
+
+private:
+	/* reads a source row into narrowRow unless it is already there */
+	void readSourceRow(size_t index);
+};
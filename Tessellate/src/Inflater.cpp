@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "Inflater.hpp"
+
+namespace {
+	const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	/* order in which the code lengths of the code length alphabet are stored */
+	const uint8_t CODE_LENGTH_ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	unsigned int reverseBits(unsigned int code, unsigned int length) {
+		unsigned int reversed = 0;
+		for (unsigned int i = 0; i < length; i++, code >>= 1)
+			reversed = (reversed << 1) | (code & 1);
+		return reversed;
+	}
+
+	void corrupt(const char* reason) {
+		throw std::runtime_error(std::string("corrupt deflate stream: ") + reason);
+	}
+}
+
+bool Inflater::Huffman::build(const uint8_t codeLengths[], size_t nSymbols) {
+	unsigned int counts[16] = {};
+	for (size_t i = 0; i < nSymbols; i++)
+		counts[codeLengths[i]]++;
+	counts[0] = 0;
+	memset(fast, 0, sizeof(fast));
+
+	unsigned int nextCode[16];
+	unsigned int code = 0, symbol = 0;
+	for (unsigned int length = 1; length < 16; length++) {
+		nextCode[length] = code;
+		firstCode[length] = static_cast<uint16_t>(code);
+		firstSymbol[length] = static_cast<uint16_t>(symbol);
+		code += counts[length];
+		if (counts[length] && code - 1 >= (1u << length))
+			return false; // oversubscribed
+		maxCode[length] = code << (16 - length);
+		code <<= 1;
+		symbol += counts[length];
+	}
+	maxCode[16] = 0x10000;
+
+	for (size_t i = 0; i < nSymbols; i++) {
+		unsigned int length = codeLengths[i];
+		if (!length)
+			continue;
+		unsigned int index = nextCode[length] - firstCode[length] + firstSymbol[length];
+		lengths[index] = static_cast<uint8_t>(length);
+		values[index] = static_cast<uint16_t>(i);
+		if (length <= FAST_BITS) {
+			// every FAST_BITS-bit pattern that starts with this code
+			for (unsigned int j = reverseBits(nextCode[length], length); j < (1u << FAST_BITS); j += 1u << length)
+				fast[j] = static_cast<uint16_t>(length << 9 | i);
+		}
+		nextCode[length]++;
+	}
+	return true;
+}
+
+Inflater::Inflater(const unsigned char input[], size_t inputSize, unsigned char output[], size_t outputSize)
+	: in(input), inEnd(input + inputSize), bitBuffer(0), bitCount(0), overrun(0), outBegin(output), out(output), outEnd(output + outputSize) {
+}
+
+void Inflater::inflateZlib(const unsigned char input[], size_t inputSize, unsigned char output[], size_t outputSize) {
+	if (inputSize < 2)
+		corrupt("missing zlib header");
+	unsigned int cmf = input[0], flags = input[1];
+	if ((cmf & 0x0F) != 8 || (cmf << 8 | flags) % 31 != 0)
+		corrupt("invalid zlib header");
+	if (flags & 0x20)
+		corrupt("preset dictionaries are not supported");
+
+	// PNG decoding skips the CRCs of the chunks, so the trailer is what catches a corrupted stream
+	Inflater inflater(input + 2, inputSize - 2, output, outputSize);
+	inflater.run();
+	inflater.checkTrailer();
+}
+
+void Inflater::run() {
+	bool finalBlock = false;
+	while (!finalBlock) {
+		refill();
+		finalBlock = getBits(1) != 0;
+		switch (getBits(2)) {
+		case 0:
+			storedBlock();
+			break;
+		case 1: {
+			// the fixed codes of RFC 1951 3.2.6
+			static Huffman fixedLiterals, fixedDistances;
+			static bool fixedBuilt = [] {
+				uint8_t lengths[MAX_SYMBOLS];
+				memset(lengths, 8, 144);
+				memset(lengths + 144, 9, 112);
+				memset(lengths + 256, 7, 24);
+				memset(lengths + 280, 8, 8);
+				fixedLiterals.build(lengths, 288);
+				memset(lengths, 5, 30);
+				fixedDistances.build(lengths, 30);
+				return true;
+			}();
+			(void)fixedBuilt;
+			compressedBlock(fixedLiterals, fixedDistances);
+			break;
+		}
+		case 2:
+			readDynamicCodes();
+			compressedBlock(literals, distances);
+			break;
+		default:
+			corrupt("invalid block type");
+		}
+	}
+	if (out != outEnd)
+		corrupt("stream ended before the image was complete");
+}
+
+void Inflater::checkTrailer() {
+	getBits(bitCount & 7);
+	uint32_t expected = 0;
+	for (int i = 0; i < 4; i++)
+		expected = expected << 8 | getBits(8);
+	// the zero padding refill adds past the end of the input sits at the top of the bit buffer
+	if (overrun * 8 > bitCount)
+		corrupt("missing Adler-32 checksum");
+
+	// sums are reduced every 5552 bytes, the most that cannot overflow 32 bits
+	uint32_t a = 1, b = 0;
+	for (const unsigned char* p = outBegin; p < outEnd;) {
+		const unsigned char* chunkEnd = p + std::min<size_t>(outEnd - p, 5552);
+		for (; p < chunkEnd; p++) {
+			a += *p;
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+	if ((b << 16 | a) != expected)
+		corrupt("Adler-32 checksum mismatch");
+}
+
+void Inflater::refill() {
+	while (bitCount <= 56) {
+		if (in < inEnd) {
+			bitBuffer |= static_cast<uint64_t>(*in++) << bitCount;
+		} else {
+			// pad with zeros. Reading far past the end can only mean corrupt data
+			if (++overrun > 16)
+				corrupt("unexpected end of data");
+		}
+		bitCount += 8;
+	}
+}
+
+unsigned int Inflater::getBits(unsigned int n) {
+	if (bitCount < n)
+		refill();
+	unsigned int value = static_cast<unsigned int>(bitBuffer & ((1ull << n) - 1));
+	bitBuffer >>= n;
+	bitCount -= n;
+	return value;
+}
+
+unsigned int Inflater::decode(const Huffman& code) {
+	if (bitCount < 16)
+		refill();
+	unsigned int entry = code.fast[bitBuffer & ((1u << FAST_BITS) - 1)];
+	unsigned int length;
+	if (entry) {
+		length = entry >> 9;
+		bitBuffer >>= length;
+		bitCount -= length;
+		return entry & 511;
+	}
+
+	// longer codes are found by comparing against the canonical limits of each length
+	unsigned int k = reverseBits(static_cast<unsigned int>(bitBuffer & 0xFFFF), 16);
+	for (length = FAST_BITS + 1; k >= code.maxCode[length]; length++)
+		;
+	if (length >= 16)
+		corrupt("invalid Huffman code");
+	unsigned int index = (k >> (16 - length)) - code.firstCode[length] + code.firstSymbol[length];
+	if (index >= MAX_SYMBOLS || code.lengths[index] != length)
+		corrupt("invalid Huffman code");
+	bitBuffer >>= length;
+	bitCount -= length;
+	return code.values[index];
+}
+
+void Inflater::storedBlock() {
+	// skip to a byte boundary, then read LEN and NLEN
+	getBits(bitCount & 7);
+	unsigned int length = getBits(16);
+	unsigned int complement = getBits(16);
+	if ((length ^ 0xFFFF) != complement)
+		corrupt("stored block length mismatch");
+	if (length > static_cast<size_t>(outEnd - out))
+		corrupt("data overruns the output");
+
+	// drain whole bytes still in the bit buffer, then copy straight from the input
+	while (length > 0 && bitCount >= 8) {
+		*out++ = static_cast<unsigned char>(getBits(8));
+		length--;
+	}
+	if (length > static_cast<size_t>(inEnd - in))
+		corrupt("unexpected end of data");
+	memcpy(out, in, length);
+	out += length;
+	in += length;
+}
+
+void Inflater::readDynamicCodes() {
+	size_t nLiterals = getBits(5) + 257;
+	size_t nDistances = getBits(5) + 1;
+	size_t nCodeLengths = getBits(4) + 4;
+
+	uint8_t codeLengthLengths[19] = {};
+	for (size_t i = 0; i < nCodeLengths; i++) {
+		refill();
+		codeLengthLengths[CODE_LENGTH_ORDER[i]] = static_cast<uint8_t>(getBits(3));
+	}
+	Huffman codeLengthCode;
+	if (!codeLengthCode.build(codeLengthLengths, 19))
+		corrupt("invalid code length code");
+
+	// literal/length and distance code lengths form one sequence, and repeats may cross from one into the other
+	uint8_t lengths[MAX_SYMBOLS + 32];
+	size_t n = 0, total = nLiterals + nDistances;
+	while (n < total) {
+		unsigned int symbol = decode(codeLengthCode);
+		if (symbol < 16) {
+			lengths[n++] = static_cast<uint8_t>(symbol);
+			continue;
+		}
+		uint8_t fill = 0;
+		size_t repeat;
+		if (symbol == 16) {
+			if (n == 0)
+				corrupt("repeat with no previous length");
+			fill = lengths[n - 1];
+			repeat = 3 + getBits(2);
+		} else if (symbol == 17) {
+			repeat = 3 + getBits(3);
+		} else {
+			repeat = 11 + getBits(7);
+		}
+		if (repeat > total - n)
+			corrupt("code lengths overrun");
+		memset(lengths + n, fill, repeat);
+		n += repeat;
+	}
+	if (lengths[256] == 0)
+		corrupt("missing end-of-block code");
+	if (!literals.build(lengths, nLiterals) || !distances.build(lengths + nLiterals, nDistances))
+		corrupt("invalid Huffman code lengths");
+}
+
+void Inflater::compressedBlock(const Huffman& literalCode, const Huffman& distanceCode) {
+	for (;;) {
+		unsigned int symbol = decode(literalCode);
+		if (symbol < 256) {
+			if (out == outEnd)
+				corrupt("data overruns the output");
+			*out++ = static_cast<unsigned char>(symbol);
+			continue;
+		}
+		if (symbol == 256)
+			return;
+
+		symbol -= 257;
+		if (symbol >= 29)
+			corrupt("invalid length symbol");
+		refill();
+		size_t length = LENGTH_BASE[symbol] + getBits(LENGTH_EXTRA[symbol]);
+		unsigned int distanceSymbol = decode(distanceCode);
+		if (distanceSymbol >= 30)
+			corrupt("invalid distance symbol");
+		size_t distance = DISTANCE_BASE[distanceSymbol] + getBits(DISTANCE_EXTRA[distanceSymbol]);
+
+		if (distance > static_cast<size_t>(out - outBegin))
+			corrupt("distance reaches before the start of the data");
+		if (length > static_cast<size_t>(outEnd - out))
+			corrupt("data overruns the output");
+
+		const unsigned char* from = out - distance;
+		if (distance >= length) {
+			memcpy(out, from, length);
+			out += length;
+		} else if (distance == 1) {
+			memset(out, *from, length); // a run of one byte
+			out += length;
+		} else {
+			// the copy overlaps what it writes, so it repeats the last distance bytes
+			for (size_t i = 0; i < length; i++)
+				*out++ = from[i];
+		}
+	}
+}
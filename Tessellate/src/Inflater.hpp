@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* A self-contained decoder for zlib-wrapped DEFLATE streams (RFC 1950/1951), as used by PNG.
+   Huffman codes are decoded through a lookup table indexed by the next FAST_BITS bits of input */
+class Inflater {
+private:
+	static const unsigned int FAST_BITS = 10;
+	static const size_t MAX_SYMBOLS = 288;
+
+	/* a canonical Huffman code */
+	struct Huffman {
+		/* (length << 9) | symbol of every code no longer than FAST_BITS, indexed by its bit-reversed code. 0 for longer codes */
+		uint16_t fast[1 << FAST_BITS];
+		/* per code length: first canonical code, index of its first symbol in values, and the limit of codes of that length */
+		uint16_t firstCode[16], firstSymbol[16];
+		uint32_t maxCode[17];
+		/* symbols sorted by code */
+		uint8_t lengths[MAX_SYMBOLS];
+		uint16_t values[MAX_SYMBOLS];
+
+		/* builds the code from the code length of every symbol. returns false if the lengths do not form a valid code */
+		bool build(const uint8_t codeLengths[], size_t nSymbols);
+	};
+
+	const unsigned char* in;
+	const unsigned char* inEnd;
+	/* bits are consumed from the bottom of the buffer */
+	uint64_t bitBuffer;
+	unsigned int bitCount;
+	/* bytes of zero padding read past the end of the input */
+	size_t overrun;
+
+	unsigned char* outBegin;
+	unsigned char* out;
+	unsigned char* outEnd;
+
+	/* codes of the current dynamic block */
+	Huffman literals, distances;
+public:
+
+	/* decompresses a whole zlib stream into output, which must be exactly the size of the decompressed data.
+	   throws std::runtime_error if the stream is corrupt, does not fill output or fails its Adler-32 checksum */
+	static void inflateZlib(const unsigned char input[], size_t inputSize, unsigned char output[], size_t outputSize);
+
+private:
+	Inflater(const unsigned char input[], size_t inputSize, unsigned char output[], size_t outputSize);
+
+	void run();
+
+	/* reads the Adler-32 trailer after the last block and compares it with the output */
+	void checkTrailer();
+
+	/* tops the bit buffer up to at least 57 bits */
+	void refill();
+
+	unsigned int getBits(unsigned int n);
+
+	unsigned int decode(const Huffman& code);
+
+	void storedBlock();
+
+	/* reads the code lengths of a dynamic block and builds its codes */
+	void readDynamicCodes();
+
+	/* decodes literals and back-references until the end-of-block symbol */
+	void compressedBlock(const Huffman& literalCode, const Huffman& distanceCode);
+};
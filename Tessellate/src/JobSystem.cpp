@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <cstdio>
+
+#include "JobSystem.hpp"
+
+namespace {
+	/* which pool the current thread works for, and its deque there */
+	thread_local const JobSystem* currentSystem = nullptr;
+	thread_local size_t currentIndex = 0;
+}
+
+JobSystem::Job::Job(std::function<void()> work, std::shared_ptr<Job> parent)
+	: work(std::move(work)), parent(std::move(parent)), unfinished(1) {
+}
+
+bool JobSystem::Job::isFinished() const {
+	return unfinished.load(std::memory_order_acquire) == 0;
+}
+
+JobSystem::Worker::Worker()
+	: nJobs(0), nSteals(0), busyNanoseconds(0) {
+}
+
+JobSystem::JobSystem(size_t nThreads)
+	: queued(0), sleeping(0), quitting(false), lastSample(std::chrono::steady_clock::now()) {
+	if (nThreads == 0)
+		nThreads = std::max(2u, std::thread::hardware_concurrency()) - 1; // background jobs need a pool thread to run on
+
+	for (size_t i = 0; i <= nThreads; i++) // the last deque is for threads outside the pool
+		workers.emplace_back(new Worker());
+	lastBusy.assign(workers.size(), 0);
+	for (size_t i = 0; i < nThreads; i++)
+		threads.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+	quitting = true;
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wake.notify_all();
+	for (std::thread& thread : threads)
+		thread.join();
+}
+
+JobSystem& JobSystem::shared() {
+	static JobSystem pool;
+	return pool;
+}
+
+JobSystem::JobHandle JobSystem::create(std::function<void()> work, JobHandle parent) {
+	if (parent)
+		parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+	return std::make_shared<Job>(std::move(work), std::move(parent));
+}
+
+void JobSystem::run(const JobHandle& job) {
+	Worker& worker = *workers[currentWorker()];
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.jobs.push_back(job);
+	}
+	jobQueued();
+}
+
+void JobSystem::runInBackground(const JobHandle& job) {
+	{
+		std::lock_guard<std::mutex> lock(background.mutex);
+		background.jobs.push_back(job);
+	}
+	jobQueued();
+}
+
+void JobSystem::jobQueued() {
+	queued++;
+	// a sleeper either sees queued > 0 before it waits, or is already waiting when this notifies
+	if (sleeping > 0) {
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		wake.notify_one();
+	}
+}
+
+void JobSystem::wait(const JobHandle& job) {
+	size_t self = currentWorker();
+	while (!job->isFinished()) {
+		JobHandle other = find(self, false);
+		if (other)
+			execute(other, self);
+		else
+			std::this_thread::yield(); // the rest of job is running on other threads
+	}
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+	grain = std::max<size_t>(grain, 1);
+	if (count <= grain || threads.empty()) {
+		if (count > 0)
+			body(0, count);
+		return;
+	}
+
+	// every range is a child of one empty job, which finishes with the last of them
+	JobHandle root = create([] {});
+	for (size_t first = 0; first < count; first += grain) {
+		size_t last = std::min(first + grain, count);
+		run(create([&body, first, last] { body(first, last); }, root));
+	}
+	run(root);
+	wait(root);
+}
+
+size_t JobSystem::getThreadCount() const {
+	return threads.size();
+}
+
+std::vector<JobSystem::WorkerStats> JobSystem::getStats() const {
+	std::lock_guard<std::mutex> lock(statsMutex);
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double elapsed = std::chrono::duration<double, std::nano>(now - lastSample).count();
+	lastSample = now;
+
+	std::vector<WorkerStats> stats(workers.size());
+	for (size_t i = 0; i < workers.size(); i++) {
+		uint64_t busy = workers[i]->busyNanoseconds.load(std::memory_order_relaxed);
+		stats[i].jobs = workers[i]->nJobs.load(std::memory_order_relaxed);
+		stats[i].steals = workers[i]->nSteals.load(std::memory_order_relaxed);
+		stats[i].utilization = elapsed > 0 ? std::min(1.0, (busy - lastBusy[i]) / elapsed) : 0.0;
+		lastBusy[i] = busy;
+	}
+	return stats;
+}
+
+std::string JobSystem::describe() const {
+	std::vector<WorkerStats> stats = getStats();
+	std::string line = "JOBS";
+	char field[16];
+	uint64_t steals = 0;
+	for (size_t i = 0; i < stats.size(); i++) {
+		// the last entry is every thread outside the pool, mostly the main thread
+		snprintf(field, sizeof(field), i + 1 < stats.size() ? " %3.0f%%" : " | %3.0f%%", stats[i].utilization * 100.0);
+		line += field;
+		steals += stats[i].steals;
+	}
+	snprintf(field, sizeof(field), "  %llu ST", static_cast<unsigned long long>(steals));
+	return line + field;
+}
+
+void JobSystem::workerLoop(size_t index) {
+	currentSystem = this;
+	currentIndex = index;
+	while (!quitting) {
+		JobHandle job = find(index, true);
+		if (job) {
+			execute(job, index);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleeping++;
+		wake.wait(lock, [this] { return quitting || queued > 0; });
+		sleeping--;
+	}
+}
+
+size_t JobSystem::currentWorker() const {
+	return currentSystem == this ? currentIndex : workers.size() - 1;
+}
+
+JobSystem::JobHandle JobSystem::find(size_t self, bool takeBackground) {
+	if (queued == 0)
+		return nullptr;
+
+	// newest job of our own first: its data is most likely still in cache
+	{
+		Worker& own = *workers[self];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty()) {
+			JobHandle job = std::move(own.jobs.back());
+			own.jobs.pop_back();
+			queued--;
+			return job;
+		}
+	}
+
+	// then the oldest job of someone else, which tends to be the largest piece of work left
+	for (size_t i = 1; i < workers.size(); i++) {
+		Worker& victim = *workers[(self + i) % workers.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty()) {
+			JobHandle job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			queued--;
+			workers[self]->nSteals.fetch_add(1, std::memory_order_relaxed);
+			return job;
+		}
+	}
+
+	if (takeBackground) {
+		std::lock_guard<std::mutex> lock(background.mutex);
+		if (!background.jobs.empty()) {
+			JobHandle job = std::move(background.jobs.front());
+			background.jobs.pop_front();
+			queued--;
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+void JobSystem::execute(const JobHandle& job, size_t self) {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	job->work();
+	Worker& worker = *workers[self];
+	worker.busyNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+	worker.nJobs.fetch_add(1, std::memory_order_relaxed);
+	finish(job.get());
+}
+
+void JobSystem::finish(Job* job) {
+	// the last of a job and its children to finish finishes the parent
+	while (job && job->unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		job = job->parent.get();
+}
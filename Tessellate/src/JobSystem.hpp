@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* A pool of worker threads shared by every parallel part of the program, so they never oversubscribe the CPU.
+   Each worker owns a deque of jobs: it pushes and pops its own at the back, and when it runs dry it steals from the front of another's.
+   A job may have a parent, which counts as finished only once all of its children have. Threads outside the pool share one extra deque,
+   and a thread that waits for a job runs other jobs in the meantime instead of blocking */
+class JobSystem {
+public:
+	class Job {
+	private:
+		friend class JobSystem;
+		std::function<void()> work;
+		std::shared_ptr<Job> parent;
+		/* this job plus its unfinished children */
+		std::atomic<size_t> unfinished;
+	public:
+		Job(std::function<void()> work, std::shared_ptr<Job> parent);
+
+		bool isFinished() const;
+	};
+	using JobHandle = std::shared_ptr<Job>;
+
+	/* per-thread counters, read while the pool runs */
+	struct WorkerStats {
+		uint64_t jobs; // jobs run
+		uint64_t steals; // jobs taken from another thread's deque
+		double utilization; // fraction of the time since the previous sample spent running jobs
+	};
+private:
+	struct Worker {
+		std::mutex mutex; // guards jobs; held only to push or pop one
+		std::deque<JobHandle> jobs;
+		std::atomic<uint64_t> nJobs, nSteals, busyNanoseconds;
+		Worker();
+	};
+
+	std::vector<std::thread> threads;
+	/* one per pool thread, then the one shared by outside threads */
+	std::vector<std::unique_ptr<Worker>> workers;
+	/* long-running jobs, taken only by idle pool threads */
+	Worker background;
+	/* jobs pushed but not yet taken, and workers asleep waiting for one */
+	std::atomic<size_t> queued, sleeping;
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	std::atomic<bool> quitting;
+
+	/* sampling state of getStats */
+	mutable std::mutex statsMutex;
+	mutable std::chrono::steady_clock::time_point lastSample;
+	mutable std::vector<uint64_t> lastBusy;
+public:
+	/* nThreads workers besides the threads that wait for jobs. 0 uses one less than the hardware threads, but at least one */
+	JobSystem(size_t nThreads = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	/* the pool every part of the program shares */
+	static JobSystem& shared();
+
+	/* creates a job that does not run until it is passed to run. If parent is given, the parent stays unfinished until this job has finished.
+	   Children must be created before their parent is run */
+	JobHandle create(std::function<void()> work, JobHandle parent = nullptr);
+
+	/* queues a job on the calling thread's deque */
+	void run(const JobHandle& job);
+
+	/* queues a long-running job that only pool threads pick up, once they have nothing else to do.
+	   Threads waiting for other jobs never take it, so it cannot stall them */
+	void runInBackground(const JobHandle& job);
+
+	/* returns once job and all of its children have finished, running other jobs meanwhile */
+	void wait(const JobHandle& job);
+
+	/* calls body(first, last) over [0, count) in ranges of at most grain items, in parallel, and returns when every range is done */
+	void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+	/* pool threads, not counting the threads that wait */
+	size_t getThreadCount() const;
+
+	/* counters of every pool thread, then of the outside threads */
+	std::vector<WorkerStats> getStats() const;
+
+	/* one line for the HUD: the utilization of every worker */
+	std::string describe() const;
+
+private:
+	void workerLoop(size_t index);
+
+	/* the deque of the calling thread */
+	size_t currentWorker() const;
+
+	/* pops a job from the calling thread's deque, or steals one, or with takeBackground a background job.
+	   returns nullptr if there is none */
+	JobHandle find(size_t self, bool takeBackground);
+
+	/* counts a pushed job and wakes a sleeping worker for it */
+	void jobQueued();
+
+	void execute(const JobHandle& job, size_t self);
+
+	void finish(Job* job);
+};
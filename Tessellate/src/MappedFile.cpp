@@ -0,0 +1,93 @@
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const char* const filepath)
+	: data(nullptr), size(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(NULL) {
+	fileHandle = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		throw std::runtime_error(std::string("cannot open file ") + filepath);
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize)) {
+		CloseHandle(fileHandle);
+		throw std::runtime_error(std::string("cannot read size of ") + filepath);
+	}
+	size = static_cast<size_t>(fileSize.QuadPart);
+	if (size == 0) // empty files cannot be mapped
+		return;
+
+	mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappingHandle != NULL)
+		data = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (data == nullptr) {
+		if (mappingHandle != NULL)
+			CloseHandle(mappingHandle);
+		CloseHandle(fileHandle);
+		throw std::runtime_error(std::string("cannot map ") + filepath);
+	}
+}
+
+MappedFile::~MappedFile() {
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mappingHandle != NULL)
+		CloseHandle(mappingHandle);
+	CloseHandle(fileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const char* const filepath)
+	: data(nullptr), size(0), fd(-1) {
+	fd = open(filepath, O_RDONLY);
+	if (fd < 0)
+		throw std::runtime_error(std::string("cannot open file ") + filepath);
+
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		throw std::runtime_error(std::string("cannot read size of ") + filepath);
+	}
+	size = static_cast<size_t>(info.st_size);
+	if (size == 0) // empty files cannot be mapped
+		return;
+
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (mapping == MAP_FAILED) {
+		close(fd);
+		throw std::runtime_error(std::string("cannot map ") + filepath);
+	}
+	data = static_cast<const unsigned char*>(mapping);
+	madvise(mapping, size, MADV_SEQUENTIAL);
+}
+
+MappedFile::~MappedFile() {
+	if (data != nullptr)
+		munmap(const_cast<unsigned char*>(data), size);
+	close(fd);
+}
+
+#endif
+
+const unsigned char* MappedFile::getData() const {
+	return data;
+}
+
+size_t MappedFile::getSize() const {
+	return size;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+/* A read-only view of a whole file, mapped into memory so it can be parsed in place without copying */
+class MappedFile {
+private:
+	const unsigned char* data;
+	size_t size;
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fd;
+#endif
+public:
+	/* throws std::runtime_error if the file cannot be opened or mapped */
+	MappedFile(const char* const filepath);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const unsigned char* getData() const;
+	size_t getSize() const;
+};
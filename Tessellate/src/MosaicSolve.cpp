@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+
+#include "MosaicSolve.hpp"
+#include "AI.hpp"
+#include "ImageSource.hpp"
+#include "ImageStream.hpp"
+#include "JobSystem.hpp"
+
+MosaicSolve::Shared::Shared(const ColorQuantizer& quantizer)
+	: rows(0), cols(0), cubeBudget(0), fitMode(FitMode::CROP), quantizer(quantizer), ditherMode(DitherMode::ERROR_DIFFUSION),
+	cancelled(false), nPlanned(0), sized(false), fit(), imageWidth(0), imageHeight(0), failed(false), key(0), nUnsolved(0) {}
+
+MosaicSolve::MosaicSolve(const std::string& imagePath, size_t rows, size_t cols, size_t cubeBudget, FitMode fitMode,
+	const ColorQuantizer& quantizer, DitherMode ditherMode, std::shared_ptr<ShardCoordinator> coordinator, std::shared_ptr<SolutionCache> cache)
+	: shared(std::make_shared<Shared>(quantizer)), resized(false), nDelivered(0), startTime(std::chrono::steady_clock::now()) {
+	shared->imagePath = imagePath;
+	shared->rows = rows;
+	shared->cols = cols;
+	shared->cubeBudget = cubeBudget;
+	shared->fitMode = fitMode;
+	shared->ditherMode = ditherMode;
+	shared->coordinator = coordinator;
+	shared->cache = cache;
+
+	JobSystem& jobs = JobSystem::shared();
+	std::shared_ptr<Shared> state = shared;
+	jobs.runInBackground(jobs.create([state] { plan(state); }));
+}
+
+MosaicSolve::~MosaicSolve() {
+	cancel();
+}
+
+void MosaicSolve::cancel() {
+	shared->cancelled = true;
+}
+
+void MosaicSolve::plan(std::shared_ptr<Shared> shared) {
+	try {
+		std::unique_ptr<ImageSource> image = ImageSource::open(shared->imagePath.c_str());
+		GridFit fit = shared->rows > 0 && shared->cols > 0 ?
+			GridFit::forSize(image->getWidth(), image->getHeight(), shared->rows, shared->cols, shared->fitMode) :
+			GridFit::forBudget(image->getWidth(), image->getHeight(), shared->cubeBudget, shared->fitMode);
+		{
+			std::lock_guard<std::mutex> lock(shared->mutex);
+			shared->fit = fit;
+			shared->imageWidth = image->getWidth();
+			shared->imageHeight = image->getHeight();
+			shared->sized = true;
+			shared->slots.resize(fit.rows * fit.cols * AI::PLAN_SLOT);
+			shared->lengths.assign(fit.rows * fit.cols, 0);
+			shared->planned.reserve(fit.rows * fit.cols);
+		}
+
+		// the grid is resized to fresh cubes, so every tile is planned from the same start
+		const CubeState& start = CubeState::standard();
+
+		// the worker processes and the cache take the whole grid at once
+		bool whole = shared->coordinator || shared->cache;
+
+		JobSystem& jobs = JobSystem::shared();
+		ImageStream stream(*image, fit, shared->quantizer, shared->ditherMode);
+		size_t width = fit.cols * 3;
+		std::vector<Color> band(ImageStream::BAND_ROWS * width);
+		for (size_t r = 0; !shared->cancelled && stream.nextBand(band.data()); r++) { // per band of cubes
+			for (size_t c = 0; c < width; c += 3) { // per column
+				std::array<Color, 9> pattern = {
+					band[0 * width + c], band[0 * width + c + 1], band[0 * width + c + 2],
+					band[1 * width + c], band[1 * width + c + 1], band[1 * width + c + 2],
+					band[2 * width + c], band[2 * width + c + 1], band[2 * width + c + 2]
+				};
+				size_t index = r * fit.cols + c / 3;
+
+				if (whole) {
+					shared->tasks.push_back(TileTask{ static_cast<uint32_t>(index), start, {} });
+					std::copy(pattern.begin(), pattern.end(), shared->tasks.back().pattern);
+					continue;
+				}
+
+				// tiles stay in the background queue too, so a frame waiting on its own jobs never picks one up
+				jobs.runInBackground(jobs.create([shared, pattern, start, index]() mutable {
+					if (shared->cancelled)
+						return;
+					AI ai(start.stickers);
+					ai.calculatePaint(pattern.data());
+					deliver(*shared, index, ai.getInstructions().data(), ai.getInstructions().size());
+				}));
+			}
+		}
+
+		if (!whole || shared->cancelled)
+			return;
+		if (shared->cache) {
+			planForCache(shared);
+			return;
+		}
+		shared->coordinator->plan(shared->tasks, [&](TilePlan& plan) {
+			deliver(*shared, plan.tile, plan.moves.data(), plan.moves.size());
+		}, &shared->cancelled);
+	} catch (const std::runtime_error& e) {
+		std::lock_guard<std::mutex> lock(shared->mutex);
+		shared->failed = true;
+		shared->error = e.what();
+	}
+}
+
+void MosaicSolve::planForCache(std::shared_ptr<Shared> shared) {
+	const std::vector<TileTask>& tasks = shared->tasks;
+	size_t rows = shared->fit.rows, cols = shared->fit.cols;
+	shared->key = SolutionCache::getKey(rows, cols, tasks);
+	shared->solutions.assign(tasks.size(), std::vector<Move>());
+	if (shared->cache->load(shared->key, rows, cols, tasks, shared->solutions)) {
+		for (size_t i = 0; i < tasks.size(); i++)
+			deliver(*shared, i, shared->solutions[i].data(), shared->solutions[i].size());
+		return;
+	}
+
+	// tiles another grid shares are reused, only the rest is planned
+	std::vector<unsigned char> found(tasks.size(), 0);
+	shared->cache->reuse(tasks, shared->solutions, found);
+	std::vector<TileTask> rest;
+	for (size_t i = 0; i < tasks.size(); i++) {
+		if (found[i])
+			deliver(*shared, i, shared->solutions[i].data(), shared->solutions[i].size());
+		else
+			rest.push_back(tasks[i]);
+	}
+	shared->nUnsolved = rest.size();
+	if (rest.empty()) { // stored whole, so next time it is found at once
+		shared->cache->store(shared->key, rows, cols, tasks, shared->solutions);
+		return;
+	}
+
+	if (shared->coordinator) {
+		shared->coordinator->plan(rest, [&](TilePlan& plan) {
+			solved(*shared, plan.tile, plan.moves);
+			deliver(*shared, plan.tile, plan.moves.data(), plan.moves.size());
+		}, &shared->cancelled);
+		return;
+	}
+	JobSystem& jobs = JobSystem::shared();
+	for (TileTask task : rest) {
+		jobs.runInBackground(jobs.create([shared, task]() mutable {
+			if (shared->cancelled)
+				return;
+			AI ai(task.start.stickers);
+			ai.calculatePaint(task.pattern);
+			std::vector<Move> moves(ai.getInstructions().begin(), ai.getInstructions().end());
+			solved(*shared, task.tile, moves);
+			deliver(*shared, task.tile, moves.data(), moves.size());
+		}));
+	}
+}
+
+void MosaicSolve::deliver(Shared& shared, size_t tile, const Move moves[], size_t n) {
+	if (n <= AI::PLAN_SLOT) // slots are disjoint, so no lock
+		std::copy(moves, moves + n, shared.slots.begin() + tile * AI::PLAN_SLOT);
+	shared.lengths[tile] = static_cast<uint32_t>(n);
+	std::lock_guard<std::mutex> lock(shared.mutex);
+	if (n > AI::PLAN_SLOT)
+		shared.spilled[tile].assign(moves, moves + n);
+	shared.planned.push_back(tile);
+	shared.nPlanned++;
+}
+
+void MosaicSolve::solved(Shared& shared, size_t tile, const std::vector<Move>& moves) {
+	shared.solutions[tile] = moves; // tiles are disjoint, so no lock
+	if (--shared.nUnsolved == 0 && !shared.cancelled)
+		shared.cache->store(shared.key, shared.fit.rows, shared.fit.cols, shared.tasks, shared.solutions);
+}
+
+bool MosaicSolve::update(Grid& grid) {
+	bool resizedNow = false;
+	{
+		std::lock_guard<std::mutex> lock(shared->mutex);
+		if (shared->failed) {
+			if (!shared->error.empty())
+				std::cout << "Could not solve " << shared->imagePath << ": " << shared->error << std::endl;
+			shared->error.clear();
+			return false;
+		}
+		if (!shared->sized)
+			return false;
+		if (!resized) {
+			grid.resize(shared->fit.rows, shared->fit.cols);
+			delivering.reserve(shared->fit.rows * shared->fit.cols); // swapped with planned, so neither grows again
+			resized = resizedNow = true;
+		}
+		delivering.swap(shared->planned); // the lock is held only for the swap
+	}
+
+	const CubeState& fresh = CubeState::standard();
+	for (size_t index : delivering) {
+		if (index >= grid.cubes.size())
+			continue;
+		const Move* moves = &shared->slots[index * AI::PLAN_SLOT];
+		size_t n = shared->lengths[index];
+		if (n > AI::PLAN_SLOT) {
+			std::lock_guard<std::mutex> lock(shared->mutex); // the map's nodes stay where they are while jobs add others
+			moves = shared->spilled[index].data();
+		}
+		CubeRef cube = grid.cubes[index];
+		if (cube.getQueueSize() == 0 && cube.getState() == fresh) {
+			grid.cubes.push(index, moves, n);
+		} else {
+			// the cube was turned by hand since the grid was resized, or still has moves queued. Its plan is stale, so replan it
+			Color pattern[9];
+			// the pattern is what the stale plan would have shown on UP: replay it on a fresh copy to recover it
+			CubeState planned = fresh;
+			for (size_t m = 0; m < n; m++)
+				planned.apply(moves[m]);
+			for (int i = 0; i < 9; i++)
+				pattern[i] = planned.getColorAt(FaceType::UP, i);
+			// planned from where the cube ends up, so the moves it still has queued are kept and the tile follows them
+			CubeState end = cube.getState();
+			for (uint32_t m = grid.cubes.queueFront[index]; m < grid.cubes.queueEnd[index]; m++)
+				end.apply(grid.cubes.movePool[m]);
+			AI ai(end.stickers);
+			ai.calculatePaint(pattern);
+			grid.cubes.push(index, ai.getInstructions().data(), ai.getInstructions().size());
+		}
+		nDelivered++;
+	}
+	delivering.clear();
+
+	if (isFinished()) {
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+		std::lock_guard<std::mutex> lock(shared->mutex);
+		std::cout << "Solved " << shared->imagePath << " (" << shared->imageWidth << "x" << shared->imageHeight << ") for "
+			<< shared->fit.rows << "x" << shared->fit.cols << " cubes (" << getFitModeName(shared->fitMode) << ", "
+			<< getDitherModeName(shared->ditherMode) << " dithering) in " << elapsed.count() << " ms" << std::endl;
+	}
+	return resizedNow;
+}
+
+bool MosaicSolve::isFinished() const {
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	return shared->failed || (shared->sized && nDelivered == shared->fit.rows * shared->fit.cols);
+}
+
+std::string MosaicSolve::describe() const {
+	std::lock_guard<std::mutex> lock(shared->mutex);
+	char line[64];
+	if (shared->failed)
+		snprintf(line, sizeof(line), "SOLVE FAILED");
+	else if (!shared->sized)
+		snprintf(line, sizeof(line), "SOLVE READING IMAGE");
+	else
+		snprintf(line, sizeof(line), "SOLVE %zu/%zu TILES", nDelivered, shared->fit.rows * shared->fit.cols);
+	return line;
+}
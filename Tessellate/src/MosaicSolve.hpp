@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ColorQuantizer.hpp"
+#include "ThresholdDitherer.hpp"
+#include "GridFit.hpp"
+#include "Grid.hpp"
+#include "ShardCoordinator.hpp"
+#include "SolutionCache.hpp"
+
+/* Solves the grid for an image in the background, without blocking the thread that renders it.
+   A background job decodes the image band by band and plans every tile in a job of its own, starting from a fresh cube.
+   With a SolutionCache, the whole grid is looked up first and only the tiles it does not know are planned, then the grid is stored.
+   Each frame, update hands the tiles planned so far to their cubes, so the mosaic fills in progressively */
+class MosaicSolve {
+private:
+	/* everything the jobs touch. They keep it alive after a cancelled solve is destroyed */
+	struct Shared {
+		std::string imagePath;
+		size_t rows, cols, cubeBudget;
+		FitMode fitMode;
+		ColorQuantizer quantizer;
+		DitherMode ditherMode;
+		std::shared_ptr<ShardCoordinator> coordinator; // plans the tiles in worker processes if set
+		std::shared_ptr<SolutionCache> cache; // looks plans up before they are planned, and keeps them, if set
+		std::atomic<bool> cancelled;
+		std::atomic<size_t> nPlanned;
+
+		std::mutex mutex; // guards the rest
+		bool sized; // fit and imageWidth/imageHeight are known
+		GridFit fit;
+		size_t imageWidth, imageHeight;
+		bool failed;
+		std::string error;
+		std::vector<size_t> planned; // tiles planned since the last update, waiting to be handed to their cubes
+		std::unordered_map<size_t, std::vector<Move>> spilled; // plans longer than their slot. Rare: see AI::PLAN_SLOT
+
+		// one buffer for every plan, sized once the grid is known. Tile i's plan is the first lengths[i] moves from i * AI::PLAN_SLOT.
+		// Each tile's slot is written by the job that planned it, before the tile is added to planned
+		std::vector<Move> slots;
+		std::vector<uint32_t> lengths;
+
+		// the whole grid, while it is planned for the cache. tasks[i] is tile i
+		uint64_t key;
+		std::vector<TileTask> tasks;
+		std::vector<std::vector<Move>> solutions;
+		std::atomic<size_t> nUnsolved;
+
+		Shared(const ColorQuantizer& quantizer);
+	};
+
+	std::shared_ptr<Shared> shared;
+	bool resized;
+	size_t nDelivered;
+	std::vector<size_t> delivering;
+	std::chrono::steady_clock::time_point startTime;
+public:
+	/* starts solving imagePath for exactly rows x cols cubes, or if they are 0 for the largest grid of at most cubeBudget cubes.
+	   Tiles are planned by coordinator's worker processes if it is given, otherwise on the job system. Plans found in cache are not planned again */
+	MosaicSolve(const std::string& imagePath, size_t rows, size_t cols, size_t cubeBudget, FitMode fitMode,
+		const ColorQuantizer& quantizer, DitherMode ditherMode, std::shared_ptr<ShardCoordinator> coordinator = nullptr,
+		std::shared_ptr<SolutionCache> cache = nullptr);
+
+	/* cancels the solve */
+	~MosaicSolve();
+
+	MosaicSolve(const MosaicSolve&) = delete;
+	MosaicSolve& operator=(const MosaicSolve&) = delete;
+
+	/* stops planning tiles. Tiles already handed to cubes keep turning */
+	void cancel();
+
+	/* call once per frame on the thread that owns grid. Resizes the grid once the image size is known, then hands out the tiles planned since.
+	   returns true on the frame it resized the grid */
+	bool update(Grid& grid);
+
+	/* true once every tile was handed out, or the image could not be read */
+	bool isFinished() const;
+
+	/* a line for the HUD: tiles handed out out of the total */
+	std::string describe() const;
+
+private:
+	/* the background job: reads the image and spawns one job per tile */
+	static void plan(std::shared_ptr<Shared> shared);
+
+	/* plans the tiles of shared->tasks the cache does not know, then stores the grid */
+	static void planForCache(std::shared_ptr<Shared> shared);
+
+	/* hands the n moves planned for a tile to update, in its slot if they fit */
+	static void deliver(Shared& shared, size_t tile, const Move moves[], size_t n);
+
+	/* records the plan of a tile of shared->tasks, and stores the grid once it was the last one */
+	static void solved(Shared& shared, size_t tile, const std::vector<Move>& moves);
+};
@@ -0,0 +1,83 @@
+#include <algorithm>
+
+#include "Move.hpp"
+#include "Cube.hpp"
+
+namespace {
+	/* the permutation of every move, measured once on Cube so both always agree on what a move does */
+	struct PermutationTables {
+		unsigned char from[N_MOVES][54];
+
+		PermutationTables() {
+			for (size_t m = 0; m < N_MOVES; m++) {
+				std::shared_ptr<Instruction> instruction = toInstruction(static_cast<Move>(m));
+				for (int i = 0; i < 54; i++) { // follow one marked sticker at a time
+					Color colors[54];
+					std::fill(colors, colors + 54, Color::WHITE);
+					colors[i] = Color::RED;
+					Cube cube(colors);
+					cube.perform(instruction.get());
+					cube.getColors(colors);
+					from[m][std::find(colors, colors + 54, Color::RED) - colors] = static_cast<unsigned char>(i);
+				}
+			}
+		}
+	};
+
+	const PermutationTables& getPermutationTables() {
+		static const PermutationTables tables;
+		return tables;
+	}
+}
+
+Move getFaceMove(FaceType face, bool clockwise) {
+	return static_cast<Move>(static_cast<int>(face) * 2 + (clockwise ? 0 : 1));
+}
+
+bool isFaceMove(Move move) {
+	return static_cast<size_t>(move) < N_FACE_MOVES;
+}
+
+FaceType getMoveFace(Move move) {
+	return static_cast<FaceType>(static_cast<int>(move) / 2);
+}
+
+bool isMoveClockwise(Move move) {
+	return static_cast<int>(move) % 2 == 0;
+}
+
+glm::vec3 getMoveAxis(Move move) {
+	glm::vec3 axis(0.0f);
+	axis[(static_cast<int>(move) - N_FACE_MOVES) / 2] = isMoveClockwise(move) ? 1.0f : -1.0f;
+	return axis;
+}
+
+Move getInverseMove(Move move) {
+	return static_cast<Move>(static_cast<int>(move) ^ 1);
+}
+
+const char* getMoveName(Move move) {
+	static const char* const NAMES[N_MOVES] = { "F", "F'", "U", "U'", "B", "B'", "D", "D'", "L", "L'", "R", "R'", "x", "x'", "y", "y'", "z", "z'" };
+	return NAMES[static_cast<int>(move)];
+}
+
+Move toMove(const Instruction& instruction) {
+	if (instruction.isFaceInstruction()) {
+		const FaceInstruction& inst = static_cast<const FaceInstruction&>(instruction);
+		return getFaceMove(inst.getFace(), inst.isClockwise());
+	}
+	glm::vec3 axis = static_cast<const CubeInstruction&>(instruction).getAxis();
+	int a = axis.x != 0 ? 0 : axis.y != 0 ? 1 : 2;
+	bool clockwise = (axis.x + axis.y + axis.z) > 0;
+	return static_cast<Move>(N_FACE_MOVES + a * 2 + (clockwise ? 0 : 1));
+}
+
+std::shared_ptr<Instruction> toInstruction(Move move) {
+	if (isFaceMove(move))
+		return std::make_shared<FaceInstruction>(getMoveFace(move), isMoveClockwise(move));
+	return std::make_shared<CubeInstruction>(getMoveAxis(move));
+}
+
+const unsigned char* getMovePermutation(Move move) {
+	return getPermutationTables().from[static_cast<int>(move)];
+}
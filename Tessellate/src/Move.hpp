@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+
+#include <glm/glm.hpp>
+
+#include "Instruction.hpp"
+
+/* A quarter turn of one face or of the whole cube, in a byte. The compact counterpart of Instruction:
+   the first 12 are face turns, clockwise then counterclockwise, in the order of FaceType; the last 6 rotate the whole cube */
+enum class Move : unsigned char {
+	F, F_PRIME, U, U_PRIME, B, B_PRIME, D, D_PRIME, L, L_PRIME, R, R_PRIME,
+	X, X_PRIME, Y, Y_PRIME, Z, Z_PRIME
+};
+
+const size_t N_MOVES = 18;
+const size_t N_FACE_MOVES = 12;
+
+/* the turn of face in the given direction */
+Move getFaceMove(FaceType face, bool clockwise = true);
+
+bool isFaceMove(Move move);
+
+/* Precondition: move is a face turn */
+FaceType getMoveFace(Move move);
+
+/* for a rotation of the whole cube, whether it turns the positive way around its axis (see CubeInstruction) */
+bool isMoveClockwise(Move move);
+
+/* Precondition: move rotates the whole cube. Returns the axis as CubeInstruction stores it: negative for the prime rotations */
+glm::vec3 getMoveAxis(Move move);
+
+/* the move that undoes move */
+Move getInverseMove(Move move);
+
+/* Singmaster notation, ex. "F'" or "y" */
+const char* getMoveName(Move move);
+
+Move toMove(const Instruction& instruction);
+
+std::shared_ptr<Instruction> toInstruction(Move move);
+
+/* where every sticker comes from when move is applied: after the move, sticker i holds what sticker permutation[i] held.
+   Stickers are numbered face by face in the order of FaceType, 9 per face (see Cube::getColors) */
+const unsigned char* getMovePermutation(Move move);
@@ -0,0 +1,424 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "PNGImage.hpp"
+#include "Inflater.hpp"
+#include "MappedFile.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TESSELLATE_SSE
+#include <emmintrin.h>
+#endif
+
+const unsigned char PNGImage::SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+namespace {
+	/* color types */
+	const unsigned int GRAY = 0;
+	const unsigned int RGB = 2;
+	const unsigned int PALETTE = 3;
+	const unsigned int GRAY_ALPHA = 4;
+	const unsigned int RGB_ALPHA = 6;
+
+	/* row filters */
+	const unsigned int FILTER_NONE = 0;
+	const unsigned int FILTER_SUB = 1;
+	const unsigned int FILTER_UP = 2;
+	const unsigned int FILTER_AVERAGE = 3;
+	const unsigned int FILTER_PAETH = 4;
+
+	/* Adam7 passes: first pixel and spacing */
+	const size_t PASS_X[7] = { 0, 4, 0, 2, 0, 1, 0 };
+	const size_t PASS_Y[7] = { 0, 0, 4, 0, 2, 0, 1 };
+	const size_t PASS_DX[7] = { 8, 8, 4, 4, 2, 2, 1 };
+	const size_t PASS_DY[7] = { 8, 8, 8, 4, 4, 2, 2 };
+
+	unsigned int readU32(const unsigned char* p) {
+		return (static_cast<unsigned int>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+	}
+
+	/* the pixel format and transparency of an image, as declared by its header chunks */
+	struct Format {
+		unsigned int bitDepth, colorType;
+		size_t channels;
+		/* rgba of every palette entry, alpha 255 unless a tRNS chunk says otherwise */
+		unsigned char palette[256][4];
+		/* tRNS of gray and rgb images: samples of the one fully transparent color */
+		bool hasKey;
+		unsigned int key[3];
+
+		size_t bitsPerPixel() const {
+			return channels * bitDepth;
+		}
+
+		/* distance in bytes between a byte and the matching byte of the pixel to its left, at least 1 */
+		size_t filterStride() const {
+			return std::max<size_t>(1, bitsPerPixel() / 8);
+		}
+
+		size_t rowBytes(size_t nPixels) const {
+			return (nPixels * bitsPerPixel() + 7) / 8;
+		}
+	};
+
+	unsigned char paeth(unsigned char a, unsigned char b, unsigned char c) {
+		int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+		return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+	}
+
+#ifdef TESSELLATE_SSE
+	/* a pixel of 3 or 4 bytes in the low lane of a register. Whole 4-byte words are moved while they stay inside the row;
+	   only the last 3-byte pixel of a row is copied byte-wise */
+	template <size_t BPP>
+	__m128i loadPixel(const unsigned char* p, bool word) {
+		int v = 0;
+		if (word)
+			memcpy(&v, p, 4);
+		else
+			memcpy(&v, p, BPP);
+		return _mm_cvtsi32_si128(v);
+	}
+
+	template <size_t BPP>
+	void storePixel(unsigned char* p, __m128i pixel, bool word) {
+		int v = _mm_cvtsi128_si32(pixel);
+		if (word)
+			memcpy(p, &v, 4);
+		else
+			memcpy(p, &v, BPP);
+	}
+
+	/* (mask & x) | (~mask & y) */
+	__m128i select(__m128i mask, __m128i x, __m128i y) {
+		return _mm_or_si128(_mm_and_si128(mask, x), _mm_andnot_si128(mask, y));
+	}
+
+	__m128i abs16(__m128i x) {
+		return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+	}
+
+	/* Sub, Average and Paeth depend on the reconstructed pixel to the left, so 3 and 4-byte pixels are reconstructed one whole pixel per step.
+	   The fourth lane of a 3-byte pixel's predictor is cleared, so the word written back leaves the next pixel's byte unchanged.
+	   Each pixel is read one step ahead, before the overlapping word of the previous pixel is written */
+	template <size_t BPP>
+	void unfilterPixels(unsigned int filter, unsigned char row[], const unsigned char prior[], size_t n) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i keep = _mm_cvtsi32_si128(BPP == 3 ? 0x00FFFFFF : -1);
+		__m128i a = zero; // reconstructed left pixel
+		__m128i x = loadPixel<BPP>(row, 4 <= n), next;
+		switch (filter) {
+		case FILTER_SUB:
+			for (size_t i = 0; i < n; i += BPP) {
+				bool word = i + 4 <= n;
+				next = i + BPP < n ? loadPixel<BPP>(row + i + BPP, i + BPP + 4 <= n) : zero;
+				a = _mm_add_epi8(x, _mm_and_si128(a, keep));
+				storePixel<BPP>(row + i, a, word);
+				x = next;
+			}
+			return;
+		case FILTER_AVERAGE: {
+			const __m128i one = _mm_set1_epi8(1);
+			for (size_t i = 0; i < n; i += BPP) {
+				bool word = i + 4 <= n;
+				next = i + BPP < n ? loadPixel<BPP>(row + i + BPP, i + BPP + 4 <= n) : zero;
+				__m128i b = loadPixel<BPP>(prior + i, word);
+				// _mm_avg_epu8 rounds up; the filter rounds down
+				__m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+				a = _mm_add_epi8(x, _mm_and_si128(average, keep));
+				storePixel<BPP>(row + i, a, word);
+				x = next;
+			}
+			return;
+		}
+		case FILTER_PAETH: {
+			// predictors are compared in 16-bit lanes
+			__m128i a16 = zero, c16 = zero;
+			for (size_t i = 0; i < n; i += BPP) {
+				bool word = i + 4 <= n;
+				next = i + BPP < n ? loadPixel<BPP>(row + i + BPP, i + BPP + 4 <= n) : zero;
+				__m128i b16 = _mm_unpacklo_epi8(loadPixel<BPP>(prior + i, word), zero);
+				__m128i pa = _mm_sub_epi16(b16, c16);
+				__m128i pb = _mm_sub_epi16(a16, c16);
+				__m128i pc = abs16(_mm_add_epi16(pa, pb));
+				pa = abs16(pa);
+				pb = abs16(pb);
+				__m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+				__m128i nearest = select(_mm_cmpeq_epi16(pb, smallest), b16, c16);
+				nearest = select(_mm_cmpeq_epi16(pa, smallest), a16, nearest);
+
+				a = _mm_add_epi8(x, _mm_and_si128(_mm_packus_epi16(nearest, nearest), keep));
+				storePixel<BPP>(row + i, a, word);
+				x = next;
+				a16 = _mm_unpacklo_epi8(a, zero);
+				c16 = b16;
+			}
+			return;
+		}
+		}
+	}
+#endif
+
+	/* reverses the filter of one row in place. prior is the reconstructed row above, or zeros for the first row of a pass */
+	void unfilterRow(unsigned int filter, unsigned char row[], const unsigned char prior[], size_t n, size_t bpp) {
+		switch (filter) {
+		case FILTER_NONE:
+			return;
+		case FILTER_UP: {
+			size_t i = 0;
+#ifdef TESSELLATE_SSE
+			for (; i + 16 <= n; i += 16) {
+				__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prior + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), _mm_add_epi8(x, b));
+			}
+#endif
+			for (; i < n; i++)
+				row[i] = static_cast<unsigned char>(row[i] + prior[i]);
+			return;
+		}
+		case FILTER_SUB:
+		case FILTER_AVERAGE:
+		case FILTER_PAETH:
+			break;
+		default:
+			throw std::runtime_error("PNG row has an invalid filter type " + std::to_string(filter));
+		}
+
+#ifdef TESSELLATE_SSE
+		if (bpp == 3) {
+			unfilterPixels<3>(filter, row, prior, n);
+			return;
+		}
+		if (bpp == 4) {
+			unfilterPixels<4>(filter, row, prior, n);
+			return;
+		}
+#endif
+		// the first pixel has no left neighbor: its a and c are 0
+		for (size_t i = 0; i < n; i++) {
+			unsigned int a = i >= bpp ? row[i - bpp] : 0;
+			unsigned int c = i >= bpp ? prior[i - bpp] : 0;
+			if (filter == FILTER_SUB)
+				row[i] = static_cast<unsigned char>(row[i] + a);
+			else if (filter == FILTER_AVERAGE)
+				row[i] = static_cast<unsigned char>(row[i] + ((a + prior[i]) >> 1));
+			else
+				row[i] = static_cast<unsigned char>(row[i] + paeth(a, prior[i], c));
+		}
+	}
+
+	/* converts n pixels of a reconstructed row to rgb, writing one pixel every outStep bytes */
+	void convertRow(const Format& format, const unsigned char row[], size_t n, unsigned char out[], size_t outStep) {
+		unsigned int depth = format.bitDepth;
+		unsigned int colorType = format.colorType;
+		size_t channels = format.channels;
+
+		if (depth == 8 && colorType == RGB && !format.hasKey && outStep == 3) {
+			memcpy(out, row, n * 3);
+			return;
+		}
+
+		// reads sample i of the row at its own depth
+		auto sample = [row, depth](size_t i) -> unsigned int {
+			if (depth == 8)
+				return row[i];
+			if (depth == 16)
+				return row[2 * i] << 8 | row[2 * i + 1];
+			size_t bit = i * depth;
+			return (row[bit / 8] >> (8 - depth - bit % 8)) & ((1u << depth) - 1);
+		};
+		// scales a sample to 8 bits
+		unsigned int maxSample = (1u << depth) - 1;
+		auto to8 = [depth, maxSample](unsigned int s) -> unsigned int {
+			return depth == 16 ? s >> 8 : depth == 8 ? s : s * 255 / maxSample;
+		};
+		// composites over white
+		auto blend = [](unsigned int c, unsigned int alpha) -> unsigned char {
+			return static_cast<unsigned char>((c * alpha + 255 * (255 - alpha) + 127) / 255);
+		};
+
+		for (size_t x = 0; x < n; x++, out += outStep) {
+			size_t s = x * channels;
+			unsigned int r, g, b, alpha = 255;
+			switch (colorType) {
+			case PALETTE: {
+				const unsigned char* entry = format.palette[sample(s)];
+				r = entry[0];
+				g = entry[1];
+				b = entry[2];
+				alpha = entry[3];
+				break;
+			}
+			case GRAY:
+			case GRAY_ALPHA:
+				if (format.hasKey && sample(s) == format.key[0])
+					alpha = 0;
+				r = g = b = to8(sample(s));
+				if (colorType == GRAY_ALPHA)
+					alpha = to8(sample(s + 1));
+				break;
+			default: // RGB, RGB_ALPHA
+				if (format.hasKey && sample(s) == format.key[0] && sample(s + 1) == format.key[1] && sample(s + 2) == format.key[2])
+					alpha = 0;
+				r = to8(sample(s));
+				g = to8(sample(s + 1));
+				b = to8(sample(s + 2));
+				if (colorType == RGB_ALPHA)
+					alpha = to8(sample(s + 3));
+				break;
+			}
+
+			if (alpha == 255) {
+				out[0] = static_cast<unsigned char>(r);
+				out[1] = static_cast<unsigned char>(g);
+				out[2] = static_cast<unsigned char>(b);
+			} else {
+				out[0] = blend(r, alpha);
+				out[1] = blend(g, alpha);
+				out[2] = blend(b, alpha);
+			}
+		}
+	}
+}
+
+PNGImage::PNGImage(const char* const filepath)
+	: width(0), height(0) {
+
+	MappedFile file(filepath);
+	const unsigned char* p = file.getData();
+	const unsigned char* end = p + file.getSize();
+	if (file.getSize() < 8 || memcmp(p, SIGNATURE, 8) != 0)
+		throw std::runtime_error(std::string(filepath) + " is not a PNG image");
+	p += 8;
+
+	Format format = {};
+	for (int i = 0; i < 256; i++)
+		format.palette[i][3] = 255;
+	unsigned int interlace = 0;
+	bool hasHeader = false;
+	// the compressed stream may be split over several IDAT chunks. A single one is inflated in place
+	std::vector<std::pair<const unsigned char*, size_t>> idat;
+	size_t idatSize = 0;
+
+	for (;;) {
+		if (end - p < 12)
+			throw std::runtime_error(std::string(filepath) + " is truncated");
+		size_t length = readU32(p);
+		const unsigned char* type = p + 4;
+		const unsigned char* data = p + 8;
+		if (length > static_cast<size_t>(end - data) - 4)
+			throw std::runtime_error(std::string(filepath) + " is truncated");
+		p = data + length + 4; // skip the CRC: the image data is checked by the Adler-32 of its zlib stream instead
+
+		if (memcmp(type, "IHDR", 4) == 0) {
+			if (length < 13)
+				throw std::runtime_error(std::string(filepath) + " has an invalid header");
+			width = readU32(data);
+			height = readU32(data + 4);
+			format.bitDepth = data[8];
+			format.colorType = data[9];
+			interlace = data[12];
+			hasHeader = true;
+		} else if (memcmp(type, "PLTE", 4) == 0) {
+			for (size_t i = 0; i < length / 3 && i < 256; i++)
+				memcpy(format.palette[i], data + 3 * i, 3);
+		} else if (memcmp(type, "tRNS", 4) == 0) {
+			if (format.colorType == PALETTE) {
+				for (size_t i = 0; i < length && i < 256; i++)
+					format.palette[i][3] = data[i];
+			} else if (length >= 2) {
+				format.hasKey = true;
+				for (size_t i = 0; i < 3 && 2 * i + 1 < length; i++)
+					format.key[i] = data[2 * i] << 8 | data[2 * i + 1];
+			}
+		} else if (memcmp(type, "IDAT", 4) == 0) {
+			idat.emplace_back(data, length);
+			idatSize += length;
+		} else if (memcmp(type, "IEND", 4) == 0) {
+			break;
+		} else if (!(type[0] & 0x20)) {
+			throw std::runtime_error(std::string(filepath) + ": unsupported critical chunk " + std::string(reinterpret_cast<const char*>(type), 4));
+		}
+	}
+
+	unsigned int depth = format.bitDepth;
+	bool validDepth;
+	switch (format.colorType) {
+	case GRAY: format.channels = 1; validDepth = depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16; break;
+	case PALETTE: format.channels = 1; validDepth = depth == 1 || depth == 2 || depth == 4 || depth == 8; break;
+	case RGB: format.channels = 3; validDepth = depth == 8 || depth == 16; break;
+	case GRAY_ALPHA: format.channels = 2; validDepth = depth == 8 || depth == 16; break;
+	case RGB_ALPHA: format.channels = 4; validDepth = depth == 8 || depth == 16; break;
+	default: validDepth = false;
+	}
+	if (!hasHeader || !validDepth || interlace > 1)
+		throw std::runtime_error(std::string(filepath) + ": unsupported PNG format");
+	if (width == 0 || height == 0 || width > 0x7FFFFFFF || height > 0x7FFFFFFF)
+		throw std::runtime_error(std::string(filepath) + " has invalid dimensions");
+	if (width > MAX_PIXELS / height)
+		throw std::runtime_error(std::string(filepath) + " is too large: " + std::to_string(width) + "x" + std::to_string(height));
+	if (idat.empty())
+		throw std::runtime_error(std::string(filepath) + " has no image data");
+
+	// every row of every pass is stored as a filter byte followed by the row
+	size_t nPasses = interlace ? 7 : 1;
+	size_t passWidth[7], passHeight[7], rawSize = 0;
+	for (size_t pass = 0; pass < nPasses; pass++) {
+		size_t x0 = interlace ? PASS_X[pass] : 0, dx = interlace ? PASS_DX[pass] : 1;
+		size_t y0 = interlace ? PASS_Y[pass] : 0, dy = interlace ? PASS_DY[pass] : 1;
+		passWidth[pass] = width > x0 ? (width - x0 + dx - 1) / dx : 0;
+		passHeight[pass] = height > y0 ? (height - y0 + dy - 1) / dy : 0;
+		if (passWidth[pass] > 0)
+			rawSize += passHeight[pass] * (1 + format.rowBytes(passWidth[pass]));
+	}
+
+	// deflate expands at most 1032:1, so a header promising more than that is lying about its size
+	if (rawSize / 1032 > idatSize)
+		throw std::runtime_error(std::string(filepath) + " has less image data than its header needs");
+
+	std::vector<unsigned char> joined;
+	const unsigned char* compressed = idat[0].first;
+	if (idat.size() > 1) {
+		joined.reserve(idatSize);
+		for (const std::pair<const unsigned char*, size_t>& chunk : idat)
+			joined.insert(joined.end(), chunk.first, chunk.first + chunk.second);
+		compressed = joined.data();
+	}
+	std::vector<unsigned char> raw(rawSize);
+	Inflater::inflateZlib(compressed, idatSize, raw.data(), rawSize);
+
+	pixels.resize(width * height * 3);
+	size_t bpp = format.filterStride();
+	std::vector<unsigned char> zeros(format.rowBytes(width), 0);
+	unsigned char* row = raw.data();
+	for (size_t pass = 0; pass < nPasses; pass++) {
+		if (passWidth[pass] == 0)
+			continue;
+		size_t x0 = interlace ? PASS_X[pass] : 0, dx = interlace ? PASS_DX[pass] : 1;
+		size_t y0 = interlace ? PASS_Y[pass] : 0, dy = interlace ? PASS_DY[pass] : 1;
+		size_t n = format.rowBytes(passWidth[pass]);
+		const unsigned char* prior = zeros.data();
+
+		for (size_t r = 0; r < passHeight[pass]; r++, row += 1 + n) {
+			unfilterRow(row[0], row + 1, prior, n, bpp);
+			convertRow(format, row + 1, passWidth[pass], &pixels[((y0 + r * dy) * width + x0) * 3], dx * 3);
+			prior = row + 1;
+		}
+	}
+}
+
+size_t PNGImage::getWidth() const {
+	return width;
+}
+
+size_t PNGImage::getHeight() const {
+	return height;
+}
+
+void PNGImage::getRGBRow(size_t row, unsigned char output[]) const {
+	const unsigned char* p = &pixels[row * width * 3];
+	std::copy(p, p + width * 3, output);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+#include "ImageSource.hpp"
+
+/* A PNG image, decoded at load time with the built-in Inflater. Supports every standard color type and bit depth, and Adam7 interlacing.
+   Transparent pixels are composited over white, the color of letterboxed cubes */
+class PNGImage : public ImageSource {
+private:
+	size_t width, height;
+	/* 3 bytes (r, g, b) per pixel, row-major, top row first */
+	std::vector<unsigned char> pixels;
+public:
+	/* the first 8 bytes of every PNG file */
+	static const unsigned char SIGNATURE[8];
+
+	/* largest image decoded, in pixels. Larger headers are refused before anything is allocated for them */
+	static const size_t MAX_PIXELS = size_t(1) << 28;
+
+	/* throws std::runtime_error if the file cannot be read or its format is unsupported */
+	PNGImage(const char* const filepath);
+
+	size_t getWidth() const override;
+	size_t getHeight() const override;
+
+	void getRGBRow(size_t row, unsigned char output[]) const override;
+};
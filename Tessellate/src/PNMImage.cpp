@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <string>
+
+#include "PNMImage.hpp"
+
+namespace {
+	/* reads the next unsigned decimal header field, skipping whitespace and # comments */
+	bool readField(const unsigned char*& p, const unsigned char* end, size_t& value) {
+		while (p < end && (isspace(*p) || *p == '#')) {
+			if (*p == '#')
+				while (p < end && *p != '\n')
+					p++;
+			else
+				p++;
+		}
+		if (p == end || !isdigit(*p))
+			return false;
+		value = 0;
+		while (p < end && isdigit(*p)) {
+			value = value * 10 + (*p++ - '0');
+			if (value > 0xFFFFFFFF)
+				return false;
+		}
+		return true;
+	}
+}
+
+PNMImage::PNMImage(const char* const filepath)
+	: file(filepath), width(0), height(0), channels(0), maxValue(0), pixels(nullptr) {
+
+	const unsigned char* p = file.getData();
+	const unsigned char* end = p + file.getSize();
+
+	if (file.getSize() < 2 || p[0] != 'P' || (p[1] != '5' && p[1] != '6'))
+		throw std::runtime_error(std::string(filepath) + " is not a binary PPM or PGM image");
+	channels = p[1] == '6' ? 3 : 1;
+	p += 2;
+
+	size_t max = 0;
+	if (!readField(p, end, width) || !readField(p, end, height) || !readField(p, end, max))
+		throw std::runtime_error(std::string(filepath) + " has an invalid header");
+	if (width == 0 || height == 0 || max == 0 || max > 65535)
+		throw std::runtime_error(std::string(filepath) + " has invalid dimensions");
+	maxValue = static_cast<unsigned int>(max);
+
+	// exactly one whitespace character separates the header from the pixels
+	if (p == end || !isspace(*p))
+		throw std::runtime_error(std::string(filepath) + " has an invalid header");
+	pixels = ++p;
+
+	size_t rowSize = width * channels * (maxValue > 255 ? 2 : 1);
+	if (static_cast<size_t>(end - pixels) / rowSize < height)
+		throw std::runtime_error(std::string(filepath) + " is truncated");
+}
+
+size_t PNMImage::getWidth() const {
+	return width;
+}
+
+size_t PNMImage::getHeight() const {
+	return height;
+}
+
+void PNMImage::getRGBRow(size_t row, unsigned char output[]) const {
+	size_t samples = width * channels;
+	if (maxValue == 255 && channels == 3) {
+		const unsigned char* p = pixels + row * samples;
+		std::copy(p, p + samples, output);
+		return;
+	}
+
+	// samples above maxValue are invalid, but clamped rather than trusted
+	unsigned int max = maxValue;
+	auto scale = [max](unsigned int sample) {
+		return static_cast<unsigned char>(std::min((sample * 255 + max / 2) / max, 255u));
+	};
+
+	unsigned char scaled[256 * 3]; // scratch for one chunk of 8-bit samples
+	for (size_t first = 0; first < width; first += 256) {
+		size_t n = std::min<size_t>(256, width - first);
+		if (maxValue > 255) {
+			const unsigned char* p = pixels + (row * samples + first * channels) * 2;
+			for (size_t i = 0; i < n * channels; i++, p += 2)
+				scaled[i] = scale(p[0] << 8 | p[1]);
+		} else {
+			const unsigned char* p = pixels + row * samples + first * channels;
+			for (size_t i = 0; i < n * channels; i++)
+				scaled[i] = scale(p[i]);
+		}
+
+		unsigned char* out = output + first * 3;
+		if (channels == 3) {
+			std::copy(scaled, scaled + n * 3, out);
+		} else {
+			for (size_t i = 0; i < n; i++, out += 3)
+				out[0] = out[1] = out[2] = scaled[i];
+		}
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "ImageSource.hpp"
+#include "MappedFile.hpp"
+
+/* A binary PPM (P6) or PGM (P5) image. Only the header is parsed: pixels are read straight from the mapped file.
+   Samples are 1 byte, or 2 bytes big-endian when the maximum value is over 255 */
+class PNMImage : public ImageSource {
+private:
+	MappedFile file;
+	size_t width, height;
+	/* 3 for PPM, 1 for PGM */
+	size_t channels;
+	unsigned int maxValue;
+	/* first byte of the top row */
+	const unsigned char* pixels;
+public:
+
+	/* throws std::runtime_error if the file cannot be read or its format is unsupported */
+	PNMImage(const char* const filepath);
+
+	size_t getWidth() const override;
+	size_t getHeight() const override;
+
+	void getRGBRow(size_t row, unsigned char output[]) const override;
+};
@@ -0,0 +1,49 @@
+#include "PatternMemory.hpp"
+
+PatternMemory::PatternMemory()
+	: generation(0) {}
+
+uint32_t PatternMemory::pack(const Color pattern[9]) {
+	uint32_t packed = 0;
+	for (int i = 0; i < 9; i++)
+		packed = (packed << 3) | static_cast<uint32_t>(pattern[i]);
+	return packed;
+}
+
+bool PatternMemory::find(const Color pattern[9], std::vector<Move>& moves) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto known = plans.find(pack(pattern));
+	if (known == plans.end())
+		return false;
+	moves = known->second;
+	return true;
+}
+
+void PatternMemory::remember(const Color pattern[9], const std::vector<Move>& moves) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (plans.size() >= MAX_PATTERNS) {
+		plans.clear();
+		generation++;
+	}
+	plans.emplace(pack(pattern), moves);
+}
+
+void PatternMemory::remember(const std::vector<TileTask>& tasks, const std::vector<std::vector<Move>>& moves) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (plans.size() + tasks.size() > MAX_PATTERNS) {
+		plans.clear();
+		generation++;
+	}
+	for (size_t i = 0; i < tasks.size() && i < moves.size(); i++)
+		plans.emplace(pack(tasks[i].pattern), moves[i]);
+}
+
+size_t PatternMemory::size() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return plans.size();
+}
+
+uint64_t PatternMemory::getGeneration() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return generation;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ShardProtocol.hpp"
+
+/* The plans of the patterns solved recently, each painted on a standard cube, so a pattern seen again is answered without the planner.
+   Patterns are packed into 27 bits as keys. Once MAX_PATTERNS are remembered the memory is cleared and starts over, and the generation
+   counts how often that happened, so whoever tracks what went into it can tell. Shared by a SolutionCache and a SolveServer using it.
+   Safe to use from several threads */
+class PatternMemory {
+public:
+	/* patterns remembered before the memory is cleared */
+	static const size_t MAX_PATTERNS = 1 << 20;
+private:
+	mutable std::mutex mutex; // guards the rest
+	std::unordered_map<uint32_t, std::vector<Move>> plans; // moves by packed pattern
+	uint64_t generation;
+public:
+	PatternMemory();
+
+	PatternMemory(const PatternMemory&) = delete;
+	PatternMemory& operator=(const PatternMemory&) = delete;
+
+	/* the 9 colors of a pattern in 27 bits */
+	static uint32_t pack(const Color pattern[9]);
+
+	/* copies the plan of pattern to moves. returns false if it is not remembered */
+	bool find(const Color pattern[9], std::vector<Move>& moves) const;
+
+	/* remembers the plan of one pattern, clearing the memory first if it is full */
+	void remember(const Color pattern[9], const std::vector<Move>& moves);
+
+	/* remembers moves[i] as the plan of tasks[i], clearing the memory first unless all of them fit */
+	void remember(const std::vector<TileTask>& tasks, const std::vector<std::vector<Move>>& moves);
+
+	size_t size() const;
+
+	/* how often the memory was cleared */
+	uint64_t getGeneration() const;
+};
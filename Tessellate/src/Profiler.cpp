@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+#include "Profiler.hpp"
+
+Profiler::Profiler()
+	: current{}, historyHead(0), historyCount(0), queryIssued{}, pendingRows{}, frameIndex(0), lastGPUTime(0) {
+
+	for (std::vector<float>& h : history)
+		h.assign(WINDOW, 0.0f);
+
+	glGenQueries(QUERY_LATENCY, queries);
+
+	frameStart = Clock::now();
+}
+
+Profiler::~Profiler() {
+	stopCSV();
+	glDeleteQueries(QUERY_LATENCY, queries);
+}
+
+void Profiler::beginFrame(float frameTime) {
+	frameStart = Clock::now();
+	for (double& m : current)
+		m = 0;
+	current[FRAME_METRIC] = frameTime * 1000.0;
+}
+
+void Profiler::endFrame() {
+	current[CPU_METRIC] = toMilliseconds(Clock::now() - frameStart);
+
+	// park this frame's CPU times until its GPU time is known
+	size_t slot = frameIndex % QUERY_LATENCY;
+	for (size_t i = 0; i < N_METRICS; i++)
+		pendingRows[slot][i] = current[i];
+
+	frameIndex++;
+
+	// the slot the next frame will reuse holds the oldest query. By now the GPU is done with it
+	slot = frameIndex % QUERY_LATENCY;
+	if (queryIssued[slot]) {
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &elapsed);
+		queryIssued[slot] = false;
+
+		pendingRows[slot][GPU_METRIC] = elapsed / 1.0e6;
+		lastGPUTime = pendingRows[slot][GPU_METRIC];
+		pushHistory(pendingRows[slot]);
+		writeRow(frameIndex - QUERY_LATENCY, pendingRows[slot]);
+	}
+}
+
+void Profiler::begin(ProfileStage stage) {
+	stageStart[static_cast<int>(stage)] = Clock::now();
+}
+
+void Profiler::end(ProfileStage stage) {
+	current[static_cast<int>(stage)] += toMilliseconds(Clock::now() - stageStart[static_cast<int>(stage)]);
+}
+
+void Profiler::beginGPU() {
+	glBeginQuery(GL_TIME_ELAPSED, queries[frameIndex % QUERY_LATENCY]);
+}
+
+void Profiler::endGPU() {
+	glEndQuery(GL_TIME_ELAPSED);
+	queryIssued[frameIndex % QUERY_LATENCY] = true;
+}
+
+void Profiler::startCSV(const char* filepath) {
+	stopCSV();
+	csv.open(filepath, std::ios::out | std::ios::trunc);
+	if (!csv) {
+		std::cout << "Could not open " << filepath << " for writing." << std::endl;
+		return;
+	}
+	csv << "frame";
+	for (size_t i = 0; i < N_METRICS; i++)
+		csv << ',' << getMetricName(i) << "_ms";
+	csv << '\n';
+	std::cout << "Recording frame times to " << filepath << std::endl;
+}
+
+void Profiler::stopCSV() {
+	if (csv.is_open()) {
+		csv.close();
+		std::cout << "Stopped recording frame times." << std::endl;
+	}
+}
+
+bool Profiler::isRecordingCSV() const {
+	return csv.is_open();
+}
+
+float Profiler::getFrameCost() const {
+	double cpu = current[CPU_METRIC] - current[static_cast<int>(ProfileStage::SWAP)];
+	return static_cast<float>(std::max(cpu, lastGPUTime));
+}
+
+std::vector<std::string> Profiler::getSummary() const {
+	std::vector<std::string> lines;
+	char line[96];
+
+	float frame = percentile(FRAME_METRIC, 0.5f);
+	snprintf(line, sizeof(line), "FPS %.1f  FRAMES %zu%s", frame > 0 ? 1000.0f / frame : 0.0f, frameIndex, isRecordingCSV() ? "  [CSV]" : "");
+	lines.push_back(line);
+	lines.push_back("MS       P50    P95    P99");
+
+	for (size_t i = 0; i < N_METRICS; i++) {
+		snprintf(line, sizeof(line), "%-6s %6.2f %6.2f %6.2f", getMetricName(i),
+			percentile(i, 0.5f), percentile(i, 0.95f), percentile(i, 0.99f));
+		lines.push_back(line);
+	}
+	return lines;
+}
+
+void Profiler::pushHistory(const double metrics[N_METRICS]) {
+	for (size_t i = 0; i < N_METRICS; i++)
+		history[i][historyHead] = static_cast<float>(metrics[i]);
+	historyHead = (historyHead + 1) % WINDOW;
+	historyCount = std::min(historyCount + 1, WINDOW);
+}
+
+void Profiler::writeRow(size_t frame, const double metrics[N_METRICS]) {
+	if (!csv.is_open())
+		return;
+	csv << frame;
+	for (size_t i = 0; i < N_METRICS; i++)
+		csv << ',' << metrics[i];
+	csv << '\n';
+}
+
+float Profiler::percentile(size_t metric, float p) const {
+	if (historyCount == 0)
+		return 0;
+	// copy the filled part of the ring buffer and partially sort it
+	std::vector<float> samples(history[metric].begin(), history[metric].begin() + historyCount);
+	size_t k = static_cast<size_t>(p * (historyCount - 1) + 0.5f);
+	std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+	return samples[k];
+}
+
+const char* Profiler::getMetricName(size_t metric) {
+	static const char* const NAMES[N_METRICS] = { "input", "update", "pack", "upload", "draw", "swap", "cpu", "gpu", "frame" };
+	return NAMES[metric];
+}
+
+double Profiler::toMilliseconds(Clock::duration d) {
+	return std::chrono::duration<double, std::milli>(d).count();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+/* the parts of a frame that are timed on the CPU */
+enum class ProfileStage {
+	INPUT, UPDATE, PACK, UPLOAD, DRAW, SWAP
+};
+
+class Profiler {
+private:
+	using Clock = std::chrono::high_resolution_clock;
+
+	static const size_t N_STAGES = 6;
+	/* stages, then total CPU work, GPU time and full frame time */
+	static const size_t N_METRICS = N_STAGES + 3;
+	static const size_t CPU_METRIC = N_STAGES;
+	static const size_t GPU_METRIC = N_STAGES + 1;
+	static const size_t FRAME_METRIC = N_STAGES + 2;
+	/* how many frames of history the percentiles are computed over */
+	static const size_t WINDOW = 240;
+	/* GPU timer results are read back this many frames after they were issued so the CPU never stalls on them */
+	static const size_t QUERY_LATENCY = 4;
+
+	Clock::time_point frameStart;
+	Clock::time_point stageStart[N_STAGES];
+	/* milliseconds spent in each metric during the current frame */
+	double current[N_METRICS];
+	/* ring buffers of the last WINDOW frames, one per metric */
+	std::vector<float> history[N_METRICS];
+	size_t historyHead, historyCount;
+
+	GLuint queries[QUERY_LATENCY];
+	bool queryIssued[QUERY_LATENCY];
+	/* CPU-side rows waiting for their GPU time before they are written to the CSV */
+	double pendingRows[QUERY_LATENCY][N_METRICS];
+	size_t frameIndex;
+	double lastGPUTime;
+
+	std::ofstream csv;
+public:
+	/* requires a current OpenGL context */
+	Profiler();
+	~Profiler();
+
+	/* marks the start of a frame. frameTime is the full duration of the previous frame in seconds */
+	void beginFrame(float frameTime);
+
+	/* marks the end of the CPU work of a frame */
+	void endFrame();
+
+	/* begin/end timing of a stage. A stage may be entered several times per frame; its times are summed */
+	void begin(ProfileStage stage);
+	void end(ProfileStage stage);
+
+	/* wraps the GPU commands that should be measured with a GL_TIME_ELAPSED query */
+	void beginGPU();
+	void endGPU();
+
+	/* starts streaming one row per frame to a CSV file */
+	void startCSV(const char* filepath);
+
+	void stopCSV();
+
+	bool isRecordingCSV() const;
+
+	/* cost of the last completed frame in milliseconds: the larger of its CPU work (excluding the swap, which may wait for vsync)
+	   and the most recent GPU time */
+	float getFrameCost() const;
+
+	/* returns human-readable lines with p50/p95/p99 of every metric, in milliseconds */
+	std::vector<std::string> getSummary() const;
+
+private:
+	void pushHistory(const double metrics[N_METRICS]);
+
+	void writeRow(size_t frame, const double metrics[N_METRICS]);
+
+	/* returns the p-th percentile (0..1) of a metric's history */
+	float percentile(size_t metric, float p) const;
+
+	static const char* getMetricName(size_t metric);
+
+	static double toMilliseconds(Clock::duration d);
+};
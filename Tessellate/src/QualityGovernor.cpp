@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+#include "QualityGovernor.hpp"
+
+namespace {
+	/* from best to cheapest */
+	const QualitySettings LADDER[] = {
+		{ 1.00f, 4, false },
+		{ 0.85f, 4, false },
+		{ 0.70f, 4, false },
+		{ 0.50f, 4, false },
+		{ 0.50f, 2, false },
+		{ 0.50f, 0, false },
+		{ 0.50f, 0, true },
+	};
+	const size_t N_LEVELS = sizeof(LADDER) / sizeof(LADDER[0]);
+
+	const size_t WINDOW_FRAMES = 30; // frames averaged per decision
+	const float OVER_BUDGET = 0.95f; // step down when the average cost exceeds this fraction of the frame budget
+	const float UNDER_BUDGET = 0.60f; // count as headroom below this fraction
+	const float MIN_HEADROOM = 2.0f; // seconds
+	const float MAX_HEADROOM = 30.0f;
+	const float COOLDOWN = 1.0f; // seconds
+	const float RAISE_PROBATION = 5.0f; // a drop within this many seconds of raising quality counts as oscillation
+}
+
+QualityGovernor::QualityGovernor(float targetFps)
+	: targetFps(targetFps), enabled(true), level(0), windowCost(0), windowFrames(0), headroomTime(0), cooldown(0), requiredHeadroom(MIN_HEADROOM), sinceRaise(RAISE_PROBATION) {}
+
+bool QualityGovernor::update(float frameCost, float deltatime) {
+	if (!enabled)
+		return false;
+
+	sinceRaise += deltatime;
+	if (cooldown > 0) {
+		cooldown -= deltatime;
+		return false;
+	}
+
+	windowCost += frameCost;
+	windowFrames++;
+	if (windowFrames < WINDOW_FRAMES)
+		return false;
+
+	float average = windowCost / windowFrames;
+	float windowTime = average * windowFrames / 1000.0f;
+	windowCost = 0;
+	windowFrames = 0;
+
+	float budget = 1000.0f / targetFps;
+
+	if (average > budget * OVER_BUDGET) {
+		headroomTime = 0;
+		if (level + 1 < N_LEVELS) {
+			// if we just raised quality and it did not hold, be more reluctant next time
+			if (sinceRaise < RAISE_PROBATION)
+				requiredHeadroom = std::min(requiredHeadroom * 2, MAX_HEADROOM);
+			changeLevel(level + 1);
+			return true;
+		}
+	} else if (average < budget * UNDER_BUDGET) {
+		headroomTime += std::max(windowTime, WINDOW_FRAMES / targetFps);
+		if (level > 0 && headroomTime >= requiredHeadroom) {
+			headroomTime = 0;
+			sinceRaise = 0;
+			changeLevel(level - 1);
+			return true;
+		}
+	} else {
+		// within budget but without room to spare: stay here and slowly forget past oscillation
+		headroomTime = 0;
+		requiredHeadroom = std::max(MIN_HEADROOM, requiredHeadroom * 0.9f);
+	}
+	return false;
+}
+
+QualitySettings QualityGovernor::getSettings() const {
+	return LADDER[enabled ? level : 0];
+}
+
+float QualityGovernor::getTargetFps() const {
+	return targetFps;
+}
+
+void QualityGovernor::setTargetFps(float fps) {
+	targetFps = std::max(1.0f, fps);
+	headroomTime = 0;
+	windowCost = 0;
+	windowFrames = 0;
+	std::cout << "Target frame rate: " << targetFps << " fps" << std::endl;
+}
+
+bool QualityGovernor::isEnabled() const {
+	return enabled;
+}
+
+void QualityGovernor::setEnabled(bool enabled) {
+	this->enabled = enabled;
+	level = 0;
+	headroomTime = 0;
+	windowCost = 0;
+	windowFrames = 0;
+	requiredHeadroom = MIN_HEADROOM;
+}
+
+std::string QualityGovernor::describe() const {
+	QualitySettings s = getSettings();
+	char line[96];
+	snprintf(line, sizeof(line), "QUALITY %s %zu/%zu  SCALE %.2f  MSAA %d  LOD %s  TARGET %.0f",
+		enabled ? "AUTO" : "FIXED", N_LEVELS - 1 - (enabled ? level : 0), N_LEVELS - 1, s.resolutionScale, s.msaaSamples, s.lod ? "ON" : "OFF", targetFps);
+	return line;
+}
+
+void QualityGovernor::changeLevel(size_t newLevel) {
+	level = newLevel;
+	cooldown = COOLDOWN;
+	windowCost = 0;
+	windowFrames = 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+
+/* what the renderer should do this frame */
+struct QualitySettings {
+	float resolutionScale; // fraction of the window resolution the scene is rendered at
+	int msaaSamples; // 0 disables multisampling
+	bool lod; // idle cubes only draw the faces that point towards the camera
+};
+
+/* Watches frame cost and steps render quality down when the target frame rate is missed, and back up when there is headroom.
+   Quality is lowered in order: render resolution, then MSAA samples, then LOD. */
+class QualityGovernor {
+private:
+	float targetFps;
+	bool enabled;
+	size_t level; // index into the quality ladder. 0 is the highest quality
+	/* frame costs collected for the current measurement window */
+	float windowCost;
+	size_t windowFrames;
+	/* seconds of uninterrupted headroom, required before quality is raised */
+	float headroomTime;
+	/* seconds to wait after a change before the next decision, so the new level can be measured */
+	float cooldown;
+	/* grows every time raising quality had to be undone, so that the governor settles instead of oscillating */
+	float requiredHeadroom;
+	float sinceRaise; // seconds since quality was last raised
+public:
+	QualityGovernor(float targetFps = 60.0f);
+
+	/* feed the cost of the last frame in milliseconds (work only, excluding any frame cap).
+	   Returns true when the settings changed */
+	bool update(float frameCost, float deltatime);
+
+	QualitySettings getSettings() const;
+
+	float getTargetFps() const;
+
+	void setTargetFps(float fps);
+
+	bool isEnabled() const;
+
+	/* a disabled governor always returns the highest quality */
+	void setEnabled(bool enabled);
+
+	/* one line for the HUD */
+	std::string describe() const;
+
+private:
+	void changeLevel(size_t newLevel);
+};
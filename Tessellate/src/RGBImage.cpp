@@ -0,0 +1,81 @@
+#include <algorithm>
+
+#include "RGBImage.hpp"
+#include "AreaResampler.hpp"
+#include "ErrorDiffuser.hpp"
+#include "JobSystem.hpp"
+
+RGBImage::RGBImage(size_t width, size_t height)
+	: width(width), height(height), pixels(width * height * CHANNELS, 0.0f) {}
+
+RGBImage::RGBImage(size_t width, size_t height, const unsigned char rgb[])
+	: RGBImage(width, height) {
+	for (size_t i = 0; i < width * height; i++) {
+		pixels[i * CHANNELS + 0] = rgb[i * 3 + 0];
+		pixels[i * CHANNELS + 1] = rgb[i * 3 + 1];
+		pixels[i * CHANNELS + 2] = rgb[i * 3 + 2];
+	}
+}
+
+RGBImage::RGBImage(const ImageSource& source)
+	: RGBImage(source.getWidth(), source.getHeight()) {
+	std::vector<unsigned char> rgb(width * 3);
+	for (size_t y = 0; y < height; y++) {
+		source.getRGBRow(y, rgb.data());
+		for (size_t x = 0; x < width; x++)
+			for (size_t c = 0; c < 3; c++)
+				at(x, y)[c] = rgb[x * 3 + c];
+	}
+}
+
+size_t RGBImage::getWidth() const {
+	return width;
+}
+
+size_t RGBImage::getHeight() const {
+	return height;
+}
+
+float* RGBImage::at(size_t x, size_t y) {
+	return &pixels[(y * width + x) * CHANNELS];
+}
+
+const float* RGBImage::at(size_t x, size_t y) const {
+	return &pixels[(y * width + x) * CHANNELS];
+}
+
+RGBImage RGBImage::resize(size_t newWidth, size_t newHeight) const {
+	AreaResampler horizontal(width, newWidth);
+	AreaResampler vertical(height, newHeight);
+
+	// horizontal pass: every source row shrinks to newWidth
+	RGBImage narrow(newWidth, height);
+	for (size_t y = 0; y < height; y++)
+		horizontal.resampleRow(at(0, y), narrow.at(0, y));
+
+	// vertical pass: whole rows are accumulated at once
+	RGBImage result(newWidth, newHeight);
+	for (size_t y = 0; y < newHeight; y++)
+		for (const AreaResampler::Tap* t = vertical.tapsBegin(y); t != vertical.tapsEnd(y); t++)
+			AreaResampler::addScaled(narrow.at(0, t->index), t->weight, result.at(0, y), newWidth * CHANNELS);
+	return result;
+}
+
+void RGBImage::dither(Color output[], const ColorQuantizer& quantizer, DitherMode mode) const {
+	if (mode == DitherMode::ERROR_DIFFUSION) { // each pixel depends on the ones before it
+		ErrorDiffuser diffuser(width, quantizer);
+		for (size_t y = 0; y < height; y++)
+			diffuser.ditherRow(at(0, y), output + y * width);
+		return;
+	}
+
+	ThresholdDitherer ditherer(mode, quantizer);
+	auto ditherRows = [&](size_t first, size_t last) {
+		for (size_t y = first; y < last; y++)
+			ditherer.ditherRow(at(0, y), width, y, output + y * width);
+	};
+
+	// jobs take bands of rows, big enough to pay for scheduling them
+	static const size_t MIN_PIXELS_PER_JOB = 1 << 15;
+	JobSystem::shared().parallelFor(height, std::max<size_t>(1, MIN_PIXELS_PER_JOB / std::max<size_t>(width, 1)), ditherRows);
+}
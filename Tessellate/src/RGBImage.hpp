@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+#include "ImageSource.hpp"
+#include "ColorQuantizer.hpp"
+#include "ThresholdDitherer.hpp"
+
+/* A floating point RGB image used to prepare pictures for the grid: downscale to the grid's sticker resolution, then
+   dither to the cube palette. Pixels are stored row-major, top row first, as 4 floats (r, g, b, unused) in 0..255
+   so a whole pixel fits one SIMD register. */
+class RGBImage {
+public:
+	static const size_t CHANNELS = 4;
+private:
+	size_t width, height;
+	std::vector<float> pixels;
+public:
+	/* black image */
+	RGBImage(size_t width, size_t height);
+
+	/* copies 8-bit interleaved rgb data, row-major, top row first */
+	RGBImage(size_t width, size_t height, const unsigned char rgb[]);
+
+	/* copies a whole image */
+	RGBImage(const ImageSource& source);
+
+	size_t getWidth() const;
+	size_t getHeight() const;
+
+	/* returns the first channel of the pixel at (x, y) */
+	float* at(size_t x, size_t y);
+	const float* at(size_t x, size_t y) const;
+
+	/* returns a copy scaled to width x height. Every output pixel is the coverage-weighted average of the source pixels
+	   under it, so detail is averaged instead of aliased when shrinking */
+	RGBImage resize(size_t width, size_t height) const;
+
+	/* maps every pixel to a sticker color and writes width * height colors to output.
+	   Error diffusion processes rows top to bottom with an error buffer of only two rows, diffusing the difference to the sticker's own color.
+	   Threshold modes split the rows across all hardware threads */
+	void dither(Color output[], const ColorQuantizer& quantizer, DitherMode mode = DitherMode::ERROR_DIFFUSION) const;
+};
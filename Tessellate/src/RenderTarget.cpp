@@ -0,0 +1,88 @@
+#include <algorithm>
+
+#include "RenderTarget.hpp"
+
+RenderTarget::RenderTarget()
+	: msaaFBO(0), msaaColor(0), msaaDepth(0), resolveFBO(0), resolveColor(0), resolveDepth(0), width(0), height(0), samples(0), maxSamples(0) {
+	glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+}
+
+RenderTarget::~RenderTarget() {
+	release();
+}
+
+void RenderTarget::bind(int windowWidth, int windowHeight, float scale, int samples) {
+	int w = std::max(1, static_cast<int>(windowWidth * scale));
+	int h = std::max(1, static_cast<int>(windowHeight * scale));
+	samples = std::min(samples, static_cast<int>(maxSamples));
+
+	// only reallocate when something changed
+	if (w != width || h != height || samples != this->samples)
+		allocate(w, h, samples);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, samples > 0 ? msaaFBO : resolveFBO);
+	glViewport(0, 0, width, height);
+}
+
+void RenderTarget::resolve(int windowWidth, int windowHeight) {
+	// resolve samples at the offscreen resolution (MSAA blits may not scale)
+	if (samples > 0) {
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, msaaFBO);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolveFBO);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	}
+
+	// upsample to the window
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, resolveFBO);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, width, height, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT, width == windowWidth && height == windowHeight ? GL_NEAREST : GL_LINEAR);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, windowWidth, windowHeight);
+}
+
+void RenderTarget::allocate(int width, int height, int samples) {
+	release();
+	this->width = width;
+	this->height = height;
+	this->samples = samples;
+
+	// single-sampled target. Depth is only needed here when there is no MSAA buffer to draw into
+	glGenFramebuffers(1, &resolveFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, resolveFBO);
+	glGenRenderbuffers(1, &resolveColor);
+	glBindRenderbuffer(GL_RENDERBUFFER, resolveColor);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, resolveColor);
+	if (samples == 0) {
+		glGenRenderbuffers(1, &resolveDepth);
+		glBindRenderbuffer(GL_RENDERBUFFER, resolveDepth);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, resolveDepth);
+	}
+
+	// multisampled target
+	if (samples > 0) {
+		glGenFramebuffers(1, &msaaFBO);
+		glBindFramebuffer(GL_FRAMEBUFFER, msaaFBO);
+		glGenRenderbuffers(1, &msaaColor);
+		glBindRenderbuffer(GL_RENDERBUFFER, msaaColor);
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, msaaColor);
+		glGenRenderbuffers(1, &msaaDepth);
+		glBindRenderbuffer(GL_RENDERBUFFER, msaaDepth);
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH_COMPONENT24, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, msaaDepth);
+	}
+
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RenderTarget::release() {
+	GLuint renderbuffers[4] = { msaaColor, msaaDepth, resolveColor, resolveDepth };
+	GLuint framebuffers[2] = { msaaFBO, resolveFBO };
+	glDeleteRenderbuffers(4, renderbuffers); // zeros are silently ignored
+	glDeleteFramebuffers(2, framebuffers);
+	msaaFBO = msaaColor = msaaDepth = resolveFBO = resolveColor = resolveDepth = 0;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <GL/glew.h>
+
+/* Offscreen framebuffer the scene is rendered into at a fraction of the window resolution, with optional MSAA.
+   resolve() upsamples the result into the window's framebuffer. */
+class RenderTarget {
+private:
+	/* multisampled framebuffer, only used when samples > 0 */
+	GLuint msaaFBO;
+	GLuint msaaColor, msaaDepth;
+	/* single-sampled framebuffer that is blitted to the window */
+	GLuint resolveFBO;
+	GLuint resolveColor, resolveDepth;
+	int width, height; // size of the offscreen buffers in pixels
+	int samples;
+	GLint maxSamples;
+public:
+	/* requires a current OpenGL context */
+	RenderTarget();
+	~RenderTarget();
+
+	/* (re)allocates the buffers if needed and binds the framebuffer the scene should be drawn into.
+	   scale is the fraction of the window resolution to render at */
+	void bind(int windowWidth, int windowHeight, float scale, int samples);
+
+	/* resolves MSAA and upsamples the scene into the window's framebuffer, which is left bound */
+	void resolve(int windowWidth, int windowHeight);
+
+private:
+	void allocate(int width, int height, int samples);
+
+	void release();
+};
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <climits>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "ShardCoordinator.hpp"
+
+#ifdef _WIN32
+
+ShardCoordinator::ShardCoordinator(size_t nWorkers, const std::vector<std::string>& command, double shardTimeout)
+	: shardTimeout(shardTimeout), nextShard(0), nShards(0), nStolen(0), nRestarts(0) {
+	throw std::runtime_error("worker processes are not supported on Windows. Solving runs in the main process instead");
+}
+
+ShardCoordinator::~ShardCoordinator() {}
+
+bool ShardCoordinator::plan(const std::vector<TileTask>& tasks, const std::function<void(TilePlan&)>& onPlan, const std::atomic<bool>* cancelled) {
+	return false;
+}
+
+std::vector<std::string> ShardCoordinator::getWorkerCommand(const char* argv0) {
+	return { argv0, "--worker" };
+}
+
+void ShardCoordinator::spawn(Worker& worker) {}
+
+void ShardCoordinator::stop(Worker& worker) {}
+
+#else
+
+namespace {
+	/* how long plan sleeps in poll between checks of cancelled, in milliseconds */
+	const int POLL_INTERVAL = 50;
+}
+
+ShardCoordinator::ShardCoordinator(size_t nWorkers, const std::vector<std::string>& command, double shardTimeout)
+	: command(command), shardTimeout(shardTimeout), workers(std::max<size_t>(nWorkers, 1)), nextShard(0), nShards(0), nStolen(0), nRestarts(0) {
+	if (command.empty())
+		throw std::runtime_error("no worker command");
+	for (Worker& worker : workers)
+		spawn(worker);
+}
+
+ShardCoordinator::~ShardCoordinator() {
+	for (Worker& worker : workers)
+		stop(worker);
+}
+
+void ShardCoordinator::spawn(Worker& worker) {
+	int ends[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, ends) != 0)
+		throw std::runtime_error("could not create a socket for a worker");
+#ifdef SO_NOSIGPIPE
+	int on = 1;
+	setsockopt(ends[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+	fcntl(ends[0], F_SETFD, FD_CLOEXEC); // later workers must not inherit it, or a dead worker's socket would never close
+
+	std::vector<char*> argv;
+	for (const std::string& arg : command)
+		argv.push_back(const_cast<char*>(arg.c_str()));
+	argv.push_back(nullptr);
+
+	pid_t pid = fork();
+	if (pid < 0) {
+		close(ends[0]);
+		close(ends[1]);
+		throw std::runtime_error("could not start a worker");
+	}
+	if (pid == 0) { // the worker
+		dup2(ends[1], STDIN_FILENO);
+		dup2(ends[1], STDOUT_FILENO);
+		close(ends[0]);
+		close(ends[1]);
+		execvp(argv[0], argv.data());
+		_exit(127);
+	}
+
+	close(ends[1]);
+	worker.pid = pid;
+	worker.fd = ends[0];
+	worker.greeted = false;
+	worker.inFlight.clear();
+	worker.sent.clear();
+	worker.lastHeard = Clock::now();
+}
+
+void ShardCoordinator::stop(Worker& worker) {
+	if (worker.fd < 0)
+		return;
+	close(worker.fd);
+	worker.fd = -1;
+	// a healthy worker exits when its stdin closes. One that does not is stuck
+	for (int i = 0; i < 20 && waitpid(worker.pid, nullptr, WNOHANG) == 0; i++)
+		usleep(5000);
+	if (waitpid(worker.pid, nullptr, WNOHANG) == 0) {
+		kill(worker.pid, SIGKILL);
+		waitpid(worker.pid, nullptr, 0);
+	}
+}
+
+bool ShardCoordinator::plan(const std::vector<TileTask>& tasks, const std::function<void(TilePlan&)>& onPlan, const std::atomic<bool>* cancelled) {
+	std::lock_guard<std::mutex> lock(planning);
+
+	// shard i covers tasks [i * SHARD_TILES, (i + 1) * SHARD_TILES) and has id firstShard + i.
+	// Ids keep counting across solves, so answers to a cancelled solve are recognized and dropped
+	size_t count = (tasks.size() + SHARD_TILES - 1) / SHARD_TILES;
+	uint32_t firstShard = nextShard;
+	nextShard += static_cast<uint32_t>(count);
+	std::vector<unsigned char> done(count, 0), stolen(count, 0);
+	std::vector<size_t> attempts(count, 0);
+	std::deque<size_t> queue;
+	for (size_t i = 0; i < count; i++)
+		queue.push_back(i);
+	size_t nDone = 0;
+
+	auto toIndex = [&](uint32_t id) { return static_cast<size_t>(static_cast<uint32_t>(id - firstShard)); }; // >= count if not ours
+	std::vector<unsigned char> message;
+	auto restart = [&](Worker& worker) {
+		// its unanswered shards of this solve go first, so whatever crashed it is retried soon and given up on quickly
+		for (auto id = worker.inFlight.rbegin(); id != worker.inFlight.rend(); ++id) {
+			size_t i = toIndex(*id);
+			if (i < count && !done[i]) {
+				if (++attempts[i] >= MAX_ATTEMPTS)
+					throw std::runtime_error("shard " + std::to_string(i) + " crashed or hung " + std::to_string(MAX_ATTEMPTS) + " workers");
+				queue.push_front(i);
+			}
+		}
+		stop(worker);
+		spawn(worker);
+		nRestarts++;
+	};
+	// returns false if the worker is gone, in which case it was restarted and the shard queued again
+	auto send = [&](Worker& worker, size_t i) {
+		ShardProtocol::encodeShard(firstShard + static_cast<uint32_t>(i), tasks, i * SHARD_TILES, std::min(tasks.size(), (i + 1) * SHARD_TILES), message);
+		worker.inFlight.push_back(firstShard + static_cast<uint32_t>(i));
+		worker.sent.push_back(Clock::now());
+		if (ShardProtocol::writeMessage(worker.fd, message))
+			return true;
+		restart(worker);
+		return false;
+	};
+	// a worker starts on a shard when it was sent or when the worker answered the one before it, whichever came last
+	auto isHung = [&](const Worker& worker, Clock::time_point now) {
+		return !worker.inFlight.empty()
+			&& std::chrono::duration<double>(now - std::max(worker.sent.front(), worker.lastHeard)).count() > shardTimeout;
+	};
+
+	// answers to a cancelled solve may still wait unread in the sockets, and the workers were not slow to send them
+	for (Worker& worker : workers)
+		worker.lastHeard = Clock::now();
+
+	std::vector<pollfd> fds(workers.size());
+	std::vector<TilePlan> plans;
+	while (nDone < count) {
+		if (cancelled && *cancelled)
+			return false;
+
+		for (Worker& worker : workers) {
+			// keep every pipeline full. Shards another worker finished in the meantime are skipped
+			while (worker.inFlight.size() < PIPELINE && !queue.empty()) {
+				size_t i = queue.front();
+				queue.pop_front();
+				if (!done[i] && !send(worker, i))
+					break;
+			}
+			// out of work: steal the newest shard of the busiest worker, which it has not started yet
+			if (worker.inFlight.empty() && queue.empty()) {
+				Worker* busiest = nullptr;
+				for (Worker& other : workers)
+					if (other.inFlight.size() >= 2 && (!busiest || other.inFlight.size() > busiest->inFlight.size()))
+						busiest = &other;
+				if (busiest) {
+					size_t i = toIndex(busiest->inFlight.back());
+					if (i < count && !done[i] && !stolen[i] && send(worker, i)) {
+						stolen[i] = 1;
+						nStolen++;
+					}
+				}
+			}
+		}
+
+		Clock::time_point now = Clock::now();
+		for (Worker& worker : workers)
+			if (isHung(worker, now))
+				restart(worker);
+
+		for (size_t w = 0; w < workers.size(); w++)
+			fds[w] = { workers[w].fd, POLLIN, 0 };
+		if (poll(fds.data(), fds.size(), POLL_INTERVAL) <= 0)
+			continue;
+
+		for (size_t w = 0; w < workers.size(); w++) {
+			if (!(fds[w].revents & (POLLIN | POLLHUP | POLLERR)))
+				continue;
+			Worker& worker = workers[w];
+			ShardProtocol::Type type;
+			if (!ShardProtocol::readMessage(worker.fd, message) || !ShardProtocol::getType(message, type)) {
+				restart(worker);
+				continue;
+			}
+			worker.lastHeard = Clock::now();
+
+			if (type == ShardProtocol::Type::HELLO) {
+				uint32_t version;
+				if (!ShardProtocol::decodeHello(message, version) || version != ShardProtocol::VERSION)
+					throw std::runtime_error("a worker speaks another version of the shard protocol");
+				worker.greeted = true;
+				continue;
+			}
+
+			uint32_t id;
+			if (type != ShardProtocol::Type::PLANS || !worker.greeted || !ShardProtocol::decodePlans(message, id, plans)) {
+				restart(worker);
+				continue;
+			}
+			auto answered = std::find(worker.inFlight.begin(), worker.inFlight.end(), id);
+			if (answered != worker.inFlight.end()) {
+				worker.sent.erase(worker.sent.begin() + (answered - worker.inFlight.begin()));
+				worker.inFlight.erase(answered);
+			}
+			size_t i = toIndex(id);
+			if (i >= count || done[i]) // from a cancelled solve, or the loser of a steal
+				continue;
+			done[i] = 1;
+			nDone++;
+			nShards++;
+			for (TilePlan& plan : plans)
+				onPlan(plan);
+		}
+	}
+	return true;
+}
+
+std::vector<std::string> ShardCoordinator::getWorkerCommand(const char* argv0) {
+	// the path argv[0] was started with may be relative to another directory, or just a name on the PATH
+	char path[PATH_MAX];
+	ssize_t n = readlink("/proc/self/exe", path, sizeof(path) - 1);
+	if (n > 0)
+		return { std::string(path, n), "--worker" };
+	return { argv0, "--worker" };
+}
+
+#endif
+
+size_t ShardCoordinator::getWorkerCount() const {
+	return workers.size();
+}
+
+std::string ShardCoordinator::describe() const {
+	char line[96];
+	snprintf(line, sizeof(line), "WORKERS %zu | %zu SHARDS %zu STOLEN %zu RESTARTS", workers.size(), nShards.load(), nStolen.load(), nRestarts.load());
+	return line;
+}
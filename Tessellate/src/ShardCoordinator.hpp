@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ShardProtocol.hpp"
+
+/* Splits the tiles of a solve into shards and plans them in worker processes, each started from a command line
+   (by default this binary with --worker) and spoken to in ShardProtocol over a socket pair on its stdin and stdout.
+   Any command that ends up running a worker works, so "ssh host tessellate --worker" would reach another machine.
+   Every worker keeps up to PIPELINE shards in flight so it never waits on the coordinator. A worker that runs dry while others
+   still have shards queued steals the last one of the busiest: it is planned twice and the first answer wins.
+   A worker that dies, or does not answer the shard it is on within the shard timeout, is started again and its unfinished shards
+   go back to the front of the queue. POSIX only */
+class ShardCoordinator {
+public:
+	/* tiles per shard */
+	static const size_t SHARD_TILES = 64;
+	/* shards sent to a worker before its first answer comes back */
+	static const size_t PIPELINE = 2;
+	/* workers a shard may take down before it is given up on */
+	static const size_t MAX_ATTEMPTS = 3;
+	/* default seconds a worker may spend on one shard before it is taken to be hung */
+	static constexpr double SHARD_TIMEOUT = 30;
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Worker {
+		int pid;
+		int fd;
+		bool greeted; // HELLO arrived
+		std::deque<uint32_t> inFlight; // ids of the shards sent and not yet answered, oldest first
+		std::deque<Clock::time_point> sent; // when each of inFlight was sent
+		Clock::time_point lastHeard; // when the last message arrived, or the worker was started
+
+		Worker() : pid(-1), fd(-1), greeted(false) {}
+	};
+
+	std::vector<std::string> command;
+	double shardTimeout;
+	std::vector<Worker> workers;
+	std::mutex planning; // one solve at a time
+	uint32_t nextShard;
+	std::atomic<size_t> nShards, nStolen, nRestarts; // read by describe while plan runs on another thread
+public:
+	/* starts nWorkers workers with command. A worker that takes longer than shardTimeout seconds on a shard is restarted.
+	   throws std::runtime_error if they cannot be started, and on Windows */
+	ShardCoordinator(size_t nWorkers, const std::vector<std::string>& command, double shardTimeout = SHARD_TIMEOUT);
+
+	/* hangs up on the workers, which then exit */
+	~ShardCoordinator();
+
+	ShardCoordinator(const ShardCoordinator&) = delete;
+	ShardCoordinator& operator=(const ShardCoordinator&) = delete;
+
+	/* plans every task on the workers. onPlan is called on the calling thread with each tile's plan as its shard comes back.
+	   Returns false as soon as cancelled is set, and true once every tile was handed to onPlan.
+	   throws std::runtime_error if a shard keeps crashing or hanging workers, or a worker speaks another protocol version */
+	bool plan(const std::vector<TileTask>& tasks, const std::function<void(TilePlan&)>& onPlan, const std::atomic<bool>* cancelled = nullptr);
+
+	size_t getWorkerCount() const;
+
+	/* a line for the HUD: workers, shards planned, shards stolen and workers restarted */
+	std::string describe() const;
+
+	/* the command that starts this binary as a worker. argv0 is used where the running executable cannot be found otherwise */
+	static std::vector<std::string> getWorkerCommand(const char* argv0);
+
+private:
+	/* starts the process of worker */
+	void spawn(Worker& worker);
+
+	/* closes the connection to worker, kills it if it still runs and waits for it to exit */
+	void stop(Worker& worker);
+};
@@ -0,0 +1,211 @@
+#include <cerrno>
+#include <cstdint>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#ifndef MSG_NOSIGNAL // macOS sets SO_NOSIGPIPE on the socket instead (see ShardCoordinator)
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+#include "ShardProtocol.hpp"
+
+namespace {
+	void putU16(std::vector<unsigned char>& out, uint32_t v) {
+		out.push_back(v & 0xFF);
+		out.push_back((v >> 8) & 0xFF);
+	}
+
+	void putU32(std::vector<unsigned char>& out, uint32_t v) {
+		for (int i = 0; i < 4; i++)
+			out.push_back((v >> (8 * i)) & 0xFF);
+	}
+
+	/* reads little-endian fields out of a message of one type, failing once it would run past the end.
+	   A message that is empty or of another type fails on the first read */
+	class Reader {
+	private:
+		const std::vector<unsigned char>& in;
+		size_t at;
+	public:
+		Reader(const std::vector<unsigned char>& in, ShardProtocol::Type type)
+			: in(in), at(1) { // past the type
+			if (in.empty() || in[0] != static_cast<unsigned char>(type))
+				at = SIZE_MAX;
+		}
+
+		bool u16(uint32_t& v) {
+			if (at > in.size() || in.size() - at < 2)
+				return false;
+			v = in[at] | in[at + 1] << 8;
+			at += 2;
+			return true;
+		}
+
+		bool u32(uint32_t& v) {
+			if (at > in.size() || in.size() - at < 4)
+				return false;
+			v = in[at] | in[at + 1] << 8 | in[at + 2] << 16 | static_cast<uint32_t>(in[at + 3]) << 24;
+			at += 4;
+			return true;
+		}
+
+		/* n bytes, each below limit */
+		bool bytes(unsigned char* out, size_t n, unsigned char limit) {
+			if (at > in.size() || in.size() - at < n)
+				return false;
+			for (size_t i = 0; i < n; i++) {
+				if (in[at + i] >= limit)
+					return false;
+				out[i] = in[at + i];
+			}
+			at += n;
+			return true;
+		}
+
+		bool isAtEnd() const {
+			return at == in.size();
+		}
+	};
+
+#ifndef _WIN32
+	bool readFully(int fd, unsigned char* data, size_t n) {
+		while (n > 0) {
+			ssize_t got = read(fd, data, n);
+			if (got < 0 && errno == EINTR)
+				continue;
+			if (got <= 0)
+				return false;
+			data += got;
+			n -= got;
+		}
+		return true;
+	}
+
+	bool writeFully(int fd, const unsigned char* data, size_t n) {
+		while (n > 0) {
+			// a worker that died must not take the coordinator down with SIGPIPE
+			ssize_t put = send(fd, data, n, MSG_NOSIGNAL);
+			if (put < 0 && errno == ENOTSOCK)
+				put = write(fd, data, n);
+			if (put < 0 && errno == EINTR)
+				continue;
+			if (put <= 0)
+				return false;
+			data += put;
+			n -= put;
+		}
+		return true;
+	}
+#endif
+}
+
+void ShardProtocol::encodeHello(std::vector<unsigned char>& message) {
+	message.clear();
+	message.push_back(static_cast<unsigned char>(Type::HELLO));
+	putU32(message, VERSION);
+}
+
+void ShardProtocol::encodeShard(uint32_t shard, const std::vector<TileTask>& tasks, size_t first, size_t last, std::vector<unsigned char>& message) {
+	message.clear();
+	message.reserve(9 + (last - first) * (4 + 54 + 9));
+	message.push_back(static_cast<unsigned char>(Type::SHARD));
+	putU32(message, shard);
+	putU32(message, static_cast<uint32_t>(last - first));
+	for (size_t i = first; i < last; i++) {
+		putU32(message, tasks[i].tile);
+		for (Color c : tasks[i].start.stickers)
+			message.push_back(static_cast<unsigned char>(c));
+		for (Color c : tasks[i].pattern)
+			message.push_back(static_cast<unsigned char>(c));
+	}
+}
+
+void ShardProtocol::encodePlans(uint32_t shard, const std::vector<TilePlan>& plans, std::vector<unsigned char>& message) {
+	message.clear();
+	message.push_back(static_cast<unsigned char>(Type::PLANS));
+	putU32(message, shard);
+	putU32(message, static_cast<uint32_t>(plans.size()));
+	for (const TilePlan& plan : plans) {
+		putU32(message, plan.tile);
+		putU16(message, static_cast<uint32_t>(plan.moves.size()));
+		for (Move move : plan.moves)
+			message.push_back(static_cast<unsigned char>(move));
+	}
+}
+
+bool ShardProtocol::getType(const std::vector<unsigned char>& message, Type& type) {
+	if (message.empty())
+		return false;
+	type = static_cast<Type>(message[0]);
+	return type == Type::HELLO || type == Type::SHARD || type == Type::PLANS;
+}
+
+bool ShardProtocol::decodeHello(const std::vector<unsigned char>& message, uint32_t& version) {
+	Reader in(message, Type::HELLO);
+	return in.u32(version) && in.isAtEnd();
+}
+
+bool ShardProtocol::decodeShard(const std::vector<unsigned char>& message, uint32_t& shard, std::vector<TileTask>& tasks) {
+	Reader in(message, Type::SHARD);
+	uint32_t n;
+	if (!in.u32(shard) || !in.u32(n) || n > message.size() / (4 + 54 + 9))
+		return false;
+	tasks.resize(n);
+	for (TileTask& task : tasks) {
+		if (!in.u32(task.tile)
+			|| !in.bytes(reinterpret_cast<unsigned char*>(task.start.stickers), 54, 6)
+			|| !in.bytes(reinterpret_cast<unsigned char*>(task.pattern), 9, 6))
+			return false;
+	}
+	return in.isAtEnd();
+}
+
+bool ShardProtocol::decodePlans(const std::vector<unsigned char>& message, uint32_t& shard, std::vector<TilePlan>& plans) {
+	Reader in(message, Type::PLANS);
+	uint32_t n;
+	if (!in.u32(shard) || !in.u32(n) || n > message.size() / (4 + 2))
+		return false;
+	plans.resize(n);
+	for (TilePlan& plan : plans) {
+		uint32_t nMoves;
+		if (!in.u32(plan.tile) || !in.u16(nMoves))
+			return false;
+		plan.moves.resize(nMoves);
+		if (!in.bytes(reinterpret_cast<unsigned char*>(plan.moves.data()), nMoves, N_MOVES))
+			return false;
+	}
+	return in.isAtEnd();
+}
+
+#ifdef _WIN32
+
+bool ShardProtocol::readMessage(int fd, std::vector<unsigned char>& message) {
+	return false;
+}
+
+bool ShardProtocol::writeMessage(int fd, const std::vector<unsigned char>& message) {
+	return false;
+}
+
+#else
+
+bool ShardProtocol::readMessage(int fd, std::vector<unsigned char>& message) {
+	unsigned char length[4];
+	if (!readFully(fd, length, 4))
+		return false;
+	uint32_t n = length[0] | length[1] << 8 | length[2] << 16 | static_cast<uint32_t>(length[3]) << 24;
+	if (n > MAX_MESSAGE)
+		return false;
+	message.resize(n);
+	return readFully(fd, message.data(), n);
+}
+
+bool ShardProtocol::writeMessage(int fd, const std::vector<unsigned char>& message) {
+	std::vector<unsigned char> length;
+	putU32(length, static_cast<uint32_t>(message.size()));
+	return writeFully(fd, length.data(), 4) && writeFully(fd, message.data(), message.size());
+}
+
+#endif
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CubeState.hpp"
+
+/* a tile to plan: the cube's stickers to start from and the pattern to paint on its UP face */
+struct TileTask {
+	uint32_t tile; // index of the cube in the grid
+	CubeState start;
+	Color pattern[9];
+};
+
+/* the moves that paint a tile */
+struct TilePlan {
+	uint32_t tile;
+	std::vector<Move> moves;
+};
+
+/* The binary protocol between a ShardCoordinator and its workers. Every message is framed by its length as a little-endian uint32,
+   so the protocol runs over any byte stream: pipes and local sockets today, TCP to another machine later.
+   A worker greets with HELLO. The coordinator then sends SHARD messages, each a batch of tiles, and the worker answers each with PLANS:
+	HELLO  'H', uint32 version
+	SHARD  'S', uint32 shard id, uint32 n, n * (uint32 tile, 54 sticker bytes, 9 pattern bytes)
+	PLANS  'P', uint32 shard id, uint32 n, n * (uint32 tile, uint16 m, m move bytes)
+   Stickers and patterns are Color values and moves are Move values, one byte each */
+class ShardProtocol {
+public:
+	/* bumped whenever the messages or the planner change, so a coordinator never mixes plans from different solvers */
+	static const uint32_t VERSION = 1;
+
+	/* longest message either side accepts */
+	static const uint32_t MAX_MESSAGE = 64 * 1024 * 1024;
+
+	enum class Type : unsigned char {
+		HELLO = 'H', SHARD = 'S', PLANS = 'P'
+	};
+
+	static void encodeHello(std::vector<unsigned char>& message);
+
+	/* encodes tasks[first, last) */
+	static void encodeShard(uint32_t shard, const std::vector<TileTask>& tasks, size_t first, size_t last, std::vector<unsigned char>& message);
+
+	static void encodePlans(uint32_t shard, const std::vector<TilePlan>& plans, std::vector<unsigned char>& message);
+
+	/* the type of a message, or false if it is empty or unknown */
+	static bool getType(const std::vector<unsigned char>& message, Type& type);
+
+	/* these return false if the message is malformed, empty or of another type */
+	static bool decodeHello(const std::vector<unsigned char>& message, uint32_t& version);
+	static bool decodeShard(const std::vector<unsigned char>& message, uint32_t& shard, std::vector<TileTask>& tasks);
+	static bool decodePlans(const std::vector<unsigned char>& message, uint32_t& shard, std::vector<TilePlan>& plans);
+
+	/* blocks until a whole message is read from fd. Returns false at the end of the stream, on errors and on oversized messages */
+	static bool readMessage(int fd, std::vector<unsigned char>& message);
+
+	/* blocks until the message and its length are written to fd. Returns false if the other end is gone */
+	static bool writeMessage(int fd, const std::vector<unsigned char>& message);
+};
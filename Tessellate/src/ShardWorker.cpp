@@ -0,0 +1,55 @@
+#include <iostream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "ShardWorker.hpp"
+#include "ShardProtocol.hpp"
+#include "AI.hpp"
+
+#ifdef _WIN32
+
+int ShardWorker::run() {
+	std::cerr << "Worker processes are not supported on Windows. Solving runs in the main process instead." << std::endl;
+	return 1;
+}
+
+#else
+
+int ShardWorker::run() {
+	// keep the protocol to a descriptor of its own and point stdout at stderr, so stray prints (the AI has a few) go there
+	int in = STDIN_FILENO;
+	int out = dup(STDOUT_FILENO);
+	dup2(STDERR_FILENO, STDOUT_FILENO);
+
+	std::vector<unsigned char> message;
+	ShardProtocol::encodeHello(message);
+	if (!ShardProtocol::writeMessage(out, message))
+		return 1;
+
+	std::vector<TileTask> tasks;
+	std::vector<TilePlan> plans;
+	while (ShardProtocol::readMessage(in, message)) {
+		uint32_t shard;
+		if (!ShardProtocol::decodeShard(message, shard, tasks)) {
+			std::cerr << "Worker: malformed shard. Exiting." << std::endl;
+			return 1;
+		}
+
+		plans.resize(tasks.size());
+		for (size_t i = 0; i < tasks.size(); i++) {
+			AI ai(tasks[i].start.stickers);
+			ai.calculatePaint(tasks[i].pattern);
+			plans[i].tile = tasks[i].tile;
+			plans[i].moves.assign(ai.getInstructions().begin(), ai.getInstructions().end());
+		}
+
+		ShardProtocol::encodePlans(shard, plans, message);
+		if (!ShardProtocol::writeMessage(out, message))
+			return 1;
+	}
+	return 0;
+}
+
+#endif
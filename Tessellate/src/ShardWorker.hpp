@@ -0,0 +1,10 @@
+#pragma once
+
+/* The worker side of multi-process solving: what the binary runs when started with --worker by a ShardCoordinator.
+   Plans the shards it reads with the AI and writes back their moves, until the coordinator hangs up */
+class ShardWorker {
+public:
+	/* speaks ShardProtocol over stdin and stdout, and sends everything else written to stdout to stderr so it cannot corrupt a message.
+	   Returns the process exit code */
+	static int run();
+};
@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "SolutionCache.hpp"
+#include "Choreography.hpp"
+#include "MappedFile.hpp"
+#include "XXHash.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+	const char* const MAGIC = "TSOL";
+	const uint32_t FORMAT_VERSION = 1;
+	const char* const EXTENSION = ".tsol";
+	const size_t HEADER_BYTES = 4 + 4 * 4 + 8 + 54;
+
+	long long getProcessId() {
+#ifdef _WIN32
+		return _getpid();
+#else
+		return getpid();
+#endif
+	}
+
+	void putU16(std::vector<unsigned char>& out, uint32_t v) {
+		out.push_back(v & 0xFF);
+		out.push_back((v >> 8) & 0xFF);
+	}
+
+	void putU32(std::vector<unsigned char>& out, uint32_t v) {
+		for (int i = 0; i < 4; i++)
+			out.push_back((v >> (8 * i)) & 0xFF);
+	}
+
+	void putU64(std::vector<unsigned char>& out, uint64_t v) {
+		for (int i = 0; i < 8; i++)
+			out.push_back((v >> (8 * i)) & 0xFF);
+	}
+
+	uint32_t getU16(const unsigned char* in) {
+		return in[0] | (in[1] << 8);
+	}
+
+	uint32_t getU32(const unsigned char* in) {
+		return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+	}
+
+	uint64_t getU64(const unsigned char* in) {
+		return getU32(in) | (static_cast<uint64_t>(getU32(in + 4)) << 32);
+	}
+
+	const CubeState& getStart(const std::vector<TileTask>& tasks) {
+		return tasks.empty() ? CubeState::standard() : tasks[0].start;
+	}
+}
+
+SolutionCache::SolutionCache(const std::string& directory, uintmax_t maxBytes)
+	: directory(directory), maxBytes(maxBytes), memory(std::make_shared<PatternMemory>()), absorbedGeneration(0), nHits(0), nMisses(0), nReused(0) {
+	std::error_code error;
+	fs::create_directories(directory, error);
+	if (!fs::is_directory(directory, error))
+		throw std::runtime_error("cannot create cache directory " + directory);
+	evict(); // the limit may be lower than last time
+}
+
+uint64_t SolutionCache::getKey(size_t rows, size_t cols, const std::vector<TileTask>& tasks) {
+	std::vector<unsigned char> content;
+	content.reserve(16 + 54 + tasks.size() * 9);
+	putU32(content, SOLVER_VERSION);
+	putU32(content, static_cast<uint32_t>(rows));
+	putU32(content, static_cast<uint32_t>(cols));
+	for (Color color : getStart(tasks).stickers)
+		content.push_back(static_cast<unsigned char>(color));
+	for (const TileTask& task : tasks)
+		for (Color color : task.pattern)
+			content.push_back(static_cast<unsigned char>(color));
+	return xxHash64(content.data(), content.size());
+}
+
+bool SolutionCache::load(uint64_t key, size_t rows, size_t cols, const std::vector<TileTask>& tasks, std::vector<std::vector<Move>>& moves) {
+	std::string path = getPath(key);
+	uint64_t fileKey;
+	size_t fileRows, fileCols;
+	CubeState start;
+	std::vector<TileTask> fileTasks;
+	std::vector<std::vector<Move>> fileMoves;
+
+	// a different grid with the same hash is as good as no file
+	bool found = read(path, fileKey, fileRows, fileCols, start, fileTasks, fileMoves) && fileKey == key && fileRows == rows && fileCols == cols
+		&& start == getStart(tasks) && fileTasks.size() == tasks.size();
+	for (size_t i = 0; found && i < tasks.size(); i++)
+		found = std::equal(tasks[i].pattern, tasks[i].pattern + 9, fileTasks[i].pattern);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!found) {
+		nMisses++;
+		return false;
+	}
+	nHits++;
+	moves.swap(fileMoves);
+	std::error_code error;
+	fs::last_write_time(path, fs::file_time_type::clock::now(), error); // used, so evicted last
+	checkAbsorbed();
+	if (start == CubeState::standard() && !absorbed.count(path))
+		remember(path, tasks, moves);
+	return true;
+}
+
+size_t SolutionCache::reuse(const std::vector<TileTask>& tasks, std::vector<std::vector<Move>>& moves, std::vector<unsigned char>& found) {
+	if (tasks.empty() || getStart(tasks) != CubeState::standard())
+		return 0;
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// read the tiles of the most recently used files not read yet
+	checkAbsorbed();
+	std::vector<std::pair<fs::file_time_type, std::string>> files;
+	std::error_code error;
+	for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+		if (it->path().extension() == EXTENSION && !absorbed.count(it->path().string()))
+			files.emplace_back(it->last_write_time(error), it->path().string());
+	std::sort(files.begin(), files.end(), std::greater<std::pair<fs::file_time_type, std::string>>());
+	files.resize(std::min(files.size(), static_cast<size_t>(REUSE_FILES)));
+	for (const std::pair<fs::file_time_type, std::string>& file : files) {
+		uint64_t key;
+		size_t rows, cols;
+		CubeState start;
+		std::vector<TileTask> fileTasks;
+		std::vector<std::vector<Move>> fileMoves;
+		if (read(file.second, key, rows, cols, start, fileTasks, fileMoves) && start == CubeState::standard())
+			remember(file.second, fileTasks, fileMoves);
+		absorbed.insert(file.second); // not read again either way
+	}
+
+	size_t nFound = 0;
+	for (size_t i = 0; i < tasks.size(); i++) {
+		if (memory->find(tasks[i].pattern, moves[i])) {
+			found[i] = 1;
+			nFound++;
+		}
+	}
+	nReused += nFound;
+	return nFound;
+}
+
+void SolutionCache::store(uint64_t key, size_t rows, size_t cols, const std::vector<TileTask>& tasks, const std::vector<std::vector<Move>>& moves) {
+	std::vector<unsigned char> content;
+	content.reserve(HEADER_BYTES + tasks.size() * 32);
+	content.insert(content.end(), MAGIC, MAGIC + 4);
+	putU32(content, FORMAT_VERSION);
+	putU32(content, SOLVER_VERSION);
+	putU32(content, static_cast<uint32_t>(rows));
+	putU32(content, static_cast<uint32_t>(cols));
+	putU64(content, key);
+	for (Color color : getStart(tasks).stickers)
+		content.push_back(static_cast<unsigned char>(color));
+	for (size_t i = 0; i < tasks.size(); i++) {
+		for (Color color : tasks[i].pattern)
+			content.push_back(static_cast<unsigned char>(color));
+		size_t lengthAt = content.size();
+		putU16(content, 0);
+		size_t nNibbles = 0;
+		for (Move move : moves[i]) {
+			unsigned char nibbles[2];
+			size_t n = Choreography::encode(move, nibbles);
+			for (size_t k = 0; k < n; k++, nNibbles++) {
+				if (nNibbles % 2 == 0)
+					content.push_back(nibbles[k]);
+				else
+					content.back() |= nibbles[k] << 4;
+			}
+		}
+		if (nNibbles > 0xFFFF) {
+			std::cout << "Not caching a grid with a tile of " << moves[i].size() << " moves" << std::endl;
+			return;
+		}
+		content[lengthAt] = nNibbles & 0xFF;
+		content[lengthAt + 1] = (nNibbles >> 8) & 0xFF;
+	}
+
+	// written under a name of its own, then renamed over the real one in one step. The name is unique to this process and thread,
+	// as the window and a server may share the directory
+	std::string path = getPath(key);
+	std::string temporary = path + "." + std::to_string(getProcessId()) + "-"
+		+ std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(content.data()), content.size());
+		file.close(); // flushes, so a short write fails here instead of being published by the rename
+		if (!file) {
+			std::cout << "Could not write " << temporary << std::endl;
+			std::error_code error;
+			fs::remove(temporary, error);
+			return;
+		}
+	}
+	std::error_code error;
+	fs::rename(temporary, path, error);
+	if (error) {
+		std::cout << "Could not write " << path << ": " << error.message() << std::endl;
+		fs::remove(temporary, error);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	checkAbsorbed();
+	if (getStart(tasks) == CubeState::standard() && !absorbed.count(path))
+		remember(path, tasks, moves);
+	evict();
+}
+
+std::string SolutionCache::describe() {
+	std::lock_guard<std::mutex> lock(mutex);
+	char line[96];
+	snprintf(line, sizeof(line), "CACHE %zu HITS %zu MISSES %zu TILES REUSED", nHits, nMisses, nReused);
+	return line;
+}
+
+std::string SolutionCache::getPath(uint64_t key) const {
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+	return (fs::path(directory) / (name + std::string(EXTENSION))).string();
+}
+
+bool SolutionCache::read(const std::string& path, uint64_t& key, size_t& rows, size_t& cols, CubeState& start,
+	std::vector<TileTask>& tasks, std::vector<std::vector<Move>>& moves) {
+	try {
+		MappedFile file(path.c_str());
+		const unsigned char* data = file.getData();
+		size_t size = file.getSize();
+		if (size < HEADER_BYTES || memcmp(data, MAGIC, 4) != 0 || getU32(data + 4) != FORMAT_VERSION || getU32(data + 8) != SOLVER_VERSION)
+			return false;
+		rows = getU32(data + 12);
+		cols = getU32(data + 16);
+		key = getU64(data + 20);
+		for (int i = 0; i < 54; i++) {
+			if (data[28 + i] > static_cast<unsigned char>(Color::WHITE))
+				return false;
+			start.stickers[i] = static_cast<Color>(data[28 + i]);
+		}
+
+		size_t n = rows * cols;
+		if (n > (size - HEADER_BYTES) / 11) // every tile takes at least 11 bytes
+			return false;
+		tasks.resize(n);
+		moves.resize(n);
+		size_t at = HEADER_BYTES;
+		for (size_t i = 0; i < n; i++) {
+			if (size - at < 11)
+				return false;
+			tasks[i].tile = static_cast<uint32_t>(i);
+			tasks[i].start = start;
+			for (int k = 0; k < 9; k++) {
+				if (data[at + k] > static_cast<unsigned char>(Color::WHITE))
+					return false;
+				tasks[i].pattern[k] = static_cast<Color>(data[at + k]);
+			}
+			size_t nNibbles = getU16(data + at + 9);
+			at += 11;
+			if (size - at < (nNibbles + 1) / 2)
+				return false;
+			moves[i].clear();
+			Move move;
+			size_t cursor = 0;
+			while (Choreography::decode(data + at, nNibbles, cursor, move))
+				moves[i].push_back(move);
+			if (cursor != nNibbles) // a code no move has
+				return false;
+			at += (nNibbles + 1) / 2;
+		}
+		return true;
+	} catch (const std::runtime_error&) {
+		return false;
+	}
+}
+
+std::shared_ptr<PatternMemory> SolutionCache::getMemory() const {
+	return memory;
+}
+
+void SolutionCache::checkAbsorbed() {
+	uint64_t generation = memory->getGeneration();
+	if (generation != absorbedGeneration) {
+		absorbed.clear();
+		absorbedGeneration = generation;
+	}
+}
+
+void SolutionCache::remember(const std::string& path, const std::vector<TileTask>& tasks, const std::vector<std::vector<Move>>& moves) {
+	memory->remember(tasks, moves);
+	checkAbsorbed(); // the files before were forgotten if these did not fit, but not this one
+	absorbed.insert(path);
+}
+
+void SolutionCache::evict() {
+	struct Entry {
+		fs::file_time_type used;
+		uintmax_t size;
+		fs::path path;
+	};
+	std::vector<Entry> entries;
+	uintmax_t total = 0;
+	std::error_code error;
+	for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+		if (it->path().extension() != EXTENSION)
+			continue;
+		Entry entry{ it->last_write_time(error), it->file_size(error), it->path() };
+		if (error)
+			continue;
+		total += entry.size;
+		entries.push_back(entry);
+	}
+	if (total <= maxBytes)
+		return;
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+	for (const Entry& entry : entries) {
+		if (total <= maxBytes)
+			break;
+		if (fs::remove(entry.path, error)) {
+			total -= entry.size;
+			absorbed.erase(entry.path.string());
+		}
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "PatternMemory.hpp"
+#include "ShardProtocol.hpp"
+
+/* Keeps the plans of solved grids in a directory, so loading an image again skips the planner.
+   Each grid is a file named after the xxHash64 of everything its plans depend on: the solver version, the grid size,
+   the start state and the pattern of every tile. It holds every tile's pattern and its moves, nibble-coded as in Choreography:
+	"TSOL", uint32 format version, uint32 solver version, uint32 rows, uint32 cols, uint64 key, 54 start sticker bytes
+	per tile: 9 pattern bytes, uint16 nibbles, (nibbles + 1) / 2 bytes of moves
+   Files are written to a temporary name and renamed, so a reader never sees half of one. Using a file refreshes its
+   modification time, and the least recently used files are deleted once the directory outgrows its size limit.
+   Grids that only partly match reuse the tiles they share: the tiles of recently used files are remembered by pattern,
+   in a PatternMemory that others solving from the standard start can share (see getMemory).
+   Safe to use from several threads */
+class SolutionCache {
+public:
+	/* bumped whenever AI plans differently, which invalidates every cached plan */
+	static const uint32_t SOLVER_VERSION = 1;
+	/* files whose tiles are read to fill in a grid that is not cached as a whole */
+	static const size_t REUSE_FILES = 4;
+private:
+	std::string directory;
+	uintmax_t maxBytes;
+	std::shared_ptr<PatternMemory> memory; // moves by pattern, from the standard start
+	std::mutex mutex; // guards the rest
+	std::unordered_set<std::string> absorbed; // files whose tiles are remembered
+	uint64_t absorbedGeneration; // the generation of memory absorbed belongs to
+	size_t nHits, nMisses, nReused;
+public:
+	/* caches in directory, which is created if needed, keeping at most maxBytes of files. throws std::runtime_error if it cannot be created */
+	SolutionCache(const std::string& directory, uintmax_t maxBytes = 64 * 1024 * 1024);
+
+	/* the key of a rows x cols grid whose tiles are tasks, all from the same start state */
+	static uint64_t getKey(size_t rows, size_t cols, const std::vector<TileTask>& tasks);
+
+	/* fills moves with the plan of every task if the grid is cached, and marks it as used. moves[i] is the plan of tasks[i] */
+	bool load(uint64_t key, size_t rows, size_t cols, const std::vector<TileTask>& tasks, std::vector<std::vector<Move>>& moves);
+
+	/* fills in the plans of the tasks whose patterns were planned for another grid recently, and sets found[i] for them.
+	   moves and found have one element per task. Returns how many were found */
+	size_t reuse(const std::vector<TileTask>& tasks, std::vector<std::vector<Move>>& moves, std::vector<unsigned char>& found);
+
+	/* writes the plans of a grid, then deletes the least recently used files over the size limit.
+	   Failures are printed, not thrown: a grid that is not cached is only planned again */
+	void store(uint64_t key, size_t rows, size_t cols, const std::vector<TileTask>& tasks, const std::vector<std::vector<Move>>& moves);
+
+	/* the memory of the tiles reused between grids, to remember plans made elsewhere in as well */
+	std::shared_ptr<PatternMemory> getMemory() const;
+
+	/* a line for the HUD: grids found and not found, tiles reused */
+	std::string describe();
+
+private:
+	/* the file of key */
+	std::string getPath(uint64_t key) const;
+
+	/* reads the file at path. Returns false if it is not a cache file of this solver */
+	static bool read(const std::string& path, uint64_t& key, size_t& rows, size_t& cols, CubeState& start,
+		std::vector<TileTask>& tasks, std::vector<std::vector<Move>>& moves);
+
+	/* forgets which files were absorbed if the memory was cleared since. Call with mutex held */
+	void checkAbsorbed();
+
+	/* remembers the tiles of the grid of file path, planned from the standard start. Call with mutex held */
+	void remember(const std::string& path, const std::vector<TileTask>& tasks, const std::vector<std::vector<Move>>& moves);
+
+	/* deletes the least recently used files until the directory fits in maxBytes */
+	void evict();
+};
@@ -0,0 +1,422 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "SolveServer.hpp"
+#include "AI.hpp"
+#include "GridFit.hpp"
+#include "ImageStream.hpp"
+#include "JobSystem.hpp"
+
+#ifndef MSG_NOSIGNAL // macOS sets SO_NOSIGPIPE on the socket instead
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+	const char* const COLOR_LETTERS = "ROYGBW"; // in the order of the Color enum
+
+	/* 9 letters of COLOR_LETTERS, upper or lower case */
+	bool parsePattern(const std::string& word, Color pattern[9]) {
+		if (word.size() != 9)
+			return false;
+		for (int i = 0; i < 9; i++) {
+			const char* letter = strchr(COLOR_LETTERS, toupper(static_cast<unsigned char>(word[i])));
+			if (!letter || !*letter)
+				return false;
+			pattern[i] = static_cast<Color>(letter - COLOR_LETTERS);
+		}
+		return true;
+	}
+
+	/* splits a line at spaces and tabs. A word in double quotes may hold them */
+	std::vector<std::string> split(const std::string& line) {
+		std::vector<std::string> words;
+		size_t i = 0;
+		while (i < line.size()) {
+			if (line[i] == ' ' || line[i] == '\t' || line[i] == '\r') {
+				i++;
+				continue;
+			}
+			size_t end;
+			if (line[i] == '"') {
+				end = line.find('"', i + 1);
+				if (end == std::string::npos)
+					end = line.size();
+				words.push_back(line.substr(i + 1, end - i - 1));
+				i = end + 1;
+				continue;
+			}
+			end = line.find_first_of(" \t\r", i);
+			if (end == std::string::npos)
+				end = line.size();
+			words.push_back(line.substr(i, end - i));
+			i = end;
+		}
+		return words;
+	}
+
+	/* the number of bits of v, so latencies of 2^(b-1) to 2^b - 1 microseconds share bucket b */
+	size_t bitLength(uint64_t v) {
+		size_t bits = 0;
+		while (v) {
+			bits++;
+			v >>= 1;
+		}
+		return bits;
+	}
+}
+
+SolveServer::Shared::Shared(const ColorQuantizer& quantizer, std::shared_ptr<SolutionCache> cache)
+	: quantizer(quantizer), cache(cache), memory(cache ? cache->getMemory() : std::make_shared<PatternMemory>()), startTime(std::chrono::steady_clock::now()), nClients(0), nRequests(0), nErrors(0), nTiles(0), nPlanned(0),
+	latencyCounts{}, latencyTotal(0), latencyMax(0) {}
+
+SolveServer::Batch::Batch()
+	: cancelled(false), nPending(0) {}
+
+std::string SolveServer::describe() const {
+	return describe(*shared);
+}
+
+bool SolveServer::answer(const std::shared_ptr<Shared>& shared, int client, const std::string& line) {
+	std::chrono::steady_clock::time_point received = std::chrono::steady_clock::now();
+	std::vector<std::string> words = split(line);
+	if (words.empty())
+		return true;
+	if (words[0] == "STATS")
+		return write(client, "STATS " + describe(*shared) + "\n");
+
+	std::string id = words.size() > 1 ? words[1] : "-";
+	shared->nRequests++;
+	if (words[0] == "TILES" && words.size() >= 2) {
+		std::vector<TileTask> tasks(words.size() - 2);
+		for (size_t i = 0; i < tasks.size(); i++) {
+			tasks[i].tile = static_cast<uint32_t>(i);
+			tasks[i].start = CubeState::standard();
+			if (!parsePattern(words[i + 2], tasks[i].pattern)) {
+				shared->nErrors++;
+				return write(client, "ERROR " + id + " pattern " + std::to_string(i) + " is not 9 letters of " + COLOR_LETTERS + "\n");
+			}
+		}
+		return solve(shared, client, id, tasks, 0, 0, received);
+	}
+	if (words[0] == "IMAGE" && words.size() >= 3)
+		return solveImage(shared, client, id, words, received);
+
+	shared->nErrors++;
+	return write(client, "ERROR " + id + " unknown request " + words[0] + "\n");
+}
+
+bool SolveServer::solveImage(const std::shared_ptr<Shared>& shared, int client, const std::string& id, const std::vector<std::string>& words,
+	std::chrono::steady_clock::time_point received) {
+	int rows = 0, cols = 0, budget = DEFAULT_BUDGET;
+	FitMode fitMode = FitMode::CROP;
+	DitherMode ditherMode = DitherMode::ERROR_DIFFUSION;
+	for (size_t i = 3; i < words.size(); i++) {
+		bool valid = i + 1 < words.size();
+		if (valid && words[i] == "CUBES") { // ROWSxCOLS, or N for a square grid
+			int n = sscanf(words[++i].c_str(), "%dx%d", &rows, &cols);
+			if (n == 1)
+				cols = rows;
+			valid = n >= 1 && rows > 0 && cols > 0;
+		} else if (valid && words[i] == "BUDGET") {
+			budget = atoi(words[++i].c_str());
+			valid = budget > 0 && static_cast<size_t>(budget) <= MAX_CUBES;
+		} else if (valid && words[i] == "FIT")
+			valid = parseFitMode(words[++i].c_str(), fitMode);
+		else if (valid && words[i] == "DITHER")
+			valid = parseDitherMode(words[++i].c_str(), ditherMode);
+		else
+			valid = false;
+		if (!valid) {
+			shared->nErrors++;
+			return write(client, "ERROR " + id + " bad option " + words[i] + "\n");
+		}
+	}
+
+	// the image is decoded whole before any tile is planned, so the grid can be looked up in the cache first
+	GridFit fit;
+	std::vector<TileTask> tasks;
+	try {
+		std::unique_ptr<ImageSource> image = ImageSource::open(words[2].c_str());
+		fit = rows > 0 && cols > 0
+			? GridFit::forSize(image->getWidth(), image->getHeight(), rows, cols, fitMode)
+			: GridFit::forBudget(image->getWidth(), image->getHeight(), budget, fitMode);
+		if (fit.rows * fit.cols > MAX_CUBES)
+			throw std::runtime_error("grids are limited to " + std::to_string(MAX_CUBES) + " cubes");
+		ImageStream stream(*image, fit, shared->quantizer, ditherMode);
+		tasks.resize(fit.rows * fit.cols);
+		size_t width = fit.cols * 3;
+		std::vector<Color> band(ImageStream::BAND_ROWS * width);
+		for (size_t r = 0; stream.nextBand(band.data()); r++) { // per band of cubes
+			for (size_t c = 0; c < fit.cols; c++) {
+				TileTask& task = tasks[r * fit.cols + c];
+				task.tile = static_cast<uint32_t>(r * fit.cols + c);
+				task.start = CubeState::standard();
+				for (int k = 0; k < 9; k++)
+					task.pattern[k] = band[k / 3 * width + c * 3 + k % 3];
+			}
+		}
+	} catch (const std::runtime_error& e) {
+		shared->nErrors++;
+		return write(client, "ERROR " + id + " " + e.what() + "\n");
+	}
+
+	if (!write(client, "SIZE " + id + " " + std::to_string(fit.rows) + " " + std::to_string(fit.cols) + "\n"))
+		return false;
+	return solve(shared, client, id, tasks, fit.rows, fit.cols, received);
+}
+
+bool SolveServer::solve(const std::shared_ptr<Shared>& shared, int client, const std::string& id, const std::vector<TileTask>& tasks,
+	size_t rows, size_t cols, std::chrono::steady_clock::time_point received) {
+	std::string reply;
+	auto addPlan = [&](size_t tile, const std::vector<Move>& moves) {
+		reply += "TILE " + id + " " + std::to_string(tile);
+		for (Move move : moves) {
+			reply += ' ';
+			reply += getMoveName(move);
+		}
+		reply += '\n';
+	};
+	shared->nTiles += tasks.size();
+
+	// a grid solved before is read back whole
+	bool cached = shared->cache && rows > 0 && cols > 0;
+	uint64_t key = 0;
+	std::vector<std::vector<Move>> solutions;
+	if (cached) {
+		key = SolutionCache::getKey(rows, cols, tasks);
+		if (shared->cache->load(key, rows, cols, tasks, solutions)) {
+			for (size_t i = 0; i < tasks.size(); i++)
+				addPlan(i, solutions[i]);
+			return write(client, reply) && finish(*shared, client, id, tasks.size(), received);
+		}
+		solutions.assign(tasks.size(), std::vector<Move>());
+	}
+
+	// remembered patterns are answered at once, the rest are planned by a job each
+	std::vector<size_t> unknown;
+	std::vector<Move> known;
+	for (size_t i = 0; i < tasks.size(); i++) {
+		if (!shared->memory->find(tasks[i].pattern, known)) {
+			unknown.push_back(i);
+			continue;
+		}
+		addPlan(i, known);
+		if (cached)
+			solutions[i] = known;
+	}
+	std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+	batch->nPending = unknown.size();
+	JobSystem& jobs = JobSystem::shared();
+	for (size_t i : unknown) {
+		jobs.run(jobs.create([shared, batch, task = tasks[i]]() mutable {
+			TilePlan plan{ task.tile, std::vector<Move>() };
+			if (!batch->cancelled) {
+				AI ai(task.start.stickers);
+				ai.calculatePaint(task.pattern);
+				plan.moves.assign(ai.getInstructions().begin(), ai.getInstructions().end());
+				shared->nPlanned++;
+				shared->memory->remember(task.pattern, plan.moves);
+			}
+			std::lock_guard<std::mutex> lock(batch->mutex);
+			batch->plans.push_back(std::move(plan));
+			batch->nPending--;
+			batch->planned.notify_one();
+		}));
+	}
+
+	// stream the plans as they come in. A client that hangs up stops the jobs not yet started
+	std::vector<TilePlan> plans;
+	for (;;) {
+		if (!reply.empty() && !write(client, reply)) {
+			batch->cancelled = true;
+			return false;
+		}
+		reply.clear();
+		{
+			std::unique_lock<std::mutex> lock(batch->mutex);
+			batch->planned.wait(lock, [&] { return !batch->plans.empty() || batch->nPending == 0; });
+			if (batch->plans.empty())
+				break;
+			plans.swap(batch->plans);
+		}
+		for (TilePlan& plan : plans) {
+			addPlan(plan.tile, plan.moves);
+			if (cached)
+				solutions[plan.tile] = std::move(plan.moves);
+		}
+		plans.clear();
+	}
+
+	if (cached)
+		shared->cache->store(key, rows, cols, tasks, solutions);
+	return finish(*shared, client, id, tasks.size(), received);
+}
+
+bool SolveServer::finish(Shared& shared, int client, const std::string& id, size_t nTiles, std::chrono::steady_clock::time_point received) {
+	uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - received).count();
+	{
+		std::lock_guard<std::mutex> lock(shared.mutex);
+		shared.latencyCounts[std::min<size_t>(bitLength(latency), 63)]++;
+		shared.latencyTotal += latency;
+		shared.latencyMax = std::max(shared.latencyMax, latency);
+	}
+	return write(client, "DONE " + id + " " + std::to_string(nTiles) + " " + std::to_string(latency) + "\n");
+}
+
+std::string SolveServer::describe(Shared& shared) {
+	double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - shared.startTime).count();
+	std::lock_guard<std::mutex> lock(shared.mutex);
+
+	// percentiles are the upper ends of their buckets
+	uint64_t nAnswered = 0;
+	for (uint64_t count : shared.latencyCounts)
+		nAnswered += count;
+	auto percentile = [&](double fraction) -> unsigned long long {
+		uint64_t rank = static_cast<uint64_t>(fraction * nAnswered), seen = 0;
+		for (size_t b = 0; b < 64; b++) {
+			seen += shared.latencyCounts[b];
+			if (seen > rank)
+				return std::min<uint64_t>((uint64_t(1) << b) - 1, shared.latencyMax);
+		}
+		return shared.latencyMax;
+	};
+
+	char line[512];
+	snprintf(line, sizeof(line),
+		"clients %zu requests %zu errors %zu answered %llu tiles %zu planned %zu remembered %zu uptime %.1f tilesPerSecond %.1f "
+		"latencyMeanUs %llu latencyP50Us %llu latencyP99Us %llu latencyMaxUs %llu",
+		shared.nClients.load(), shared.nRequests.load(), shared.nErrors.load(), static_cast<unsigned long long>(nAnswered),
+		shared.nTiles.load(), shared.nPlanned.load(), shared.memory->size(), uptime, uptime > 0 ? shared.nTiles / uptime : 0.0,
+		static_cast<unsigned long long>(nAnswered > 0 ? shared.latencyTotal / nAnswered : 0), percentile(0.5), percentile(0.99),
+		static_cast<unsigned long long>(shared.latencyMax));
+	return line;
+}
+
+#ifdef _WIN32
+
+SolveServer::SolveServer(const std::string& path, const ColorQuantizer& quantizer, std::shared_ptr<SolutionCache> cache)
+	: path(path), listener(-1), shared(std::make_shared<Shared>(quantizer, cache)) {
+	throw std::runtime_error("the solving server is not supported on Windows");
+}
+
+SolveServer::~SolveServer() {}
+
+void SolveServer::run() {}
+
+void SolveServer::serve(std::shared_ptr<Shared> shared, int client) {}
+
+bool SolveServer::write(int client, const std::string& text) {
+	return false;
+}
+
+#else
+
+SolveServer::SolveServer(const std::string& path, const ColorQuantizer& quantizer, std::shared_ptr<SolutionCache> cache)
+	: path(path), listener(-1), shared(std::make_shared<Shared>(quantizer, cache)) {
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	if (path.length() >= sizeof(address.sun_path))
+		throw std::runtime_error("socket path is too long: " + path);
+	strcpy(address.sun_path, path.c_str());
+
+	listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0)
+		throw std::runtime_error("cannot create socket " + path);
+	unlink(path.c_str()); // left behind by a previous run
+	if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0) {
+		close(listener);
+		throw std::runtime_error("cannot listen on socket " + path);
+	}
+	std::cout << "Solving on " << path << std::endl;
+}
+
+SolveServer::~SolveServer() {
+	close(listener);
+	unlink(path.c_str());
+}
+
+void SolveServer::run() {
+	for (;;) {
+		int client = accept(listener, nullptr, nullptr);
+		if (client < 0) {
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			if (errno == EMFILE || errno == ENFILE) { // wait for a client to hang up
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				continue;
+			}
+			std::cout << "Stopped accepting clients on " << path << ": " << strerror(errno) << std::endl;
+			return;
+		}
+#ifdef SO_NOSIGPIPE
+		int on = 1;
+		setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+		std::thread(serve, shared, client).detach();
+	}
+}
+
+void SolveServer::serve(std::shared_ptr<Shared> shared, int client) {
+	shared->nClients++;
+
+	// split the byte stream into lines. scanned is where the search for the next newline resumes
+	std::string pending;
+	size_t scanned = 0;
+	bool open = true;
+	char buffer[64 * 1024];
+	while (open) {
+		ssize_t n = read(client, buffer, sizeof(buffer));
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		pending.append(buffer, n);
+		size_t newline;
+		while (open && (newline = pending.find('\n', scanned)) != std::string::npos) {
+			open = answer(shared, client, pending.substr(0, newline));
+			pending.erase(0, newline + 1);
+			scanned = 0;
+		}
+		scanned = pending.size();
+		if (pending.size() > MAX_LINE) {
+			write(client, "ERROR - request longer than " + std::to_string(MAX_LINE) + " bytes\n");
+			open = false;
+		}
+	}
+	if (open && !pending.empty())
+		answer(shared, client, pending);
+
+	close(client);
+	shared->nClients--;
+}
+
+bool SolveServer::write(int client, const std::string& text) {
+	const char* data = text.data();
+	size_t n = text.size();
+	while (n > 0) {
+		// a client that hung up must not take the server down with SIGPIPE
+		ssize_t put = send(client, data, n, MSG_NOSIGNAL);
+		if (put < 0 && errno == EINTR)
+			continue;
+		if (put <= 0)
+			return false;
+		data += put;
+		n -= put;
+	}
+	return true;
+}
+
+#endif
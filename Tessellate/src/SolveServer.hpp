@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ColorQuantizer.hpp"
+#include "PatternMemory.hpp"
+#include "ShardProtocol.hpp"
+#include "SolutionCache.hpp"
+
+/* Solves tiles and images for other programs over a UNIX domain socket, so they need neither the code nor a process per request.
+   Every client gets a thread of its own and its tiles are planned on the shared job system, so clients solve side by side.
+   The plans of every pattern solved so far are remembered, so repeated patterns answer without the planner, and with a
+   SolutionCache whole images are looked up on disk first, and the patterns are remembered in the cache's PatternMemory.
+   The protocol is lines of text. Requests, each with an id of the client's choice:
+	TILES <id> <pattern> ...   patterns of 9 stickers, row by row, as letters of ROYGBW, each painted on a standard cube
+	IMAGE <id> <path> [CUBES <rows>x<cols>] [BUDGET <cubes>] [FIT crop|letterbox|stretch] [DITHER fs|bayer4|bayer8|bluenoise]
+	STATS
+   Replies. The tiles of a request stream back as they are planned, in any order:
+	SIZE <id> <rows> <cols>        for IMAGE, before its tiles
+	TILE <id> <index> <moves> ...  in Singmaster notation
+	DONE <id> <tiles> <microseconds>
+	ERROR <id> <message>
+	STATS <name> <value> ...       counters since the server started
+   A client's requests are answered one after the other. POSIX only */
+class SolveServer {
+public:
+	/* longest request line accepted. Longer ones end the connection */
+	static const size_t MAX_LINE = 16 * 1024 * 1024;
+	/* grid size of an IMAGE without CUBES or BUDGET, as in the window */
+	static const size_t DEFAULT_BUDGET = 17 * 17;
+	/* largest grid an IMAGE may ask for */
+	static const size_t MAX_CUBES = 1 << 20;
+private:
+	/* everything the client threads and tile jobs touch. They keep it alive after the server is destroyed */
+	struct Shared {
+		ColorQuantizer quantizer;
+		std::shared_ptr<SolutionCache> cache; // looks images up before they are planned, and keeps them, if set
+		std::shared_ptr<PatternMemory> memory; // moves by pattern, from the standard start. The cache's if there is one
+		std::chrono::steady_clock::time_point startTime;
+		std::atomic<size_t> nClients, nRequests, nErrors, nTiles, nPlanned;
+
+		std::mutex mutex; // guards the rest
+		uint64_t latencyCounts[64]; // requests by the bit length of their latency in microseconds
+		uint64_t latencyTotal, latencyMax; // microseconds
+
+		Shared(const ColorQuantizer& quantizer, std::shared_ptr<SolutionCache> cache);
+	};
+
+	/* the tiles of one request. Tile jobs keep it alive after their client is gone */
+	struct Batch {
+		std::atomic<bool> cancelled;
+		std::mutex mutex; // guards the rest
+		std::condition_variable planned;
+		std::vector<TilePlan> plans; // planned, not yet sent
+		size_t nPending;
+
+		Batch();
+	};
+
+	std::string path;
+	int listener;
+	std::shared_ptr<Shared> shared;
+public:
+	/* listens on path, replacing a socket left behind there. throws std::runtime_error if it cannot, and on Windows */
+	SolveServer(const std::string& path, const ColorQuantizer& quantizer, std::shared_ptr<SolutionCache> cache = nullptr);
+
+	/* stops listening. Clients already connected are served until they hang up */
+	~SolveServer();
+
+	SolveServer(const SolveServer&) = delete;
+	SolveServer& operator=(const SolveServer&) = delete;
+
+	/* accepts clients until the listening socket fails */
+	void run();
+
+	/* the counters, as the STATS reply without its first word */
+	std::string describe() const;
+
+private:
+	/* reads requests from a client until it hangs up */
+	static void serve(std::shared_ptr<Shared> shared, int client);
+
+	/* answers one request line. Returns false once the client is gone */
+	static bool answer(const std::shared_ptr<Shared>& shared, int client, const std::string& line);
+
+	/* turns the image of an IMAGE request into tasks, and plans them */
+	static bool solveImage(const std::shared_ptr<Shared>& shared, int client, const std::string& id, const std::vector<std::string>& words,
+		std::chrono::steady_clock::time_point received);
+
+	/* plans tasks, or looks them up, and streams the plans to the client. rows and cols are 0 unless tasks form a grid */
+	static bool solve(const std::shared_ptr<Shared>& shared, int client, const std::string& id, const std::vector<TileTask>& tasks, size_t rows, size_t cols,
+		std::chrono::steady_clock::time_point received);
+
+	/* counts the latency of a request and tells the client it is done */
+	static bool finish(Shared& shared, int client, const std::string& id, size_t nTiles, std::chrono::steady_clock::time_point received);
+
+	static std::string describe(Shared& shared);
+
+	/* blocks until text is written to client. Returns false if the client is gone */
+	static bool write(int client, const std::string& text);
+};
@@ -1,4 +1,4 @@
 #include "Square.hpp"
 
 Square::Square(Color color) 
-	: color(color), vertices{} {}
\ No newline at end of file
+	: color(color) {}
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "TGAImage.hpp"
+
+namespace {
+	/* image types */
+	const unsigned int COLOR_MAPPED = 1;
+	const unsigned int TRUE_COLOR = 2;
+	const unsigned int GRAYSCALE = 3;
+	const unsigned int RLE = 8; // added to one of the above
+
+	unsigned int readU16(const unsigned char* p) {
+		return p[0] | (p[1] << 8);
+	}
+
+	/* expands a 5-5-5 pixel (the top bit is an attribute) to rgb */
+	void expand555(unsigned int pixel, unsigned char rgb[3]) {
+		unsigned int r = (pixel >> 10) & 0x1F, g = (pixel >> 5) & 0x1F, b = pixel & 0x1F;
+		rgb[0] = static_cast<unsigned char>(r << 3 | r >> 2);
+		rgb[1] = static_cast<unsigned char>(g << 3 | g >> 2);
+		rgb[2] = static_cast<unsigned char>(b << 3 | b >> 2);
+	}
+}
+
+TGAImage::TGAImage(const char* const filepath)
+	: file(filepath), width(0), height(0), bytesPerPixel(0), grayscale(false), colorMapped(false), rightToLeft(false), palette{} {
+
+	const unsigned char* bytes = file.getData();
+	size_t size = file.getSize();
+	if (size < 18)
+		throw std::runtime_error(std::string(filepath) + " is not a TGA image");
+
+	size_t idLength = bytes[0];
+	unsigned int colorMapType = bytes[1];
+	unsigned int imageType = bytes[2];
+	size_t mapFirst = readU16(bytes + 3);
+	size_t mapLength = readU16(bytes + 5);
+	unsigned int mapEntryBits = bytes[7];
+	width = readU16(bytes + 12);
+	height = readU16(bytes + 14);
+	unsigned int bitsPerPixel = bytes[16];
+	unsigned int descriptor = bytes[17];
+
+	unsigned int baseType = imageType & ~RLE;
+	bool validType = (imageType & ~(RLE | 3)) == 0 && baseType != 0 && colorMapType <= 1;
+	colorMapped = baseType == COLOR_MAPPED;
+	grayscale = baseType == GRAYSCALE;
+	bool supported =
+		(colorMapped && colorMapType == 1 && bitsPerPixel == 8) ||
+		(baseType == TRUE_COLOR && (bitsPerPixel == 15 || bitsPerPixel == 16 || bitsPerPixel == 24 || bitsPerPixel == 32)) ||
+		(grayscale && bitsPerPixel == 8);
+	if (!validType || !supported)
+		throw std::runtime_error(std::string(filepath) + " is not a supported image (BMP, PNG, PPM, PGM or TGA)");
+	if (width == 0 || height == 0)
+		throw std::runtime_error(std::string(filepath) + " has invalid dimensions");
+	bytesPerPixel = (bitsPerPixel + 7) / 8;
+	rightToLeft = (descriptor & 0x10) != 0;
+	bool topDown = (descriptor & 0x20) != 0;
+
+	// the image ID and color map come before the pixels
+	size_t mapBytes = colorMapType == 1 ? mapLength * ((mapEntryBits + 7) / 8) : 0;
+	size_t pixelOffset = 18 + idLength + mapBytes;
+	if (pixelOffset > size)
+		throw std::runtime_error(std::string(filepath) + " is truncated");
+	if (colorMapped) {
+		if (mapEntryBits != 15 && mapEntryBits != 16 && mapEntryBits != 24 && mapEntryBits != 32)
+			throw std::runtime_error(std::string(filepath) + ": unsupported color map entry size " + std::to_string(mapEntryBits));
+		readColorMap(bytes + 18 + idLength, mapFirst, mapLength, mapEntryBits);
+	}
+
+	size_t stride = width * bytesPerPixel;
+	const unsigned char* pixels = bytes + pixelOffset;
+	if (imageType & RLE) {
+		decodeRLE(pixels, bytes + size);
+		pixels = expanded.data();
+	} else if ((size - pixelOffset) / stride < height) {
+		throw std::runtime_error(std::string(filepath) + " is truncated");
+	}
+
+	rows.resize(height);
+	for (size_t r = 0; r < height; r++) // for each row of pixels
+		rows[r] = pixels + (topDown ? r : height - 1 - r) * stride;
+}
+
+void TGAImage::readColorMap(const unsigned char* p, size_t first, size_t nEntries, unsigned int entryBits) {
+	size_t entryBytes = (entryBits + 7) / 8;
+	for (size_t i = 0; i < nEntries; i++, p += entryBytes) {
+		size_t index = first + i;
+		if (index > 255)
+			break;
+		if (entryBytes == 2) {
+			expand555(readU16(p), palette[index]);
+		} else { // stored as bgr(a)
+			palette[index][0] = p[2];
+			palette[index][1] = p[1];
+			palette[index][2] = p[0];
+		}
+	}
+}
+
+void TGAImage::decodeRLE(const unsigned char* begin, const unsigned char* end) {
+	size_t total = width * height * bytesPerPixel;
+	expanded.resize(total);
+	unsigned char* out = expanded.data();
+	unsigned char* outEnd = out + total;
+	const unsigned char* p = begin;
+
+	while (out < outEnd) {
+		if (p == end)
+			throw std::runtime_error("TGA image data is truncated");
+		unsigned int header = *p++;
+		size_t count = (header & 0x7F) + 1;
+		size_t packetBytes = count * bytesPerPixel;
+		if (packetBytes > static_cast<size_t>(outEnd - out))
+			throw std::runtime_error("TGA image data overruns the image");
+
+		if (header & 0x80) { // run: one pixel repeated
+			if (static_cast<size_t>(end - p) < bytesPerPixel)
+				throw std::runtime_error("TGA image data is truncated");
+			for (size_t i = 0; i < count; i++, out += bytesPerPixel)
+				memcpy(out, p, bytesPerPixel);
+			p += bytesPerPixel;
+		} else { // raw pixels
+			if (static_cast<size_t>(end - p) < packetBytes)
+				throw std::runtime_error("TGA image data is truncated");
+			memcpy(out, p, packetBytes);
+			out += packetBytes;
+			p += packetBytes;
+		}
+	}
+}
+
+size_t TGAImage::getWidth() const {
+	return width;
+}
+
+size_t TGAImage::getHeight() const {
+	return height;
+}
+
+void TGAImage::getRGBRow(size_t row, unsigned char output[]) const {
+	const unsigned char* p = rows[row];
+	// right-to-left rows are read backwards so the output is always left to right
+	ptrdiff_t step = bytesPerPixel;
+	if (rightToLeft) {
+		p += (width - 1) * bytesPerPixel;
+		step = -step;
+	}
+
+	for (size_t c = 0; c < width; c++, p += step, output += 3) {
+		if (colorMapped) {
+			memcpy(output, palette[p[0]], 3);
+		} else if (grayscale) {
+			output[0] = output[1] = output[2] = p[0];
+		} else if (bytesPerPixel == 2) {
+			expand555(readU16(p), output);
+		} else { // stored as bgr(a)
+			output[0] = p[2];
+			output[1] = p[1];
+			output[2] = p[0];
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "ImageSource.hpp"
+#include "MappedFile.hpp"
+
+/* A Truevision TGA image, mapped into memory. Supports true-color (15, 16, 24 and 32-bit), grayscale and color-mapped images,
+   uncompressed or RLE compressed, in any of the four origins. Uncompressed pixels are read in place */
+class TGAImage : public ImageSource {
+private:
+	MappedFile file;
+	size_t width, height;
+	unsigned int bytesPerPixel;
+	bool grayscale, colorMapped, rightToLeft;
+	/* start of every row of pixels, top row first */
+	std::vector<const unsigned char*> rows;
+	/* rgb of every color map entry, indexed by the stored pixel value */
+	unsigned char palette[256][3];
+	/* pixels of an RLE image, expanded at load time */
+	std::vector<unsigned char> expanded;
+public:
+
+	/* throws std::runtime_error if the file cannot be read or its format is unsupported */
+	TGAImage(const char* const filepath);
+
+	size_t getWidth() const override;
+	size_t getHeight() const override;
+
+	void getRGBRow(size_t row, unsigned char output[]) const override;
+
+private:
+	/* reads nEntries color map entries of the given size, starting at index first */
+	void readColorMap(const unsigned char* p, size_t first, size_t nEntries, unsigned int entryBits);
+
+	/* expands RLE packets into expanded. Packets may run across rows */
+	void decodeRLE(const unsigned char* begin, const unsigned char* end);
+};
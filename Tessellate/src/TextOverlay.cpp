@@ -0,0 +1,158 @@
+#include "TextOverlay.hpp"
+#include "Shader.hpp"
+
+namespace {
+	const int GLYPH_WIDTH = 5;
+	const int GLYPH_HEIGHT = 7;
+
+	/* 5x7 glyphs for ASCII 32 (space) to 95 (underscore). One byte per row, top row first, bit 4 is the leftmost pixel.
+	   Lowercase letters are drawn with the uppercase glyphs. */
+	const unsigned char GLYPHS[64][GLYPH_HEIGHT] = {
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // space
+	{ 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, // '!'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '"'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '#'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '$'
+	{ 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // '%'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '&'
+	{ 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 }, // '\''
+	{ 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // '('
+	{ 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // ')'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '*'
+	{ 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 }, // '+'
+	{ 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 }, // ','
+	{ 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 }, // '-'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C }, // '.'
+	{ 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // '/'
+	{ 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E }, // '0'
+	{ 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E }, // '1'
+	{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F }, // '2'
+	{ 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E }, // '3'
+	{ 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 }, // '4'
+	{ 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E }, // '5'
+	{ 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E }, // '6'
+	{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // '7'
+	{ 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E }, // '8'
+	{ 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C }, // '9'
+	{ 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 }, // ':'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // ';'
+	{ 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, // '<'
+	{ 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 }, // '='
+	{ 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, // '>'
+	{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 }, // '?'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '@'
+	{ 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // 'A'
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E }, // 'B'
+	{ 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E }, // 'C'
+	{ 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C }, // 'D'
+	{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F }, // 'E'
+	{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 }, // 'F'
+	{ 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F }, // 'G'
+	{ 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 }, // 'H'
+	{ 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E }, // 'I'
+	{ 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C }, // 'J'
+	{ 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // 'K'
+	{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F }, // 'L'
+	{ 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 }, // 'M'
+	{ 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // 'N'
+	{ 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'O'
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 }, // 'P'
+	{ 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D }, // 'Q'
+	{ 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 }, // 'R'
+	{ 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E }, // 'S'
+	{ 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // 'T'
+	{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E }, // 'U'
+	{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 }, // 'V'
+	{ 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A }, // 'W'
+	{ 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 }, // 'X'
+	{ 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 }, // 'Y'
+	{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F }, // 'Z'
+	{ 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E }, // '['
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '\\'
+	{ 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E }, // ']'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // '^'
+	{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, // '_'
+
+	};
+}
+
+TextOverlay::TextOverlay(float scale)
+	: scale(scale) {
+
+	glGenVertexArrays(1, &VertexArrayID);
+
+	// Create and compile our GLSL program from the shaders
+	programID = LoadShaders("src/shaders/TextVertexShader.vertexshader", "src/shaders/TextFragmentShader.fragmentshader");
+
+	// Get a handle for our uniforms
+	ScreenSizeID = glGetUniformLocation(programID, "screenSize");
+	TextColorID = glGetUniformLocation(programID, "textColor");
+
+	glGenBuffers(1, &vertexbuffer);
+}
+
+TextOverlay::~TextOverlay() {
+	glDeleteBuffers(1, &vertexbuffer);
+	glDeleteProgram(programID);
+	glDeleteVertexArrays(1, &VertexArrayID);
+}
+
+void TextOverlay::addText(const std::string& text, float x, float y) {
+	float penX = x;
+	for (char ch : text) {
+		// lowercase letters share the uppercase glyphs
+		if (ch >= 'a' && ch <= 'z')
+			ch = ch - 'a' + 'A';
+		if (ch >= 32 && ch < 96) {
+			const unsigned char* glyph = GLYPHS[ch - 32];
+			for (int row = 0; row < GLYPH_HEIGHT; row++) {
+				for (int col = 0; col < GLYPH_WIDTH; col++) {
+					if (!(glyph[row] & (1 << (GLYPH_WIDTH - 1 - col))))
+						continue;
+					float x0 = penX + col * scale, y0 = y + row * scale;
+					float x1 = x0 + scale, y1 = y0 + scale;
+					// two triangles per lit pixel
+					GLfloat quad[12] = { x0, y0, x1, y0, x0, y1, x1, y1, x0, y1, x1, y0 };
+					vertices.insert(vertices.end(), quad, quad + 12);
+				}
+			}
+		}
+		penX += (GLYPH_WIDTH + 1) * scale;
+	}
+}
+
+void TextOverlay::addLines(const std::vector<std::string>& lines, float x, float y) {
+	for (const std::string& line : lines) {
+		addText(line, x, y);
+		y += getLineHeight();
+	}
+}
+
+void TextOverlay::draw(int framebufferWidth, int framebufferHeight) {
+	if (vertices.empty())
+		return;
+
+	// text is always drawn on top
+	glDisable(GL_DEPTH_TEST);
+
+	glUseProgram(programID);
+	glUniform2f(ScreenSizeID, static_cast<float>(framebufferWidth), static_cast<float>(framebufferHeight));
+	glUniform3f(TextColorID, 1.0f, 1.0f, 1.0f);
+
+	glBindVertexArray(VertexArrayID);
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexbuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STREAM_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+	glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices.size() / 2));
+
+	glDisableVertexAttribArray(0);
+	glEnable(GL_DEPTH_TEST);
+
+	vertices.clear();
+}
+
+float TextOverlay::getLineHeight() const {
+	return (GLYPH_HEIGHT + 3) * scale;
+}
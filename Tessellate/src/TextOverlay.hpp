@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+/* Draws lines of text on top of the scene with a built-in 5x7 bitmap font.
+   Every lit pixel of a glyph becomes a small quad, so no textures are needed. */
+class TextOverlay {
+private:
+	/* handle for the shaders */
+	GLuint programID;
+	GLuint VertexArrayID;
+	/* handles for the uniforms */
+	GLuint ScreenSizeID;
+	GLuint TextColorID;
+	GLuint vertexbuffer;
+	/* 2D pixel-space vertices of every queued glyph pixel */
+	std::vector<GLfloat> vertices;
+	/* size in screen pixels of one font pixel */
+	float scale;
+public:
+	/* requires a current OpenGL context */
+	TextOverlay(float scale = 2.0f);
+	~TextOverlay();
+
+	/* queues a line of text. x and y are the top left corner in pixels, measured from the top left of the window */
+	void addText(const std::string& text, float x, float y);
+
+	/* queues several lines below each other */
+	void addLines(const std::vector<std::string>& lines, float x, float y);
+
+	/* draws all queued text over whatever is in the framebuffer and clears the queue */
+	void draw(int framebufferWidth, int framebufferHeight);
+
+	/* height in pixels of one line of text, including spacing */
+	float getLineHeight() const;
+};
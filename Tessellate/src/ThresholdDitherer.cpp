@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+#include "ThresholdDitherer.hpp"
+#include "RGBImage.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TESSELLATE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace {
+	/* how far a threshold can push a channel. Roughly the spacing between sticker colors */
+	const float SPREAD = 128.0f;
+
+	/* turns ranks 0..n-1 into offsets centered on 0 */
+	std::vector<float> ranksToOffsets(const std::vector<int>& ranks) {
+		std::vector<float> offsets(ranks.size());
+		for (size_t i = 0; i < ranks.size(); i++)
+			offsets[i] = ((ranks[i] + 0.5f) / ranks.size() - 0.5f) * SPREAD;
+		return offsets;
+	}
+
+	/* the recursive Bayer matrix of size x size, size a power of 2 */
+	std::vector<float> makeBayer(size_t size) {
+		std::vector<int> ranks(1, 0);
+		for (size_t n = 1; n < size; n *= 2) {
+			// each quadrant of the doubled matrix is 4 * M plus 0, 2, 3, 1
+			static const int QUADRANT[4] = { 0, 2, 3, 1 };
+			std::vector<int> doubled(4 * n * n);
+			for (size_t y = 0; y < 2 * n; y++)
+				for (size_t x = 0; x < 2 * n; x++)
+					doubled[y * 2 * n + x] = 4 * ranks[(y % n) * n + x % n] + QUADRANT[(y / n) * 2 + x / n];
+			ranks.swap(doubled);
+		}
+		return ranksToOffsets(ranks);
+	}
+
+	/* a blue noise mask of size x size made with Ulichney's void-and-cluster method */
+	std::vector<float> makeBlueNoise(size_t size) {
+		const size_t n = size * size;
+		const float SIGMA = 1.5f;
+
+		// toroidal gaussian between any two cells, by offset
+		std::vector<float> kernel(n);
+		for (size_t y = 0; y < size; y++) {
+			for (size_t x = 0; x < size; x++) {
+				float dx = static_cast<float>(std::min(x, size - x));
+				float dy = static_cast<float>(std::min(y, size - y));
+				kernel[y * size + x] = std::exp(-(dx * dx + dy * dy) / (2 * SIGMA * SIGMA));
+			}
+		}
+
+		std::vector<char> pattern(n, 0);
+		std::vector<float> energy(n, 0.0f); // how crowded each cell's neighbourhood is
+		auto toggle = [&](size_t cell, bool on) {
+			pattern[cell] = on;
+			size_t cx = cell % size, cy = cell / size;
+			float sign = on ? 1.0f : -1.0f;
+			for (size_t y = 0; y < size; y++)
+				for (size_t x = 0; x < size; x++)
+					energy[y * size + x] += sign * kernel[((y + size - cy) % size) * size + (x + size - cx) % size];
+		};
+		// the densest set cell, or the emptiest unset cell
+		auto tightestCluster = [&]() {
+			size_t best = n;
+			for (size_t i = 0; i < n; i++)
+				if (pattern[i] && (best == n || energy[i] > energy[best]))
+					best = i;
+			return best;
+		};
+		auto largestVoid = [&]() {
+			size_t best = n;
+			for (size_t i = 0; i < n; i++)
+				if (!pattern[i] && (best == n || energy[i] < energy[best]))
+					best = i;
+			return best;
+		};
+
+		// initial pattern: random points, relaxed until moving the tightest cluster into the largest void changes nothing
+		std::mt19937 rng(1234);
+		size_t nInitial = n / 10;
+		std::vector<size_t> cells(n);
+		for (size_t i = 0; i < n; i++)
+			cells[i] = i;
+		std::shuffle(cells.begin(), cells.end(), rng);
+		for (size_t i = 0; i < nInitial; i++)
+			toggle(cells[i], true);
+		while (true) {
+			size_t cluster = tightestCluster();
+			toggle(cluster, false);
+			size_t gap = largestVoid();
+			toggle(gap, true);
+			if (gap == cluster)
+				break;
+		}
+		std::vector<char> initial = pattern;
+		std::vector<float> initialEnergy = energy;
+
+		std::vector<int> ranks(n);
+		// phase 1: remove the tightest clusters of the initial pattern, ranking down from nInitial
+		for (size_t rank = nInitial; rank-- > 0;) {
+			size_t cluster = tightestCluster();
+			toggle(cluster, false);
+			ranks[cluster] = static_cast<int>(rank);
+		}
+		// phase 2 and 3: fill the largest voids, ranking up
+		pattern = initial;
+		energy = initialEnergy;
+		for (size_t rank = nInitial; rank < n; rank++) {
+			size_t gap = largestVoid();
+			toggle(gap, true);
+			ranks[gap] = static_cast<int>(rank);
+		}
+		return ranksToOffsets(ranks);
+	}
+
+	const std::vector<float>& getMask(DitherMode mode) {
+		static const std::vector<float> BAYER4 = makeBayer(4);
+		static const std::vector<float> BAYER8 = makeBayer(8);
+		switch (mode) {
+		case DitherMode::BAYER4:
+			return BAYER4;
+		case DitherMode::BAYER8:
+			return BAYER8;
+		case DitherMode::BLUE_NOISE: {
+			static const std::vector<float> BLUE_NOISE = makeBlueNoise(64); // generated on first use
+			return BLUE_NOISE;
+		}
+		default:
+			throw std::invalid_argument("error diffusion has no threshold mask");
+		}
+	}
+}
+
+bool parseDitherMode(const char* name, DitherMode& mode) {
+	static const DitherMode MODES[4] = { DitherMode::ERROR_DIFFUSION, DitherMode::BAYER4, DitherMode::BAYER8, DitherMode::BLUE_NOISE };
+	for (DitherMode m : MODES) {
+		if (strcmp(name, getDitherModeName(m)) == 0) {
+			mode = m;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char* getDitherModeName(DitherMode mode) {
+	switch (mode) {
+	case DitherMode::ERROR_DIFFUSION:
+		return "fs";
+	case DitherMode::BAYER4:
+		return "bayer4";
+	case DitherMode::BAYER8:
+		return "bayer8";
+	case DitherMode::BLUE_NOISE:
+		return "bluenoise";
+	}
+	return "unknown";
+}
+
+ThresholdDitherer::ThresholdDitherer(DitherMode mode, const ColorQuantizer& quantizer)
+	: quantizer(quantizer) {
+	const std::vector<float>& offsets = getMask(mode);
+	mask = offsets.data();
+	maskSize = static_cast<size_t>(std::sqrt(static_cast<double>(offsets.size())) + 0.5);
+}
+
+void ThresholdDitherer::ditherRow(const float row[], size_t width, size_t y, Color output[]) const {
+	static const size_t CHANNELS = RGBImage::CHANNELS;
+	const float* maskRow = mask + (y % maskSize) * maskSize;
+
+#ifdef TESSELLATE_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 max = _mm_set1_ps(255.0f);
+	int rounded[4 * CHANNELS];
+	size_t x = 0;
+	// four pixels per iteration: offset, clamp and round, then four table lookups
+	for (; x + 4 <= width; x += 4) {
+		for (size_t i = 0; i < 4; i++) {
+			__m128 pixel = _mm_add_ps(_mm_loadu_ps(row + (x + i) * CHANNELS), _mm_set1_ps(maskRow[(x + i) % maskSize]));
+			pixel = _mm_min_ps(_mm_max_ps(pixel, zero), max);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(rounded + i * CHANNELS), _mm_cvtps_epi32(pixel));
+		}
+		for (size_t i = 0; i < 4; i++)
+			output[x + i] = quantizer.quantize(rounded[i * CHANNELS + 0], rounded[i * CHANNELS + 1], rounded[i * CHANNELS + 2]);
+	}
+	for (; x < width; x++) {
+		__m128 pixel = _mm_add_ps(_mm_loadu_ps(row + x * CHANNELS), _mm_set1_ps(maskRow[x % maskSize]));
+		pixel = _mm_min_ps(_mm_max_ps(pixel, zero), max);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(rounded), _mm_cvtps_epi32(pixel));
+		output[x] = quantizer.quantize(rounded[0], rounded[1], rounded[2]);
+	}
+#else
+	for (size_t x = 0; x < width; x++) {
+		float offset = maskRow[x % maskSize];
+		unsigned char rgb[3];
+		for (size_t c = 0; c < 3; c++)
+			rgb[c] = static_cast<unsigned char>(std::min(std::max(row[x * CHANNELS + c] + offset, 0.0f), 255.0f) + 0.5f);
+		output[x] = quantizer.quantize(rgb[0], rgb[1], rgb[2]);
+	}
+#endif
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+
+#include "ColorQuantizer.hpp"
+
+/* how an image is reduced to sticker colors */
+enum class DitherMode {
+	ERROR_DIFFUSION, // Floyd-Steinberg. Best quality, but serial
+	BAYER4, BAYER8, // ordered dithering
+	BLUE_NOISE // threshold mask without the visible grid pattern of Bayer
+};
+
+/* parses "fs", "bayer4", "bayer8" or "bluenoise". Returns false for anything else */
+bool parseDitherMode(const char* name, DitherMode& mode);
+
+const char* getDitherModeName(DitherMode mode);
+
+/* Ordered dithering: every pixel is offset by a tiling threshold mask before it is quantized.
+   A pixel's result depends only on its own value and position, so rows can be dithered in any order and on any thread */
+class ThresholdDitherer {
+private:
+	const ColorQuantizer& quantizer; // must outlive the ditherer
+	size_t maskSize; // the mask is maskSize x maskSize
+	const float* mask; // offsets in 0..255 units, row-major
+public:
+	/* mode must not be ERROR_DIFFUSION */
+	ThresholdDitherer(DitherMode mode, const ColorQuantizer& quantizer);
+
+	/* maps width pixels (RGBImage::CHANNELS floats each, 0..255) of row y to sticker colors */
+	void ditherRow(const float row[], size_t width, size_t y, Color output[]) const;
+};
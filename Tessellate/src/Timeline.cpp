@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cstdio>
+
+#include "Timeline.hpp"
+#include "Grid.hpp"
+
+namespace {
+	/* seconds between checkpoints before any are thinned out */
+	const double CHECKPOINT_INTERVAL = 2.0;
+
+	/* longest step of a seek forward while a producer refills the queues. Short enough that no queue runs dry within one */
+	const double REFILL_STEP = 0.25;
+
+	/* added to the last step to the end, so rounding cannot leave the last move a hair short of finishing */
+	const double END_MARGIN = 1e-4;
+}
+
+Timeline::Timeline()
+	: time(0), stepEnd(0), playing(true), stale(true), seeking(false), interval(CHECKPOINT_INTERVAL), nLogged(0) {}
+
+void Timeline::update(Grid& grid, float deltatime) {
+	if (stale || logs.size() != grid.cubes.size())
+		restart(grid.cubes);
+	if (playing)
+		step(grid, deltatime);
+}
+
+void Timeline::play() {
+	playing = true;
+}
+
+void Timeline::pause() {
+	playing = false;
+}
+
+bool Timeline::isPlaying() const {
+	return playing;
+}
+
+double Timeline::getTime() const {
+	return time;
+}
+
+double Timeline::getStartTime() const {
+	return checkpoints.empty() ? 0 : checkpoints.front().time;
+}
+
+double Timeline::getEndTime(const CubeArena& cubes) const {
+	double end = time;
+	for (size_t i = 0; i < cubes.size(); i++) {
+		size_t pending = cubes.queueEnd[i] - cubes.queueFront[i];
+		if (pending > 0 && cubes.solveSpeeds[i] > 0)
+			end = std::max(end, time + (pending - cubes.turnProgress[i]) * cubes.getTurnDuration(i));
+	}
+	return end;
+}
+
+void Timeline::seek(Grid& grid, double seconds, const std::function<void()>& refill) {
+	if (stale || logs.size() != grid.cubes.size())
+		restart(grid.cubes);
+	seconds = std::max(seconds, getStartTime());
+	if (seconds < time) {
+		seekBack(grid, seconds);
+		return;
+	}
+	while (time < seconds) {
+		if (refill)
+			refill();
+		step(grid, std::min(seconds - time, refill ? REFILL_STEP : interval));
+	}
+}
+
+void Timeline::seekToEnd(Grid& grid, const std::function<void()>& refill) {
+	if (stale || logs.size() != grid.cubes.size())
+		restart(grid.cubes);
+	for (;;) {
+		if (refill)
+			refill();
+		double end = getEndTime(grid.cubes);
+		if (end <= time)
+			break;
+		step(grid, std::min(end - time + END_MARGIN, refill ? REFILL_STEP : interval));
+	}
+}
+
+std::string Timeline::describe(const CubeArena& cubes) const {
+	char line[64];
+	snprintf(line, sizeof(line), "TIME %.1f/%.1f S %s", time, getEndTime(cubes), playing ? "PLAYING" : "PAUSED");
+	return line;
+}
+
+void Timeline::onMove(size_t index, Move move, float ago) {
+	if (index < logs.size()) {
+		logs[index].push_back(Entry{ stepEnd - ago, move });
+		nLogged++;
+	}
+}
+
+void Timeline::onRestart(size_t, const CubeState&) {
+	if (!seeking)
+		stale = true;
+}
+
+void Timeline::onResize(size_t, size_t, const CubeArena&) {
+	stale = true;
+}
+
+void Timeline::restart(const CubeArena& cubes) {
+	time = stepEnd = 0;
+	interval = CHECKPOINT_INTERVAL;
+	logs.assign(cubes.size(), std::vector<Entry>());
+	nLogged = 0;
+	checkpoints.clear();
+	takeCheckpoint(cubes);
+	stale = false;
+}
+
+void Timeline::step(Grid& grid, double deltatime) {
+	stepEnd = time + deltatime;
+	grid.update(static_cast<float>(deltatime));
+	time = stepEnd;
+	if (time >= checkpoints.back().time + interval)
+		takeCheckpoint(grid.cubes);
+}
+
+void Timeline::takeCheckpoint(const CubeArena& cubes) {
+	Checkpoint checkpoint{ time, cubes.states, std::vector<uint32_t>(logs.size()) };
+	for (size_t i = 0; i < logs.size(); i++)
+		checkpoint.logSizes[i] = static_cast<uint32_t>(logs[i].size());
+	checkpoints.push_back(std::move(checkpoint));
+
+	// past half the budget, keep every other checkpoint and take them half as often from now on. The other half is for the logs
+	size_t bytes = std::max<size_t>(cubes.size() * (sizeof(CubeState) + sizeof(uint32_t)), 1);
+	if (checkpoints.size() > std::max<size_t>(HISTORY_BYTES / 2 / bytes, 4)) {
+		size_t kept = 1;
+		for (size_t i = 2; i < checkpoints.size(); i += 2)
+			checkpoints[kept++] = std::move(checkpoints[i]);
+		checkpoints.resize(kept);
+		interval *= 2;
+	}
+	// past the whole budget, the moves are what grows: forget the oldest history. The checkpoint just taken always stays
+	while (checkpoints.size() > 1 && checkpoints.size() * bytes + nLogged * sizeof(Entry) > HISTORY_BYTES)
+		forgetOldest();
+}
+
+void Timeline::forgetOldest() {
+	checkpoints.erase(checkpoints.begin());
+	std::vector<uint32_t> forgotten = checkpoints.front().logSizes;
+	for (size_t i = 0; i < logs.size(); i++) {
+		logs[i].erase(logs[i].begin(), logs[i].begin() + forgotten[i]);
+		nLogged -= forgotten[i];
+	}
+	for (Checkpoint& checkpoint : checkpoints)
+		for (size_t i = 0; i < logs.size(); i++)
+			checkpoint.logSizes[i] -= forgotten[i];
+}
+
+void Timeline::seekBack(Grid& grid, double seconds) {
+	size_t c = checkpoints.size() - 1;
+	while (c > 0 && checkpoints[c].time > seconds)
+		c--;
+	const Checkpoint& checkpoint = checkpoints[c];
+
+	CubeArena& cubes = grid.cubes;
+	seeking = true;
+	for (size_t i = 0; i < cubes.size(); i++) {
+		std::vector<Entry>& log = logs[i];
+		size_t k = checkpoint.logSizes[i];
+		bool changed = k < log.size(); // a move finished since the checkpoint
+		if (changed) {
+			cubes.states[i] = checkpoint.states[i];
+			while (k < log.size() && log[k].time <= seconds)
+				cubes.states[i].apply(log[k++].move);
+		}
+
+		if (k < log.size()) {
+			// the moves after the time are made again. The first was part way through its turn, unless it was queued after the time
+			std::vector<Move> undone;
+			for (size_t u = k; u < log.size(); u++)
+				undone.push_back(log[u].move);
+			cubes.pushFront(i, undone.data(), undone.size());
+			if (cubes.solveSpeeds[i] > 0)
+				cubes.turnProgress[i] = static_cast<float>(std::min(std::max(1 - (log[k].time - seconds) / cubes.getTurnDuration(i), 0.0), 0.999));
+			nLogged -= log.size() - k;
+			log.resize(k);
+		} else if (cubes.queueEnd[i] != cubes.queueFront[i] && cubes.solveSpeeds[i] > 0) {
+			// no move finished after the time, but the front one may be part way through its turn. If it turned without a break since
+			// before the time, winding it back at its speed puts it where it was. If it was queued after the time, it stops at 0
+			cubes.turnProgress[i] = static_cast<float>(std::max(cubes.turnProgress[i] - (time - seconds) / cubes.getTurnDuration(i), 0.0));
+		}
+		if (changed)
+			cubes.notifyRestart(i);
+	}
+	seeking = false;
+
+	checkpoints.resize(c + 1);
+	time = stepEnd = seconds;
+}
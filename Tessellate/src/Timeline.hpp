@@ -0,0 +1,97 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "CubeArena.hpp"
+
+class Grid;
+
+/* A clock for the whole grid that can be paused, scrubbed and jumped to any time, back or forward.
+   Every move a cube finishes is logged with the time it finished, and every few seconds the states of all cubes are copied
+   into a checkpoint. Seeking back restores the last checkpoint before the time and replays the moves logged since;
+   the moves after the time go back to the front of their queues, and turns in progress are wound back at their cubes' speeds.
+   A move a producer queued on an idle cube after the time is wound back to its start, so it replays from the time rather than
+   from when it was queued. Seeking forward runs the grid in big steps, which applies every move due instantly.
+   Checkpoints are thinned out as they accumulate, and once they and the logs take more than HISTORY_BYTES the oldest checkpoint
+   and the moves before the next are forgotten, so a long show or a live stream keeps a bounded history: seeking back stops at
+   getStartTime. A cube changed without a move, or a grid replaced, starts the history over at time 0 */
+class Timeline : public CubeObserver {
+public:
+	/* memory the checkpoints and the logs may take */
+	static const size_t HISTORY_BYTES = 64 * 1024 * 1024;
+private:
+	/* a move of one cube and when it finished. Doubles keep the times exact in shows that run for hours */
+	struct Entry {
+		double time;
+		Move move;
+	};
+
+	/* the states of all cubes at a time, and how many moves each had logged by then */
+	struct Checkpoint {
+		double time;
+		std::vector<CubeState> states;
+		std::vector<uint32_t> logSizes;
+	};
+
+	double time; // seconds since the history started
+	double stepEnd; // the time the update in progress ends at. Moves are logged relative to it
+	bool playing;
+	bool stale; // the history no longer leads to the cubes' states, and starts over on the next update
+	bool seeking; // the notifications of the cubes changed by a seek are not news
+	double interval; // seconds between checkpoints
+	std::vector<std::vector<Entry>> logs; // per cube, oldest first, from the first checkpoint on
+	size_t nLogged; // entries in all logs
+	std::vector<Checkpoint> checkpoints; // oldest first. The first is at getStartTime
+public:
+	Timeline();
+
+	/* advances grid by deltatime while playing, in place of Grid::update, and keeps the history */
+	void update(Grid& grid, float deltatime);
+
+	void play();
+
+	void pause();
+
+	bool isPlaying() const;
+
+	/* seconds since the history started */
+	double getTime() const;
+
+	/* the earliest time still remembered, which seeking back cannot go past. 0 until the history outgrows HISTORY_BYTES */
+	double getStartTime() const;
+
+	/* when the last move queued on the cubes finishes at their current speeds. Cubes that do not turn are left out */
+	double getEndTime(const CubeArena& cubes) const;
+
+	/* moves the grid to seconds, which is clamped at getStartTime. Going forward, refill runs before every step
+	   so producers that queue moves lazily (see ChoreographyPlayer) keep up */
+	void seek(Grid& grid, double seconds, const std::function<void()>& refill = nullptr);
+
+	/* moves the grid to the time its last queued move finishes, refilling the queues as it goes */
+	void seekToEnd(Grid& grid, const std::function<void()>& refill = nullptr);
+
+	/* a line for the HUD, ex. "TIME 12.3/45.6 S PLAYING" */
+	std::string describe(const CubeArena& cubes) const;
+
+	void onMove(size_t index, Move move, float ago) override;
+	void onRestart(size_t, const CubeState&) override;
+	void onResize(size_t, size_t, const CubeArena&) override;
+
+private:
+	/* forgets the history and starts it over at time 0 from the current states */
+	void restart(const CubeArena& cubes);
+
+	/* runs the grid for deltatime, playing or not, and takes a checkpoint when one is due */
+	void step(Grid& grid, double deltatime);
+
+	/* takes a checkpoint, then thins out or forgets the oldest ones until the history fits in HISTORY_BYTES */
+	void takeCheckpoint(const CubeArena& cubes);
+
+	/* forgets the oldest checkpoint and the moves logged before the next one */
+	void forgetOldest();
+
+	/* restores the last checkpoint at or before seconds and replays the moves since */
+	void seekBack(Grid& grid, double seconds);
+};
@@ -0,0 +1,19 @@
+#include "VertexPacker.hpp"
+
+namespace {
+	/* cubes per job. Big enough to amortize scheduling, small enough to balance the load */
+	const size_t CHUNK = 32;
+}
+
+VertexPacker::VertexPacker(JobSystem& jobs)
+	: jobs(jobs) {
+}
+
+void VertexPacker::pack(const CubeArena& cubes, GLfloat* vertices, GLfloat* colors) {
+	jobs.parallelFor(cubes.size(), CHUNK, [&](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++) {
+			cubes.getVertexData(i, vertices + i * FLOATS_PER_CUBE);
+			cubes.getColorData(i, colors + i * FLOATS_PER_CUBE);
+		}
+	});
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "CubeArena.hpp"
+#include "JobSystem.hpp"
+
+/* Packs the world-space vertices and colors of every cube into one grid-wide buffer, in chunks spread over the job system.
+   Cube i always lands at offset i * FLOATS_PER_CUBE, so the buffers can be drawn with a single multi-draw call. */
+class VertexPacker {
+public:
+	static const size_t VERTICES_PER_CUBE = 3 * 2 * 9 * 6; // 3 vertices per triangle * 2 triangles per square * 9 squares * 6 faces
+	static const size_t FLOATS_PER_CUBE = CubeArena::FLOATS_PER_CUBE;
+private:
+	JobSystem& jobs;
+public:
+	VertexPacker(JobSystem& jobs = JobSystem::shared());
+
+	/* fills vertices and colors (each at least cubes.size() * FLOATS_PER_CUBE floats). Blocks until done */
+	void pack(const CubeArena& cubes, GLfloat* vertices, GLfloat* colors);
+};
@@ -0,0 +1,82 @@
+#include <algorithm>
+
+#include "VideoFrame.hpp"
+
+namespace {
+	unsigned char clampByte(int value) {
+		return static_cast<unsigned char>(std::min(std::max(value, 0), 255));
+	}
+}
+
+VideoFrame::VideoFrame(size_t width, size_t height, Format format)
+	: width(width), height(height), format(format) {
+	size_t luma = width * height;
+	size_t chromaWidth = (width + 1) / 2;
+	switch (format) {
+	case Format::RGB24:
+		data.resize(luma * 3);
+		break;
+	case Format::YUV444:
+		data.resize(luma * 3);
+		break;
+	case Format::YUV422:
+		data.resize(luma + 2 * chromaWidth * height);
+		break;
+	case Format::YUV420:
+		data.resize(luma + 2 * chromaWidth * ((height + 1) / 2));
+		break;
+	case Format::GRAY:
+		data.resize(luma);
+		break;
+	}
+}
+
+size_t VideoFrame::getWidth() const {
+	return width;
+}
+
+size_t VideoFrame::getHeight() const {
+	return height;
+}
+
+void VideoFrame::getRGBRow(size_t row, unsigned char output[]) const {
+	if (format == Format::RGB24) {
+		std::copy(data.begin() + row * width * 3, data.begin() + (row + 1) * width * 3, output);
+		return;
+	}
+
+	// locate this row in each plane
+	const unsigned char* y = data.data() + row * width;
+	const unsigned char* u = nullptr;
+	const unsigned char* v = nullptr;
+	size_t chromaShift = 0; // log2 of the horizontal subsampling
+	if (format == Format::YUV444) {
+		u = data.data() + width * height + row * width;
+		v = u + width * height;
+	} else if (format == Format::YUV422 || format == Format::YUV420) {
+		size_t chromaWidth = (width + 1) / 2;
+		size_t chromaHeight = format == Format::YUV422 ? height : (height + 1) / 2;
+		size_t chromaRow = format == Format::YUV422 ? row : row / 2;
+		u = data.data() + width * height + chromaRow * chromaWidth;
+		v = u + chromaWidth * chromaHeight;
+		chromaShift = 1;
+	}
+
+	for (size_t x = 0; x < width; x++) {
+		// BT.601 limited range, in 1/256 steps
+		int c = 298 * (y[x] - 16);
+		int d = u ? u[x >> chromaShift] - 128 : 0;
+		int e = v ? v[x >> chromaShift] - 128 : 0;
+		output[x * 3 + 0] = clampByte((c + 409 * e + 128) >> 8);
+		output[x * 3 + 1] = clampByte((c - 100 * d - 208 * e + 128) >> 8);
+		output[x * 3 + 2] = clampByte((c + 516 * d + 128) >> 8);
+	}
+}
+
+unsigned char* VideoFrame::getData() {
+	return data.data();
+}
+
+size_t VideoFrame::getSize() const {
+	return data.size();
+}
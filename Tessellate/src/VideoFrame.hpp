@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+
+#include "ImageSource.hpp"
+
+/* One uncompressed video frame, kept exactly as it arrives: interleaved rgb or planar YUV.
+   Rows are converted to rgb only when the pipeline asks for them */
+class VideoFrame : public ImageSource {
+public:
+	enum class Format {
+		RGB24, // 3 bytes per pixel
+		YUV444, YUV422, YUV420, // planar, BT.601 limited range
+		GRAY // luma plane only
+	};
+private:
+	size_t width, height;
+	Format format;
+	std::vector<unsigned char> data;
+public:
+	VideoFrame(size_t width, size_t height, Format format);
+
+	size_t getWidth() const override;
+	size_t getHeight() const override;
+
+	void getRGBRow(size_t row, unsigned char output[]) const override;
+
+	/* the frame's bytes, to be filled by the reader */
+	unsigned char* getData();
+	size_t getSize() const;
+};
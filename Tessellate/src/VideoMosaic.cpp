@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <cstdio>
+
+#include "VideoMosaic.hpp"
+#include "ImageStream.hpp"
+#include "AI.hpp"
+
+VideoMosaic::VideoMosaic(FrameSource* source, const GridFit& fit, const ColorQuantizer& quantizer, DitherMode mode)
+	: source(source), fit(fit), quantizer(quantizer), mode(mode),
+	target(fit.rows * fit.cols * 9, Color::WHITE), painted(fit.rows * fit.cols * 9), everPainted(fit.rows * fit.cols, 0),
+	band(ImageStream::BAND_ROWS * fit.cols * 3), nProcessed(0), nRetargeted(0) {}
+
+VideoMosaic::~VideoMosaic() {
+	delete source;
+}
+
+void VideoMosaic::start(Grid& grid) {
+	grid.resize(fit.rows, fit.cols);
+	std::fill(everPainted.begin(), everPainted.end(), 0);
+}
+
+void VideoMosaic::update(Grid& grid) {
+	size_t width = fit.cols * 3;
+
+	// only the newest frame matters. Anything older was dropped by the source
+	const VideoFrame* frame = source->acquire();
+	if (frame) {
+		ImageStream stream(*frame, fit, quantizer, mode);
+		for (size_t r = 0; stream.nextBand(band.data()); r++)
+			std::copy(band.begin(), band.end(), target.begin() + r * band.size());
+		nProcessed++;
+	}
+
+	for (size_t r = 0; r < fit.rows; r++) {
+		for (size_t c = 0; c < fit.cols; c++) {
+			size_t tile = r * fit.cols + c;
+			CubeRef cube = grid.cubes[tile];
+			if (cube.getQueueSize() > 0) // busy. It will get the newest pattern once it is done
+				continue;
+
+			Color pattern[9];
+			for (size_t i = 0; i < 9; i++)
+				pattern[i] = target[(r * 3 + i / 3) * width + c * 3 + i % 3];
+			if (everPainted[tile] && std::equal(pattern, pattern + 9, painted.begin() + tile * 9))
+				continue;
+
+			AI ai(cube);
+			ai.calculatePaint(pattern);
+			ai.start();
+			std::copy(pattern, pattern + 9, painted.begin() + tile * 9);
+			everPainted[tile] = 1;
+			nRetargeted++;
+		}
+	}
+}
+
+bool VideoMosaic::isFinished() const {
+	return source->isFinished();
+}
+
+std::string VideoMosaic::describe() const {
+	char line[96];
+	snprintf(line, sizeof(line), "VIDEO %zu FRAMES  %zu SHOWN  %zu DROPPED  %zu RETARGETS%s",
+		source->getFrameCount(), nProcessed, source->getDroppedCount(), nRetargeted, isFinished() ? "  [END]" : "");
+	return line;
+}
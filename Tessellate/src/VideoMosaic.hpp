@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "FrameSource.hpp"
+#include "GridFit.hpp"
+#include "ColorQuantizer.hpp"
+#include "ThresholdDitherer.hpp"
+#include "Grid.hpp"
+
+/* Drives a grid from a live video stream. Every new frame is downscaled and dithered to a target pattern;
+   cubes whose tile changed are sent to the new pattern as soon as they are idle. A cube that is still turning
+   is retargeted later, straight to the newest frame, so the grid never works through a backlog of stale frames */
+class VideoMosaic {
+private:
+	FrameSource* source;
+	GridFit fit;
+	const ColorQuantizer& quantizer; // must outlive the mosaic
+	DitherMode mode;
+	std::vector<Color> target; // stickers of the newest frame, 3 * rows x 3 * cols, row-major
+	std::vector<Color> painted; // the pattern each cube was last sent to, 9 per cube
+	std::vector<char> everPainted; // whether each cube was sent a pattern yet
+	std::vector<Color> band;
+	size_t nProcessed, nRetargeted;
+public:
+	/* takes ownership of source */
+	VideoMosaic(FrameSource* source, const GridFit& fit, const ColorQuantizer& quantizer, DitherMode mode);
+	~VideoMosaic();
+
+	VideoMosaic(const VideoMosaic&) = delete;
+	VideoMosaic& operator=(const VideoMosaic&) = delete;
+
+	/* resizes the grid to the mosaic */
+	void start(Grid& grid);
+
+	/* takes the newest frame, if there is one, and retargets the idle cubes whose tile changed. Call once per frame */
+	void update(Grid& grid);
+
+	bool isFinished() const;
+
+	/* a line for the HUD */
+	std::string describe() const;
+};
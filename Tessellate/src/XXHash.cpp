@@ -0,0 +1,83 @@
+#include "XXHash.hpp"
+
+namespace {
+	const uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+	const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+	const uint64_t PRIME3 = 0x165667B19E3779F9ull;
+	const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+	const uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+	uint64_t rotl(uint64_t x, int r) {
+		return (x << r) | (x >> (64 - r));
+	}
+
+	// the input is read little-endian, so hashes are the same on every machine
+	uint64_t read64(const unsigned char* p) {
+		uint64_t v = 0;
+		for (int i = 7; i >= 0; i--)
+			v = (v << 8) | p[i];
+		return v;
+	}
+
+	uint32_t read32(const unsigned char* p) {
+		return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+	}
+
+	uint64_t round(uint64_t acc, uint64_t input) {
+		acc += input * PRIME2;
+		return rotl(acc, 31) * PRIME1;
+	}
+
+	uint64_t mergeRound(uint64_t acc, uint64_t v) {
+		acc ^= round(0, v);
+		return acc * PRIME1 + PRIME4;
+	}
+}
+
+uint64_t xxHash64(const void* data, size_t length, uint64_t seed) {
+	const unsigned char* p = static_cast<const unsigned char*>(data);
+	const unsigned char* end = p + length;
+	uint64_t h;
+
+	if (length >= 32) {
+		// four independent lanes over 32-byte stripes
+		uint64_t v1 = seed + PRIME1 + PRIME2;
+		uint64_t v2 = seed + PRIME2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - PRIME1;
+		const unsigned char* limit = end - 32;
+		do {
+			v1 = round(v1, read64(p));
+			v2 = round(v2, read64(p + 8));
+			v3 = round(v3, read64(p + 16));
+			v4 = round(v4, read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+		h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+		h = mergeRound(h, v1);
+		h = mergeRound(h, v2);
+		h = mergeRound(h, v3);
+		h = mergeRound(h, v4);
+	} else {
+		h = seed + PRIME5;
+	}
+	h += length;
+
+	// the tail, 8, 4 and then 1 byte at a time
+	for (; p + 8 <= end; p += 8)
+		h = rotl(h ^ round(0, read64(p)), 27) * PRIME1 + PRIME4;
+	if (p + 4 <= end) {
+		h = rotl(h ^ (read32(p) * PRIME1), 23) * PRIME2 + PRIME3;
+		p += 4;
+	}
+	for (; p < end; p++)
+		h = rotl(h ^ (*p * PRIME5), 11) * PRIME1;
+
+	// avalanche
+	h ^= h >> 33;
+	h *= PRIME2;
+	h ^= h >> 29;
+	h *= PRIME3;
+	h ^= h >> 32;
+	return h;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/* the 64-bit xxHash of length bytes of data. Fast and well mixed, but not cryptographic: equal hashes are checked against the content */
+uint64_t xxHash64(const void* data, size_t length, uint64_t seed = 0);
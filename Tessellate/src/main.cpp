@@ -1,3 +1,10 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
 // include GLEW
 #define GLEW_STATIC
 #include <GL/glew.h>
@@ -6,10 +13,133 @@
 #include <GLFW/glfw3.h>
 
 #include "App.hpp"
+#include "CommandReader.hpp"
+#include "ShardCoordinator.hpp"
+#include "ShardWorker.hpp"
+
+int main(int argc, char* argv[]) {
+    // started by a ShardCoordinator: plan tiles without opening a window
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--worker") == 0)
+            return ShardWorker::run();
+
+    // parse arguments
+    float targetFps = 60.0f;
+    const char* imagePath = nullptr;
+    const char* stickersPath = nullptr;
+    const char* videoPath = nullptr;
+    int videoWidth = 0, videoHeight = 0;
+    std::vector<const char*> scriptPaths;
+    const char* socketPath = nullptr;
+    const char* recordPath = nullptr;
+    const char* playPath = nullptr;
+    const char* cachePath = nullptr;
+    const char* snapshotPath = nullptr;
+    bool restore = false;
+    int cacheMegabytes = 64;
+    int rows = 0, cols = 0, budget = 0, workers = 0;
+    FitMode fitMode = FitMode::CROP;
+    DitherMode ditherMode = DitherMode::ERROR_DIFFUSION;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+            targetFps = static_cast<float>(atof(argv[++i]));
+        else if (strcmp(argv[i], "--image") == 0 && i + 1 < argc)
+            imagePath = argv[++i];
+        else if (strcmp(argv[i], "--video") == 0 && i + 1 < argc) // YUV4MPEG2 stream, "-" for stdin
+            videoPath = argv[++i];
+        else if (strcmp(argv[i], "--video-size") == 0 && i + 1 < argc) // WIDTHxHEIGHT of raw rgb24 frames
+            sscanf(argv[++i], "%dx%d", &videoWidth, &videoHeight);
+        else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) // file of commands, may be repeated
+            scriptPaths.push_back(argv[++i]);
+        else if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) // UNIX socket to accept commands on
+            socketPath = argv[++i];
+        else if (strcmp(argv[i], "--stickers") == 0 && i + 1 < argc)
+            stickersPath = argv[++i];
+        else if (strcmp(argv[i], "--dither") == 0 && i + 1 < argc) { // fs, bayer4, bayer8 or bluenoise
+            if (!parseDitherMode(argv[++i], ditherMode))
+                std::cout << "Unknown dithering mode " << argv[i] << ". Using " << getDitherModeName(ditherMode) << "." << std::endl;
+        } else if (strcmp(argv[i], "--fit") == 0 && i + 1 < argc) { // stretch, crop or letterbox
+            if (!parseFitMode(argv[++i], fitMode))
+                std::cout << "Unknown fit mode " << argv[i] << ". Using " << getFitModeName(fitMode) << "." << std::endl;
+        } else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) // maximum number of cubes
+            budget = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--cubes") == 0 && i + 1 < argc) { // ROWSxCOLS, or N for a square grid
+            if (sscanf(argv[++i], "%dx%d", &rows, &cols) == 1)
+                cols = rows;
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) // processes to plan tiles in
+            workers = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) // file to write the grid's moves to on exit
+            recordPath = argv[++i];
+        else if (strcmp(argv[i], "--play") == 0 && i + 1 < argc) // recorded show to play
+            playPath = argv[++i];
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) // directory to keep solved images in
+            cachePath = argv[++i];
+        else if (strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc) // megabytes the cache may use
+            cacheMegabytes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) // file F5 saves the grid to and F9 restores it from
+            snapshotPath = argv[++i];
+        else if (strcmp(argv[i], "--restore") == 0 && i + 1 < argc) { // snapshot to start from
+            snapshotPath = argv[++i];
+            restore = true;
+        }
+    }
 
-int main() {
     // Create app
-    App app;
+    App app(targetFps > 0 ? targetFps : 60.0f);
+    if (imagePath)
+        app.setImagePath(imagePath);
+    if (budget > 0)
+        app.setCubeBudget(budget);
+    if (rows > 0 && cols > 0)
+        app.setImageSize(rows, cols);
+    app.setFitMode(fitMode);
+    if (stickersPath)
+        app.setStickerColors(stickersPath);
+    app.setDitherMode(ditherMode);
+    if (workers > 0) {
+        try {
+            app.setWorkers(workers, ShardCoordinator::getWorkerCommand(argv[0]));
+        } catch (const std::runtime_error& e) {
+            std::cout << "Could not start workers: " << e.what() << ". Planning tiles in this process." << std::endl;
+        }
+    }
+    if (videoPath) {
+        try {
+            app.startVideo(videoPath, videoWidth > 0 ? videoWidth : 0, videoHeight > 0 ? videoHeight : 0);
+        } catch (const std::runtime_error& e) {
+            std::cout << "Could not start video: " << e.what() << std::endl;
+        }
+    }
+    if (cachePath) {
+        try {
+            app.setCache(cachePath, static_cast<uintmax_t>(cacheMegabytes > 0 ? cacheMegabytes : 64) * 1024 * 1024);
+        } catch (const std::runtime_error& e) {
+            std::cout << e.what() << std::endl;
+        }
+    }
+    if (recordPath)
+        app.startRecording(recordPath);
+    if (playPath) {
+        try {
+            app.playChoreography(playPath);
+        } catch (const std::runtime_error& e) {
+            std::cout << "Could not play show: " << e.what() << std::endl;
+        }
+    }
+    if (snapshotPath)
+        app.setSnapshotPath(snapshotPath);
+    if (restore)
+        app.loadSnapshot();
+
+    // every source of commands gets a channel of its own
+    try {
+        for (const char* path : scriptPaths)
+            app.addCommandChannel(CommandReader::fromScript(path));
+        if (socketPath)
+            app.addCommandChannel(CommandReader::fromSocket(socketPath));
+    } catch (const std::runtime_error& e) {
+        std::cout << e.what() << std::endl;
+    }
 
     // Start app
     app.start();
@@ -0,0 +1,66 @@
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Choreography.hpp"
+#include "ChoreographyPlayer.hpp"
+#include "ChoreographyRecorder.hpp"
+#include "Grid.hpp"
+#include "Tests.hpp"
+
+namespace fs = std::filesystem;
+
+/* every move through the nibble code, then a recorded show played back on a grid */
+void Tests::choreography() {
+    std::vector<unsigned char> stream;
+    std::vector<Move> all;
+    size_t nNibbles = 0;
+    for (size_t m = 0; m < N_MOVES; m++) {
+        unsigned char nibbles[2];
+        size_t n = Choreography::encode(static_cast<Move>(m), nibbles);
+        check(n == (m < N_FACE_MOVES ? 1u : 2u), std::string("wrong code length for ") + getMoveName(static_cast<Move>(m)));
+        for (size_t k = 0; k < n; k++, nNibbles++) {
+            if (nNibbles % 2 == 0)
+                stream.push_back(0);
+            stream.back() |= nibbles[k] << (nNibbles % 2 * 4);
+        }
+        all.push_back(static_cast<Move>(m));
+    }
+    size_t cursor = 0;
+    Move move;
+    for (Move expected : all)
+        check(Choreography::decode(stream.data(), nNibbles, cursor, move) && move == expected, "the nibble code does not round trip");
+    check(!Choreography::decode(stream.data(), nNibbles, cursor, move), "decoding runs past the end of the stream");
+
+    // a show of scrambled cubes, recorded and played back
+    std::mt19937 random(3);
+    Grid grid(3, 4);
+    for (CubeState& state : grid.cubes.states)
+        state = randomState(random);
+    ChoreographyRecorder recorder;
+    recorder.start(grid.nRows, grid.nCols, grid.cubes);
+    std::vector<CubeState> expected = grid.cubes.states;
+    for (size_t i = 0; i < grid.cubes.size(); i++) {
+        for (Move m : randomMoves(random, 20 + i * 17, true)) {
+            recorder.record(i, m);
+            expected[i].apply(m);
+        }
+    }
+    fs::path path = scratchDirectory("choreography") / "show.tsch";
+    recorder.save(path.string().c_str());
+
+    Grid played(1, 1);
+    {
+        ChoreographyPlayer player(path.string().c_str());
+        player.start(played);
+        check(played.nRows == 3 && played.nCols == 4, "the show has the wrong size");
+        while (!player.isFinished()) {
+            player.update(played.cubes);
+            played.update(1000); // finishes every queued move
+        }
+    }
+    played.update(1000);
+    for (size_t i = 0; i < played.cubes.size(); i++)
+        check(played.cubes.states[i] == expected[i], "cube " + std::to_string(i) + " ends the show in another state");
+    fs::remove_all(path.parent_path());
+}
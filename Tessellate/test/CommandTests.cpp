@@ -0,0 +1,84 @@
+#include <cmath>
+#include <thread>
+
+#include "Command.hpp"
+#include "CommandRing.hpp"
+#include "Tests.hpp"
+
+namespace {
+    using namespace Tests;
+
+    /* the types of the commands parsed from line, ex. "SELECT TURN TURN", and whether they all were valid */
+    std::string parse(const std::string& line, bool& valid, std::vector<Command>& commands) {
+        static const char* const NAMES[] = { "TURN", "SELECT", "SCRAMBLE", "RESET", "LOAD", "SEEK", "WAIT" };
+        std::string error, types;
+        commands.clear();
+        valid = parseCommands(line, commands, error);
+        check(valid == error.empty(), "parsing \"" + line + "\" returns " + (valid ? "true with an error" : "false without an error"));
+        for (const Command& command : commands)
+            types += std::string(types.empty() ? "" : " ") + NAMES[static_cast<int>(command.type)];
+        return types;
+    }
+}
+
+void Tests::commands() {
+    bool valid;
+    std::vector<Command> commands;
+    check(parse("select 2 3 F'b SCRAMBLE reset LOAD wait 0.5 SEEK 12 seek end", valid, commands)
+        == "SELECT TURN TURN SCRAMBLE RESET LOAD WAIT SEEK SEEK" && valid, "a valid line parses wrong");
+    check(commands[0].row == 2 && commands[0].col == 3, "SELECT has the wrong cube");
+    check(commands[1].face == FaceType::FRONT && !commands[1].clockwise && commands[2].face == FaceType::BACK && commands[2].clockwise,
+        "F'b turns the wrong faces");
+    check(commands[6].seconds == 0.5f && commands[7].seconds == 12 && std::isinf(commands[8].seconds), "WAIT or SEEK has the wrong time");
+
+    // a bad word is skipped and the rest of the line still parses. An argument that is not a number is parsed as a word of its own
+    const std::pair<const char*, const char*> invalid[] = {
+        { "WAIT -1 F R", "TURN TURN" },
+        { "WAIT F R", "TURN TURN" },
+        { "SELECT 1 U", "TURN" },
+        { "SEEK -3 U SEEK", "TURN" },
+        { "FXR SELECT 0 0", "TURN TURN SELECT" },
+    };
+    for (const std::pair<const char*, const char*>& line : invalid) {
+        check(parse(line.first, valid, commands) == line.second, std::string("\"") + line.first + "\" does not parse to " + line.second);
+        check(!valid, std::string("\"") + line.first + "\" is valid");
+    }
+}
+
+/* a producer and a consumer thread pass more commands than fit in the ring, in order */
+void Tests::commandRing() {
+    CommandRing ring;
+    Command command = Command::turn(FaceType::UP, true);
+    for (size_t i = 0; i < CommandRing::CAPACITY; i++) {
+        command.row = static_cast<unsigned int>(i);
+        check(ring.push(command), "the ring is full before its capacity");
+    }
+    check(!ring.push(command), "the ring takes more than its capacity");
+    for (size_t i = 0; i < CommandRing::CAPACITY; i++)
+        check(ring.pop(command) && command.row == i, "the ring returns commands out of order");
+    check(!ring.pop(command), "an empty ring returns a command");
+
+    const unsigned int N = 200000;
+    std::thread producer([&ring] {
+        Command sent = Command::turn(FaceType::UP, true);
+        for (unsigned int i = 0; i < N; i++) {
+            sent.row = i;
+            sent.seconds = static_cast<float>(i % 1000);
+            while (!ring.push(sent))
+                std::this_thread::yield();
+        }
+    });
+    unsigned int next = 0;
+    bool ordered = true;
+    while (next < N) {
+        Command received;
+        if (!ring.pop(received)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ordered = ordered && received.row == next && received.seconds == static_cast<float>(next % 1000);
+        next++;
+    }
+    producer.join();
+    check(ordered, "commands pass between threads out of order or torn");
+}
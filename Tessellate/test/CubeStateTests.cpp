@@ -0,0 +1,28 @@
+#include <cstring>
+#include <string>
+
+#include "Cube.hpp"
+#include "CubeState.hpp"
+#include "Tests.hpp"
+
+/* the permutation tables of CubeState turn the stickers exactly as Cube's face-by-face swaps do */
+void Tests::cubeState() {
+    std::mt19937 random(1);
+    for (int sequence = 0; sequence < 100; sequence++) {
+        Cube cube;
+        CubeState state = CubeState::standard();
+        for (Move move : randomMoves(random, 50, true)) {
+            cube.perform(toInstruction(move).get());
+            state.apply(move);
+            Color colors[54];
+            cube.getColors(colors);
+            check(memcmp(colors, state.stickers, sizeof(colors)) == 0, std::string("CubeState and Cube differ after ") + getMoveName(move));
+        }
+    }
+    for (size_t m = 0; m < N_MOVES; m++) {
+        CubeState state = randomState(random), turned = state;
+        turned.apply(static_cast<Move>(m));
+        turned.apply(getInverseMove(static_cast<Move>(m)));
+        check(turned == state, std::string("the inverse does not undo ") + getMoveName(static_cast<Move>(m)));
+    }
+}
@@ -0,0 +1,64 @@
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "CameraState.hpp"
+#include "Grid.hpp"
+#include "GridSnapshot.hpp"
+#include "Tests.hpp"
+
+namespace fs = std::filesystem;
+
+/* a grid and camera saved and loaded back, and a truncated snapshot refused */
+void Tests::gridSnapshot() {
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> real(-10, 10);
+    Grid grid(5, 7);
+    for (size_t i = 0; i < grid.cubes.size(); i++) {
+        grid.cubes.states[i] = randomState(random);
+        grid.cubes.positions[i] = glm::vec3(real(random), real(random), real(random));
+        grid.cubes.turnProgress[i] = (real(random) + 10) / 21;
+        grid.cubes.solveSpeeds[i] = real(random) + 10;
+        grid.cubes.selected[i] = i % 3 == 0;
+        std::vector<Move> queue = randomMoves(random, i * 5, true);
+        grid.cubes.push(i, queue.data(), queue.size());
+    }
+    CameraState camera{};
+    camera.eyePosition = glm::vec3(1, 2, 3);
+    camera.vyaw = 0.5f;
+    camera.focusMode = true;
+    camera.view[3][1] = 4;
+    fs::path path = scratchDirectory("snapshot") / "grid.tsnp";
+    GridSnapshot::save(path.string().c_str(), grid, &camera);
+
+    Grid restored(1, 1);
+    CameraState restoredCamera{};
+    ShowPosition show{};
+    uint32_t flags = GridSnapshot::load(path.string().c_str(), restored, restoredCamera, show);
+    check(flags == GridSnapshot::HAS_CAMERA, "the snapshot has the wrong flags");
+    check(restored.nRows == 5 && restored.nCols == 7, "the snapshot has the wrong size");
+    check(restored.cubes.states == grid.cubes.states && restored.cubes.positions == grid.cubes.positions
+        && restored.cubes.turnProgress == grid.cubes.turnProgress && restored.cubes.solveSpeeds == grid.cubes.solveSpeeds
+        && restored.cubes.selected == grid.cubes.selected, "the snapshot changes the cubes");
+    for (size_t i = 0; i < grid.cubes.size(); i++) {
+        std::vector<Move> queue(grid.cubes.movePool.begin() + grid.cubes.queueFront[i], grid.cubes.movePool.begin() + grid.cubes.queueEnd[i]);
+        std::vector<Move> restoredQueue(restored.cubes.movePool.begin() + restored.cubes.queueFront[i],
+            restored.cubes.movePool.begin() + restored.cubes.queueEnd[i]);
+        check(queue == restoredQueue, "the snapshot changes the queue of cube " + std::to_string(i));
+    }
+    check(restoredCamera.eyePosition == camera.eyePosition && restoredCamera.vyaw == camera.vyaw
+        && restoredCamera.focusMode && restoredCamera.view == camera.view, "the snapshot changes the camera");
+
+    // a truncated snapshot is refused and leaves the grid alone
+    fs::resize_file(path, fs::file_size(path) - 1);
+    bool refused = false;
+    try {
+        GridSnapshot::load(path.string().c_str(), restored, restoredCamera, show);
+    } catch (const std::runtime_error&) {
+        refused = true;
+    }
+    check(refused && restored.cubes.states == grid.cubes.states, "a truncated snapshot is loaded");
+    fs::remove_all(path.parent_path());
+}
@@ -0,0 +1,73 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "JobSystem.hpp"
+#include "Tests.hpp"
+
+/* on a pool of its own, so the shared one is left alone */
+void Tests::jobSystem() {
+    JobSystem jobs(3);
+    check(jobs.getThreadCount() == 3, "the pool has the wrong number of threads");
+
+    // every index exactly once, in ranges no longer than the grain
+    std::vector<std::atomic<int>> hits(100003);
+    std::atomic<bool> tooLong(false);
+    jobs.parallelFor(hits.size(), 7, [&](size_t first, size_t last) {
+        if (last - first > 7)
+            tooLong = true;
+        for (size_t i = first; i < last; i++)
+            hits[i]++;
+    });
+    check(!tooLong, "parallelFor runs a range longer than its grain");
+    for (size_t i = 0; i < hits.size(); i++)
+        check(hits[i] == 1, "parallelFor runs index " + std::to_string(i) + " " + std::to_string(hits[i].load()) + " times");
+
+    // a parent finishes only after all of its children
+    std::atomic<int> children(0);
+    std::atomic<bool> parentEarly(false);
+    JobSystem::JobHandle parent = jobs.create([&] {});
+    std::vector<JobSystem::JobHandle> handles;
+    for (int i = 0; i < 64; i++) {
+        handles.push_back(jobs.create([&children] {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            children++;
+        }, parent));
+    }
+    for (const JobSystem::JobHandle& child : handles)
+        jobs.run(child);
+    jobs.run(parent);
+    if (parent->isFinished() && children < 64)
+        parentEarly = true;
+    jobs.wait(parent);
+    check(!parentEarly && children == 64, "a parent finishes before its children");
+    for (const JobSystem::JobHandle& child : handles)
+        check(child->isFinished(), "a child is unfinished after its parent");
+
+    // jobs that wait for jobs of their own run those instead of blocking, so nesting deeper than the pool cannot deadlock
+    std::atomic<size_t> total(0);
+    jobs.parallelFor(16, 1, [&](size_t, size_t) {
+        jobs.parallelFor(1000, 10, [&](size_t first, size_t last) {
+            total += last - first;
+        });
+    });
+    check(total == 16000, "nested parallelFor loses ranges");
+
+    // a background job is picked up while nothing else runs
+    std::atomic<bool> ran(false);
+    JobSystem::JobHandle background = jobs.create([&ran] { ran = true; });
+    jobs.runInBackground(background);
+    for (int i = 0; i < 5000 && !background->isFinished(); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    check(ran && background->isFinished(), "a background job never runs");
+
+    std::vector<JobSystem::WorkerStats> stats = jobs.getStats();
+    check(stats.size() == 4, "the stats have the wrong number of workers");
+    uint64_t nJobs = 0;
+    for (const JobSystem::WorkerStats& worker : stats)
+        nJobs += worker.jobs;
+    check(nJobs >= 65 + 1, "the stats miss jobs");
+}
@@ -0,0 +1,235 @@
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Inflater.hpp"
+#include "PNGImage.hpp"
+#include "Tests.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+    using namespace Tests;
+
+    uint32_t crc32(const unsigned char* data, size_t n, uint32_t crc = 0) {
+        crc = ~crc;
+        for (size_t i = 0; i < n; i++) {
+            crc ^= data[i];
+            for (int k = 0; k < 8; k++)
+                crc = crc & 1 ? 0xEDB88320 ^ (crc >> 1) : crc >> 1;
+        }
+        return ~crc;
+    }
+
+    uint32_t adler32(const std::vector<unsigned char>& data) {
+        uint32_t a = 1, b = 0;
+        for (unsigned char byte : data) {
+            a = (a + byte) % 65521;
+            b = (b + a) % 65521;
+        }
+        return b << 16 | a;
+    }
+
+    void putU32(std::vector<unsigned char>& out, uint32_t v) {
+        for (int i = 3; i >= 0; i--)
+            out.push_back((v >> (8 * i)) & 0xFF);
+    }
+
+    /* data as a zlib stream of stored blocks */
+    std::vector<unsigned char> storeZlib(const std::vector<unsigned char>& data) {
+        std::vector<unsigned char> stream = { 0x78, 0x01 };
+        size_t at = 0;
+        do {
+            size_t n = std::min<size_t>(data.size() - at, 65535);
+            stream.push_back(at + n == data.size() ? 1 : 0);
+            stream.push_back(n & 0xFF);
+            stream.push_back(n >> 8);
+            stream.push_back(~n & 0xFF);
+            stream.push_back((~n >> 8) & 0xFF);
+            stream.insert(stream.end(), data.begin() + at, data.begin() + at + n);
+            at += n;
+        } while (at < data.size());
+        putU32(stream, adler32(data));
+        return stream;
+    }
+
+    void putChunk(std::vector<unsigned char>& file, const char* type, const std::vector<unsigned char>& data) {
+        putU32(file, static_cast<uint32_t>(data.size()));
+        size_t start = file.size();
+        file.insert(file.end(), type, type + 4);
+        file.insert(file.end(), data.begin(), data.end());
+        putU32(file, crc32(&file[start], file.size() - start));
+    }
+
+    unsigned char paeth(unsigned char a, unsigned char b, unsigned char c) {
+        int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+        return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+    }
+
+    /* an image of random samples, with what it should decode to */
+    struct Sample {
+        uint32_t width, height;
+        unsigned char bitDepth, colorType;
+        size_t channels;
+        std::vector<unsigned char> samples; // bitDepth / 8 bytes per sample, big-endian, row-major
+        std::vector<unsigned char> rgb;
+    };
+
+    Sample makeSample(std::mt19937& random, uint32_t width, uint32_t height, unsigned char bitDepth, unsigned char colorType) {
+        Sample sample{ width, height, bitDepth, colorType, colorType == 0 ? 1u : colorType == 2 ? 3u : 4u, {}, {} };
+        size_t bytes = bitDepth / 8;
+        std::uniform_int_distribution<int> pick(0, 255);
+        sample.samples.resize(size_t(width) * height * sample.channels * bytes);
+        for (size_t i = 0; i < sample.samples.size(); i++)
+            sample.samples[i] = static_cast<unsigned char>(colorType == 6 && i / bytes % 4 == 3 ? 255 : pick(random)); // opaque, so no blending
+        for (size_t pixel = 0; pixel < size_t(width) * height; pixel++) {
+            const unsigned char* s = &sample.samples[pixel * sample.channels * bytes];
+            for (int k = 0; k < 3; k++)
+                sample.rgb.push_back(s[(sample.channels == 1 ? 0 : k) * bytes]); // the high byte of 16-bit samples
+        }
+        return sample;
+    }
+
+    /* the image as a PNG file, each row with the next of the five filters, and Adam7 interlaced if asked */
+    std::vector<unsigned char> encode(const Sample& sample, bool interlaced) {
+        static const size_t PASS_X[7] = { 0, 4, 0, 2, 0, 1, 0 }, PASS_Y[7] = { 0, 0, 4, 0, 2, 0, 1 };
+        static const size_t PASS_DX[7] = { 8, 8, 4, 4, 2, 2, 1 }, PASS_DY[7] = { 8, 8, 8, 4, 4, 2, 2 };
+        size_t pixelBytes = sample.channels * sample.bitDepth / 8;
+        std::vector<unsigned char> raw;
+        unsigned int filter = 0;
+        for (size_t pass = 0; pass < (interlaced ? 7u : 1u); pass++) {
+            size_t x0 = interlaced ? PASS_X[pass] : 0, dx = interlaced ? PASS_DX[pass] : 1;
+            size_t y0 = interlaced ? PASS_Y[pass] : 0, dy = interlaced ? PASS_DY[pass] : 1;
+            if (x0 >= sample.width)
+                continue;
+            std::vector<unsigned char> prior, row;
+            for (size_t y = y0; y < sample.height; y += dy, prior = row) {
+                row.clear();
+                for (size_t x = x0; x < sample.width; x += dx) {
+                    const unsigned char* p = &sample.samples[(y * sample.width + x) * pixelBytes];
+                    row.insert(row.end(), p, p + pixelBytes);
+                }
+                if (prior.empty())
+                    prior.assign(row.size(), 0);
+                raw.push_back(static_cast<unsigned char>(filter));
+                for (size_t i = 0; i < row.size(); i++) {
+                    unsigned char a = i >= pixelBytes ? row[i - pixelBytes] : 0, b = prior[i], c = i >= pixelBytes ? prior[i - pixelBytes] : 0;
+                    unsigned char predicted = filter == 1 ? a : filter == 2 ? b : filter == 3 ? static_cast<unsigned char>((a + b) / 2)
+                        : filter == 4 ? paeth(a, b, c) : 0;
+                    raw.push_back(static_cast<unsigned char>(row[i] - predicted));
+                }
+                filter = (filter + 1) % 5;
+            }
+        }
+
+        std::vector<unsigned char> file(PNGImage::SIGNATURE, PNGImage::SIGNATURE + 8), header;
+        putU32(header, sample.width);
+        putU32(header, sample.height);
+        header.insert(header.end(), { sample.bitDepth, sample.colorType, 0, 0, static_cast<unsigned char>(interlaced) });
+        putChunk(file, "IHDR", header);
+        std::vector<unsigned char> stream = storeZlib(raw);
+        // split in two, as encoders often do
+        putChunk(file, "IDAT", std::vector<unsigned char>(stream.begin(), stream.begin() + stream.size() / 2));
+        putChunk(file, "IDAT", std::vector<unsigned char>(stream.begin() + stream.size() / 2, stream.end()));
+        putChunk(file, "IEND", {});
+        return file;
+    }
+
+    std::vector<unsigned char> decode(const fs::path& path, const std::vector<unsigned char>& file, size_t& width, size_t& height) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(reinterpret_cast<const char*>(file.data()), file.size());
+        PNGImage image(path.string().c_str());
+        width = image.getWidth();
+        height = image.getHeight();
+        std::vector<unsigned char> rgb(width * height * 3);
+        for (size_t row = 0; row < height; row++)
+            image.getRGBRow(row, &rgb[row * width * 3]);
+        return rgb;
+    }
+}
+
+/* zlib streams of each block type, made with zlib itself */
+void Tests::inflater() {
+    const std::string text = "tessellate tessellate tessellate";
+    const unsigned char stored[] = {
+        0x78, 0x01, 0x01, 0x20, 0x00, 0xdf, 0xff, 0x74, 0x65, 0x73, 0x73, 0x65, 0x6c, 0x6c, 0x61, 0x74,
+        0x65, 0x20, 0x74, 0x65, 0x73, 0x73, 0x65, 0x6c, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x74, 0x65, 0x73,
+        0x73, 0x65, 0x6c, 0x6c, 0x61, 0x74, 0x65, 0xd5, 0x7a, 0x0c, 0xe3
+    };
+    const unsigned char fixed[] = {
+        0x78, 0x01, 0x2b, 0x49, 0x2d, 0x2e, 0x4e, 0xcd, 0xc9, 0x49, 0x2c, 0x49, 0x55, 0x28, 0xc1, 0xc6,
+        0x04, 0x00, 0xd5, 0x7a, 0x0c, 0xe3
+    };
+    // 500 letters a to f: 'a' + (i * i * 31 + i / 3) % 11 % 6
+    const unsigned char dynamic[] = {
+        0x78, 0xda, 0xed, 0xca, 0xc1, 0x0d, 0x00, 0x30, 0x0c, 0xc2, 0xc0, 0x59, 0x01, 0x93, 0xfd, 0x47,
+        0x68, 0xe6, 0x88, 0xfa, 0xf0, 0xc3, 0xd2, 0x09, 0x26, 0x32, 0xda, 0xe2, 0xa8, 0x75, 0x19, 0xcf,
+        0x2e, 0x94, 0x44, 0x1f, 0x5c, 0x03, 0x0f, 0xb1, 0xa7, 0xc1, 0xd8
+    };
+    std::string letters(500, ' ');
+    for (size_t i = 0; i < letters.size(); i++)
+        letters[i] = static_cast<char>('a' + (i * i * 31 + i / 3) % 11 % 6);
+
+    std::string output(text.size(), ' ');
+    Inflater::inflateZlib(stored, sizeof(stored), reinterpret_cast<unsigned char*>(&output[0]), output.size());
+    check(output == text, "a stored block inflates wrong");
+    output.assign(text.size(), ' ');
+    Inflater::inflateZlib(fixed, sizeof(fixed), reinterpret_cast<unsigned char*>(&output[0]), output.size());
+    check(output == text, "a fixed Huffman block inflates wrong");
+    output.assign(letters.size(), ' ');
+    Inflater::inflateZlib(dynamic, sizeof(dynamic), reinterpret_cast<unsigned char*>(&output[0]), output.size());
+    check(output == letters, "a dynamic Huffman block inflates wrong");
+
+    // a stream that ends early, does not fill the output or fails its checksum is refused
+    unsigned char* out = reinterpret_cast<unsigned char*>(&output[0]);
+    check(throws([&] { Inflater::inflateZlib(dynamic, sizeof(dynamic) / 2, out, letters.size()); }), "a truncated stream inflates");
+    output.assign(text.size() + 1, ' ');
+    out = reinterpret_cast<unsigned char*>(&output[0]);
+    check(throws([&] { Inflater::inflateZlib(fixed, sizeof(fixed), out, text.size() + 1); }), "a stream shorter than its output inflates");
+    check(throws([&] { Inflater::inflateZlib(fixed, sizeof(fixed) - 4, out, text.size()); }), "a stream without its checksum inflates");
+    unsigned char corrupted[sizeof(stored)];
+    memcpy(corrupted, stored, sizeof(stored));
+    corrupted[20] ^= 1;
+    check(throws([&] { Inflater::inflateZlib(corrupted, sizeof(corrupted), out, text.size()); }), "a corrupted stored block inflates");
+}
+
+/* every filter at the pixel sizes with their own unfiltering paths, with and without interlacing, on sizes that leave passes partly empty */
+void Tests::pngImage() {
+    std::mt19937 random(6);
+    fs::path directory = scratchDirectory("png");
+    fs::path path = directory / "image.png";
+    struct Format {
+        unsigned char bitDepth, colorType;
+    };
+    const Format formats[] = { { 8, 0 }, { 8, 2 }, { 8, 6 }, { 16, 2 } };
+    const uint32_t sizes[][2] = { { 1, 1 }, { 3, 2 }, { 13, 11 }, { 40, 9 } };
+    for (const Format& format : formats) {
+        for (const uint32_t* size : sizes) {
+            Sample sample = makeSample(random, size[0], size[1], format.bitDepth, format.colorType);
+            for (bool interlaced : { false, true }) {
+                std::string name = "a " + std::to_string(size[0]) + "x" + std::to_string(size[1]) + " image of color type " + std::to_string(format.colorType)
+                    + " and depth " + std::to_string(format.bitDepth) + (interlaced ? ", interlaced," : "");
+                size_t width, height;
+                std::vector<unsigned char> rgb = decode(path, encode(sample, interlaced), width, height);
+                check(width == sample.width && height == sample.height, name + " has the wrong size");
+                check(rgb == sample.rgb, name + " decodes to other pixels");
+            }
+        }
+    }
+
+    // a corrupted image, and a header claiming more pixels than are stored or than fit in memory, are refused
+    Sample sample = makeSample(random, 13, 11, 8, 2);
+    std::vector<unsigned char> file = encode(sample, false);
+    size_t width, height;
+    std::vector<unsigned char> corrupted = file;
+    corrupted[corrupted.size() / 2] ^= 0x10;
+    check(throws([&] { decode(path, corrupted, width, height); }), "a corrupted image decodes");
+    for (uint32_t side : { 5000u, 0x7FFFFFFFu }) {
+        std::vector<unsigned char> huge = file;
+        for (int i = 0; i < 8; i++)
+            huge[16 + i] = static_cast<unsigned char>(side >> (24 - 8 * (i % 4)));
+        check(throws([&] { decode(path, huge, width, height); }), "a " + std::to_string(side) + " pixels wide image with too little data decodes");
+    }
+    fs::remove_all(directory);
+}
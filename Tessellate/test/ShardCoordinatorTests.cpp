@@ -0,0 +1,67 @@
+#include <chrono>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "AI.hpp"
+#include "ShardCoordinator.hpp"
+#include "ShardProtocol.hpp"
+#include "Tests.hpp"
+
+/* workers started from this binary plan what the AI plans in process, and workers that never answer are given up on */
+void Tests::shardCoordinator() {
+#ifndef _WIN32
+    std::mt19937 random(7);
+    std::vector<TileTask> tasks;
+    for (uint32_t i = 0; i < 300; i++)
+        tasks.push_back(randomTask(random, i, CubeState::standard()));
+    std::vector<std::vector<Move>> expected(tasks.size());
+    for (size_t i = 0; i < tasks.size(); i++) {
+        AI ai(tasks[i].start.stickers);
+        ai.calculatePaint(tasks[i].pattern);
+        expected[i].assign(ai.getInstructions().begin(), ai.getInstructions().end());
+    }
+
+    std::vector<std::string> command = ShardCoordinator::getWorkerCommand("tessellate-tests");
+    {
+        ShardCoordinator coordinator(2, command);
+        std::vector<int> planned(tasks.size(), 0);
+        bool same = true;
+        check(coordinator.plan(tasks, [&](TilePlan& plan) {
+            planned.at(plan.tile)++;
+            same = same && plan.moves == expected[plan.tile];
+        }), "planning is cancelled");
+        for (size_t i = 0; i < tasks.size(); i++)
+            check(planned[i] == 1, "tile " + std::to_string(i) + " is planned " + std::to_string(planned[i]) + " times");
+        check(same, "workers plan other moves than the AI");
+    }
+
+    // a worker that greets, then sits on its shard forever, is restarted until the shard is given up on
+    command.back() = "--hung-worker";
+    ShardCoordinator hung(1, command, 0.2);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::string error;
+    try {
+        hung.plan(std::vector<TileTask>(tasks.begin(), tasks.begin() + 10), [](TilePlan&) {});
+    } catch (const std::runtime_error& e) {
+        error = e.what();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    check(error.find("hung") != std::string::npos, "a shard that hangs every worker is planned");
+    check(seconds < 10, "giving up on a hung worker takes " + std::to_string(seconds) + " seconds");
+#endif
+}
+
+int Tests::hungWorker() {
+#ifndef _WIN32
+    std::vector<unsigned char> message;
+    ShardProtocol::encodeHello(message);
+    ShardProtocol::writeMessage(STDOUT_FILENO, message);
+    while (ShardProtocol::readMessage(STDIN_FILENO, message))
+        ;
+#endif
+    return 0;
+}
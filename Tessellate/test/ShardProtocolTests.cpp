@@ -0,0 +1,67 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ShardProtocol.hpp"
+#include "Tests.hpp"
+
+void Tests::shardProtocol() {
+    std::mt19937 random(2);
+    std::vector<unsigned char> message;
+    ShardProtocol::Type type;
+    uint32_t version = 0;
+    ShardProtocol::encodeHello(message);
+    check(ShardProtocol::getType(message, type) && type == ShardProtocol::Type::HELLO, "HELLO has the wrong type");
+    check(ShardProtocol::decodeHello(message, version) && version == ShardProtocol::VERSION, "HELLO does not round trip");
+
+    std::vector<TileTask> tasks;
+    for (uint32_t i = 0; i < 40; i++)
+        tasks.push_back(randomTask(random, i * 3, randomState(random)));
+    ShardProtocol::encodeShard(7, tasks, 5, 35, message);
+    uint32_t shard = 0;
+    std::vector<TileTask> decoded;
+    check(ShardProtocol::getType(message, type) && type == ShardProtocol::Type::SHARD, "SHARD has the wrong type");
+    check(ShardProtocol::decodeShard(message, shard, decoded) && shard == 7 && decoded.size() == 30, "SHARD does not decode");
+    for (size_t i = 0; i < decoded.size(); i++) {
+        const TileTask& task = tasks[i + 5];
+        check(decoded[i].tile == task.tile && decoded[i].start == task.start
+            && memcmp(decoded[i].pattern, task.pattern, sizeof(task.pattern)) == 0, "SHARD changes tile " + std::to_string(i));
+    }
+    message.pop_back();
+    check(!ShardProtocol::decodeShard(message, shard, decoded), "a truncated SHARD decodes");
+
+    std::vector<TilePlan> plans;
+    for (uint32_t i = 0; i < 20; i++)
+        plans.push_back(TilePlan{ i * 5, randomMoves(random, i * 13, true) });
+    ShardProtocol::encodePlans(9, plans, message);
+    std::vector<TilePlan> decodedPlans;
+    check(ShardProtocol::getType(message, type) && type == ShardProtocol::Type::PLANS, "PLANS has the wrong type");
+    check(ShardProtocol::decodePlans(message, shard, decodedPlans) && shard == 9 && decodedPlans.size() == plans.size(), "PLANS does not decode");
+    for (size_t i = 0; i < plans.size(); i++)
+        check(decodedPlans[i].tile == plans[i].tile && decodedPlans[i].moves == plans[i].moves, "PLANS changes plan " + std::to_string(i));
+    message.pop_back();
+    check(!ShardProtocol::decodePlans(message, shard, decodedPlans), "a truncated PLANS decodes");
+
+    // every decoder refuses an empty message, a message of another type and every truncation of its own, without reading past the end
+    std::vector<unsigned char> hello, shardMessage, plansMessage;
+    ShardProtocol::encodeHello(hello);
+    ShardProtocol::encodeShard(1, tasks, 0, 2, shardMessage);
+    ShardProtocol::encodePlans(2, std::vector<TilePlan>(plans.begin(), plans.begin() + 3), plansMessage);
+    const std::vector<unsigned char>* messages[] = { &hello, &shardMessage, &plansMessage };
+    for (const std::vector<unsigned char>* valid : messages) {
+        for (size_t length = 0; length <= valid->size(); length++) {
+            for (unsigned char t : { 'H', 'S', 'P', 'X' }) {
+                std::vector<unsigned char> changed(valid->begin(), valid->begin() + length);
+                if (!changed.empty())
+                    changed[0] = t;
+                bool decodes = (*valid)[0] == 'H' ? ShardProtocol::decodeHello(changed, version)
+                    : (*valid)[0] == 'S' ? ShardProtocol::decodeShard(changed, shard, decoded)
+                    : ShardProtocol::decodePlans(changed, shard, decodedPlans);
+                bool whole = length == valid->size() && t == (*valid)[0];
+                check(decodes == whole, std::string(1, static_cast<char>((*valid)[0])) + " message cut to " + std::to_string(length)
+                    + " bytes and typed " + std::string(1, static_cast<char>(t)) + (whole ? " does not decode" : " decodes"));
+            }
+        }
+    }
+    check(!ShardProtocol::getType(std::vector<unsigned char>(), type), "an empty message has a type");
+}
@@ -0,0 +1,43 @@
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "SolutionCache.hpp"
+#include "Tests.hpp"
+
+namespace fs = std::filesystem;
+
+/* a grid stored in one cache and loaded by another over the same directory, whole and tile by tile */
+void Tests::solutionCache() {
+    std::mt19937 random(4);
+    fs::path directory = scratchDirectory("cache");
+    std::vector<TileTask> tasks;
+    std::vector<std::vector<Move>> moves;
+    for (uint32_t i = 0; i < 24; i++) {
+        tasks.push_back(randomTask(random, i, CubeState::standard()));
+        moves.push_back(randomMoves(random, i * 3, true));
+    }
+    uint64_t key = SolutionCache::getKey(4, 6, tasks);
+    SolutionCache(directory.string()).store(key, 4, 6, tasks, moves);
+    for (const fs::directory_entry& entry : fs::directory_iterator(directory))
+        check(entry.path().extension() == ".tsol", "storing leaves " + entry.path().filename().string() + " behind");
+
+    SolutionCache cache(directory.string());
+    std::vector<std::vector<Move>> loaded(tasks.size());
+    check(cache.load(key, 4, 6, tasks, loaded), "a stored grid is not found");
+    check(loaded == moves, "a stored grid loads other moves");
+
+    // another grid sharing every other tile
+    std::vector<TileTask> other = tasks;
+    for (size_t i = 1; i < other.size(); i += 2)
+        other[i] = randomTask(random, other[i].tile, CubeState::standard());
+    uint64_t otherKey = SolutionCache::getKey(4, 6, other);
+    check(otherKey != key, "different grids share a key");
+    std::vector<std::vector<Move>> reused(other.size());
+    check(!cache.load(otherKey, 4, 6, other, reused), "a grid never stored is found");
+    std::vector<unsigned char> found(other.size(), 0);
+    cache.reuse(other, reused, found);
+    for (size_t i = 0; i < other.size(); i += 2)
+        check(found[i] && reused[i] == moves[i], "shared tile " + std::to_string(i) + " is not reused");
+    fs::remove_all(directory);
+}
@@ -0,0 +1,195 @@
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "ColorQuantizer.hpp"
+#include "SolveServer.hpp"
+#include "Tests.hpp"
+
+namespace fs = std::filesystem;
+
+#ifdef _WIN32
+
+void Tests::solveServer() {
+    check(throws([] { SolveServer("tessellate.sock", ColorQuantizer()); }), "the server starts on Windows");
+}
+
+#else
+
+namespace {
+    /* one connection to the server, read line by line */
+    class Client {
+        int socket;
+        std::string pending;
+    public:
+        Client(const fs::path& path)
+            : socket(::socket(AF_UNIX, SOCK_STREAM, 0)) {
+            sockaddr_un address{};
+            address.sun_family = AF_UNIX;
+            strcpy(address.sun_path, path.c_str());
+            Tests::check(socket >= 0 && connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0,
+                "cannot connect to the server");
+        }
+
+        ~Client() {
+            close(socket);
+        }
+
+        void send(const std::string& text) {
+            Tests::check(::send(socket, text.data(), text.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(text.size()), "cannot write to the server");
+        }
+
+        /* no more requests. The server answers a last line without a newline, then hangs up once it is done */
+        void hangUp() {
+            shutdown(socket, SHUT_WR);
+        }
+
+        /* the next reply line, or "" once the server hangs up */
+        std::string readLine() {
+            size_t newline;
+            while ((newline = pending.find('\n')) == std::string::npos) {
+                char buffer[4096];
+                ssize_t n = read(socket, buffer, sizeof(buffer));
+                if (n <= 0)
+                    return "";
+                pending.append(buffer, n);
+            }
+            std::string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            return line;
+        }
+
+        /* the lines of the reply to request id, up to and including its DONE or ERROR */
+        std::vector<std::string> readReply(const std::string& id) {
+            std::vector<std::string> lines;
+            for (;;) {
+                std::string line = readLine();
+                Tests::check(!line.empty(), "the server hangs up before answering " + id);
+                lines.push_back(line);
+                if (line.rfind("DONE " + id + " ", 0) == 0 || line.rfind("ERROR " + id + " ", 0) == 0)
+                    return lines;
+            }
+        }
+    };
+
+    std::vector<std::string> split(const std::string& line) {
+        std::istringstream stream(line);
+        std::vector<std::string> words;
+        for (std::string word; stream >> word;)
+            words.push_back(word);
+        return words;
+    }
+
+    /* checks that reply is a tile of each pattern, each of them painted on a standard cube by its moves, then DONE */
+    void checkTiles(const std::vector<std::string>& reply, const std::string& id, const std::vector<std::string>& patterns) {
+        std::map<std::string, Move> moveNames;
+        for (size_t m = 0; m < N_MOVES; m++)
+            moveNames[getMoveName(static_cast<Move>(m))] = static_cast<Move>(m);
+
+        Tests::check(reply.size() == patterns.size() + 1, "request " + id + " has " + std::to_string(reply.size()) + " reply lines");
+        std::vector<bool> seen(patterns.size(), false);
+        for (size_t i = 0; i < patterns.size(); i++) {
+            std::vector<std::string> words = split(reply[i]);
+            Tests::check(words.size() >= 3 && words[0] == "TILE" && words[1] == id, "request " + id + " gets " + reply[i]);
+            size_t index = std::stoul(words[2]);
+            Tests::check(index < patterns.size() && !seen[index], "request " + id + " gets tile " + words[2] + " wrongly");
+            seen[index] = true;
+            CubeState state = CubeState::standard();
+            for (size_t w = 3; w < words.size(); w++) {
+                Tests::check(moveNames.count(words[w]) == 1, "request " + id + " gets the move " + words[w]);
+                state.apply(moveNames[words[w]]);
+            }
+            for (int k = 0; k < 9; k++)
+                Tests::check("ROYGBW"[static_cast<int>(state.getColorAt(FaceType::UP, k))] == toupper(patterns[index][k]),
+                    "tile " + words[2] + " of request " + id + " does not show its pattern");
+        }
+        std::vector<std::string> done = split(reply.back());
+        Tests::check(done.size() == 4 && done[0] == "DONE" && done[2] == std::to_string(patterns.size()), "request " + id + " ends with " + reply.back());
+    }
+}
+
+/* requests of every kind over one socket, the replies streamed back, and requests split or joined across writes */
+void Tests::solveServer() {
+    fs::path directory = scratchDirectory("server");
+    fs::path path = directory / "solve.sock";
+    // never destroyed: run() only returns once its socket fails, and the server lives as long as the check
+    SolveServer* server = new SolveServer(path.string(), ColorQuantizer());
+    std::thread([server] { server->run(); }).detach();
+
+    Client client(path);
+    std::vector<std::string> patterns = { "RRRRRRRRR", "wwwwwwwww", "ROYGBWROY", "RRRRRRRRR", "GBGBGBGBG" };
+    std::string request = "TILES a";
+    for (const std::string& pattern : patterns)
+        request += " " + pattern;
+    client.send(request + "\n");
+    checkTiles(client.readReply("a"), "a", patterns);
+
+    // remembered patterns are answered the same
+    client.send("TILES b GBGBGBGBG RRRRRRRRR\n");
+    checkTiles(client.readReply("b"), "b", { "GBGBGBGBG", "RRRRRRRRR" });
+
+    std::vector<std::string> reply;
+    client.send("TILES c RRRRRRRRR RRRRXRRRR\n");
+    reply = client.readReply("c");
+    check(reply.size() == 1 && reply[0].rfind("ERROR c pattern 1 ", 0) == 0, "a bad pattern gets " + reply[0]);
+    client.send("SOLVE d RRRRRRRRR\n");
+    reply = client.readReply("d");
+    check(reply.size() == 1 && reply[0] == "ERROR d unknown request SOLVE", "an unknown request gets " + reply[0]);
+    client.send("IMAGE e " + (directory / "missing.ppm").string() + "\n");
+    reply = client.readReply("e");
+    check(reply.size() == 1 && reply[0].rfind("ERROR e ", 0) == 0, "a missing image gets " + reply[0]);
+
+    // an orange image, 3 cubes wide and 2 high
+    fs::path imagePath = directory / "orange.ppm";
+    FILE* image = fopen(imagePath.string().c_str(), "wb");
+    check(image != nullptr, "cannot write " + imagePath.string());
+    fprintf(image, "P6\n90 60\n255\n");
+    for (int i = 0; i < 90 * 60; i++)
+        fwrite("\xFF\x58\x00", 1, 3, image);
+    fclose(image);
+    client.send("IMAGE f " + imagePath.string() + " CUBES 0x3\n");
+    reply = client.readReply("f");
+    check(reply.size() == 1 && reply[0] == "ERROR f bad option 0x3", "a bad option gets " + reply[0]);
+    client.send("IMAGE g " + imagePath.string() + " CUBES 2x3 FIT stretch\n");
+    reply = client.readReply("g");
+    check(!reply.empty() && reply[0] == "SIZE g 2 3", "an image gets " + reply[0] + " first");
+    reply.erase(reply.begin());
+    checkTiles(reply, "g", std::vector<std::string>(6, "OOOOOOOOO"));
+
+    // a request split across writes, and requests sharing one
+    client.send("TILES h RRRR");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    client.send("RWRRR\nSTATS\nTILES i YYYYYYYYY\n");
+    checkTiles(client.readReply("h"), "h", { "RRRRRWRRR" });
+    std::string stats = client.readLine();
+    check(stats.rfind("STATS clients 1 requests 8 errors 4 ", 0) == 0, "the counters are " + stats);
+    checkTiles(client.readReply("i"), "i", { "YYYYYYYYY" });
+
+    // a last request without a newline is answered once the client hangs up
+    client.send("TILES j BBBBBBBBB");
+    client.hangUp();
+    checkTiles(client.readReply("j"), "j", { "BBBBBBBBB" });
+    check(client.readLine().empty(), "the server stays connected after the client hangs up");
+
+    // other clients are served while one is connected
+    Client first(path), second(path);
+    second.send("TILES k OOOOOOOOO\n");
+    checkTiles(second.readReply("k"), "k", { "OOOOOOOOO" });
+    first.send("TILES l WWWWWWWWW\n");
+    checkTiles(first.readReply("l"), "l", { "WWWWWWWWW" });
+}
+
+#endif
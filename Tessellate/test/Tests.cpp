@@ -0,0 +1,40 @@
+#include <stdexcept>
+
+#include "Tests.hpp"
+
+namespace fs = std::filesystem;
+
+void Tests::check(bool condition, const std::string& what) {
+    if (!condition)
+        throw std::runtime_error(what);
+}
+
+fs::path Tests::scratchDirectory(const char* name) {
+    fs::path directory = fs::temp_directory_path() / (std::string("tessellate-tests-") + name);
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    return directory;
+}
+
+std::vector<Move> Tests::randomMoves(std::mt19937& random, size_t n, bool rotations) {
+    std::uniform_int_distribution<int> pick(0, static_cast<int>(rotations ? N_MOVES : N_FACE_MOVES) - 1);
+    std::vector<Move> moves(n);
+    for (Move& move : moves)
+        move = static_cast<Move>(pick(random));
+    return moves;
+}
+
+CubeState Tests::randomState(std::mt19937& random) {
+    CubeState state = CubeState::standard();
+    for (Move move : randomMoves(random, 30, true))
+        state.apply(move);
+    return state;
+}
+
+TileTask Tests::randomTask(std::mt19937& random, uint32_t tile, const CubeState& start) {
+    std::uniform_int_distribution<int> pick(0, 5);
+    TileTask task{ tile, start, {} };
+    for (Color& color : task.pattern)
+        color = static_cast<Color>(pick(random));
+    return task;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CubeState.hpp"
+#include "Move.hpp"
+#include "ShardProtocol.hpp"
+
+/* What the checks of tessellate-tests share. Each check lives in the file of the part of the program it covers,
+   is declared at the bottom, and is listed by name in main.cpp and CMakeLists.txt */
+
+namespace Tests {
+    /* throws with what unless condition holds, failing the check */
+    void check(bool condition, const std::string& what);
+
+    /* true if f throws a std::runtime_error */
+    template <typename F>
+    bool throws(F f) {
+        try {
+            f();
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    }
+
+    /* a directory of its own under the system's temporary directory, emptied first */
+    std::filesystem::path scratchDirectory(const char* name);
+
+    /* n random moves, face turns only unless rotations is set */
+    std::vector<Move> randomMoves(std::mt19937& random, size_t n, bool rotations);
+
+    /* the standard cube after 30 random moves */
+    CubeState randomState(std::mt19937& random);
+
+    /* a random pattern to paint on tile, starting from start */
+    TileTask randomTask(std::mt19937& random, uint32_t tile, const CubeState& start);
+
+    // the checks, by the file they live in
+
+    // PNGImageTests.cpp
+    void inflater();
+    void pngImage();
+
+    // CommandTests.cpp
+    void commands();
+    void commandRing();
+
+    // JobSystemTests.cpp
+    void jobSystem();
+
+    // CubeStateTests.cpp
+    void cubeState();
+
+    // ShardProtocolTests.cpp
+    void shardProtocol();
+
+    // ShardCoordinatorTests.cpp
+    void shardCoordinator();
+    /* what tessellate-tests runs when started with --hung-worker: greets, then never answers a shard */
+    int hungWorker();
+
+    // ChoreographyTests.cpp
+    void choreography();
+
+    // SolutionCacheTests.cpp
+    void solutionCache();
+
+    // TimelineTests.cpp
+    void timeline();
+    void timelineBudget();
+
+    // SolveServerTests.cpp
+    void solveServer();
+
+    // GridSnapshotTests.cpp
+    void gridSnapshot();
+}
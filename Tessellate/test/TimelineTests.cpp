@@ -0,0 +1,130 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "Grid.hpp"
+#include "Timeline.hpp"
+#include "Tests.hpp"
+
+namespace {
+    using namespace Tests;
+
+    const float FRAME = 1.0f / 60;
+
+    /* a grid of scrambled cubes turning at different speeds, the same for the same seed */
+    void makeGrid(Grid& grid, unsigned int seed, size_t nMoves) {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> speed(2, 8);
+        for (size_t i = 0; i < grid.cubes.size(); i++) {
+            grid.cubes.states[i] = randomState(random);
+            grid.cubes.solveSpeeds[i] = speed(random);
+            std::vector<Move> moves = randomMoves(random, nMoves, true);
+            grid.cubes.push(i, moves.data(), moves.size());
+        }
+    }
+
+    /* the queued moves of cube index */
+    std::vector<Move> queued(const Grid& grid, size_t index) {
+        return std::vector<Move>(grid.cubes.movePool.begin() + grid.cubes.queueFront[index], grid.cubes.movePool.begin() + grid.cubes.queueEnd[index]);
+    }
+
+    /* grid is where reference is, up to the rounding of turns in progress */
+    void checkSame(const Grid& grid, const Grid& reference, const std::string& what) {
+        for (size_t i = 0; i < grid.cubes.size(); i++) {
+            std::string cube = what + ", cube " + std::to_string(i);
+            check(grid.cubes.states[i] == reference.cubes.states[i], cube + " is in another state");
+            check(queued(grid, i) == queued(reference, i), cube + " has other moves queued");
+            check(std::fabs(grid.cubes.turnProgress[i] - reference.cubes.turnProgress[i]) < 1e-3f, cube + " is at turn progress "
+                + std::to_string(grid.cubes.turnProgress[i]) + " instead of " + std::to_string(reference.cubes.turnProgress[i]));
+        }
+    }
+}
+
+/* seeking back and forward lands where running straight through does */
+void Tests::timeline() {
+    Grid grid(4, 5), reference(4, 5);
+    makeGrid(grid, 8, 60);
+    makeGrid(reference, 8, 60);
+    Timeline timeline;
+    grid.cubes.addObserver(&timeline);
+
+    // played frame by frame, then scrubbed around
+    for (int frame = 0; frame < 12 * 60; frame++)
+        timeline.update(grid, FRAME);
+    for (int frame = 0; frame < 5 * 60; frame++)
+        reference.update(FRAME);
+    timeline.seek(grid, 5);
+    check(std::fabs(timeline.getTime() - 5) < 1e-9, "seeking back lands at another time");
+    checkSame(grid, reference, "seeking back from 12 to 5");
+
+    for (int frame = 5 * 60; frame < 9 * 60; frame++)
+        reference.update(FRAME);
+    timeline.seek(grid, 9);
+    checkSame(grid, reference, "seeking forward from 5 to 9");
+    timeline.seek(grid, 2.5);
+    timeline.seek(grid, 9);
+    checkSame(grid, reference, "seeking back to 2.5 and forward to 9");
+    // back by less than a turn, so most cubes only wind back the turn they are on
+    timeline.seek(grid, 9 + 2 * FRAME);
+    timeline.seek(grid, 9);
+    checkSame(grid, reference, "seeking two frames forward and back");
+
+    // and played on from there
+    for (int frame = 0; frame < 60; frame++) {
+        timeline.update(grid, FRAME);
+        reference.update(FRAME);
+    }
+    checkSame(grid, reference, "playing on after the seeks");
+
+    Grid start(4, 5);
+    makeGrid(start, 8, 60);
+    timeline.seek(grid, 0);
+    checkSame(grid, start, "seeking back to 0");
+
+    // a move queued on an idle cube after the time is taken back, and replays from the time
+    timeline.seekToEnd(grid);
+    CubeState finished = grid.cubes.states[0];
+    double queuedAt = timeline.getTime();
+    for (int frame = 0; frame < 60; frame++)
+        timeline.update(grid, FRAME);
+    Move late = Move::F;
+    grid.cubes.push(0, &late, 1);
+    for (int frame = 0; frame < 60; frame++)
+        timeline.update(grid, FRAME);
+    timeline.seek(grid, queuedAt + 0.5);
+    check(grid.cubes.states[0] == finished && queued(grid, 0) == std::vector<Move>{ late } && grid.cubes.turnProgress[0] == 0,
+        "a move queued after the time is not taken back");
+    grid.cubes.removeObserver(&timeline);
+}
+
+/* a long history forgets its oldest part instead of growing past its budget */
+void Tests::timelineBudget() {
+    // enough moves that their log alone passes HISTORY_BYTES
+    Grid grid(4, 4);
+    size_t nMoves = Timeline::HISTORY_BYTES / 16 / grid.cubes.size() * 3 / 2;
+    makeGrid(grid, 9, nMoves);
+    for (float& speed : grid.cubes.solveSpeeds)
+        speed = 5000;
+    Timeline timeline;
+    grid.cubes.addObserver(&timeline);
+    timeline.seekToEnd(grid);
+    check(timeline.getStartTime() > 0, "a history of " + std::to_string(nMoves * grid.cubes.size()) + " moves is kept whole");
+    check(timeline.getStartTime() < timeline.getTime(), "the whole history is forgotten");
+
+    // seeking before the start stops at it, and still lands where the grid was then: where another timeline, stepping the same, gets to
+    double startTime = timeline.getStartTime();
+    Grid reference(4, 4);
+    makeGrid(reference, 9, nMoves);
+    for (float& speed : reference.cubes.solveSpeeds)
+        speed = 5000;
+    Timeline referenceTimeline;
+    reference.cubes.addObserver(&referenceTimeline);
+    referenceTimeline.seek(reference, startTime);
+    reference.cubes.removeObserver(&referenceTimeline);
+    timeline.seek(grid, 0);
+    check(timeline.getTime() == startTime, "seeking goes back past the start of the history");
+    for (size_t i = 0; i < grid.cubes.size(); i++)
+        check(grid.cubes.states[i] == reference.cubes.states[i] && queued(grid, i) == queued(reference, i),
+            "cube " + std::to_string(i) + " is elsewhere at the start of the history");
+    grid.cubes.removeObserver(&timeline);
+}
@@ -0,0 +1,61 @@
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include "ShardWorker.hpp"
+#include "Tests.hpp"
+
+/* Runs the checks of the program. Each check is a ctest test of its own: tessellate-tests <name> runs one, and without a name all of them run */
+
+namespace {
+    using namespace Tests;
+
+    struct Test {
+        const char* name;
+        void (*run)();
+    };
+
+    const Test TESTS[] = {
+        { "inflater", inflater },
+        { "png_image", pngImage },
+        { "commands", commands },
+        { "command_ring", commandRing },
+        { "job_system", jobSystem },
+        { "cube_state", cubeState },
+        { "shard_protocol", shardProtocol },
+        { "shard_coordinator", shardCoordinator },
+        { "choreography", choreography },
+        { "solution_cache", solutionCache },
+        { "timeline", timeline },
+        { "timeline_budget", timelineBudget },
+        { "solve_server", solveServer },
+        { "grid_snapshot", gridSnapshot },
+    };
+}
+
+int main(int argc, char* argv[]) {
+    // the workers the shard_coordinator check starts
+    if (argc > 1 && strcmp(argv[1], "--worker") == 0)
+        return ShardWorker::run();
+    if (argc > 1 && strcmp(argv[1], "--hung-worker") == 0)
+        return Tests::hungWorker();
+
+    int nFailed = 0, nRun = 0;
+    for (const Test& test : TESTS) {
+        if (argc > 1 && strcmp(argv[1], test.name) != 0)
+            continue;
+        nRun++;
+        try {
+            test.run();
+            std::cout << "ok   " << test.name << std::endl;
+        } catch (const std::exception& e) {
+            std::cout << "FAIL " << test.name << ": " << e.what() << std::endl;
+            nFailed++;
+        }
+    }
+    if (nRun == 0) {
+        std::cerr << "no test named " << argv[1] << std::endl;
+        return 2;
+    }
+    return nFailed > 0 ? 1 : 0;
+}